@@ -0,0 +1,208 @@
+#include "CDCControl.h"
+#include "Config.h"
+#include "Protocol.h"
+#include "CommandHandler.h"
+#include "USBHID.h"
+#include "MacroEngine.h"
+#include "PowerControl.h"
+#include <stdarg.h>
+
+CDCControlClass CDCControl;
+
+void gwLog(const char* fmt, ...) {
+  char line[160];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(line, sizeof(line), fmt, args);
+  va_end(args);
+  Serial.println(line);
+  CDCControl.log(line);
+}
+
+#if defined(USE_USB_CDC) && USE_USB_CDC == 1
+
+#include "tusb.h"
+
+static TaskHandle_t cdcTask = nullptr;
+static SemaphoreHandle_t txLock = nullptr;
+
+static void replyStatus(const std::string& status) {
+  CDCControl.send(CDC_MSG_STATUS, (const uint8_t*)status.data(), status.size());
+}
+
+void CDCControlClass::begin() {
+  txLock = xSemaphoreCreateMutex();
+  xTaskCreate(task, "cdc_ctl", 4096, this, 4, &cdcTask);
+}
+
+void CDCControlClass::onRx() {
+  if (cdcTask) xTaskNotifyGive(cdcTask);
+}
+
+void CDCControlClass::onLineState(bool dtr) {
+  // Port closed on the host: stop streaming logs into a dead pipe
+  if (!dtr) logStreaming = false;
+}
+
+void CDCControlClass::log(const char* line) {
+  if (!logStreaming) return;
+  // Never block: logs may come from the TinyUSB task itself
+  send(CDC_MSG_LOG, (const uint8_t*)line, strlen(line), false);
+}
+
+void CDCControlClass::send(uint8_t type, const uint8_t* data, size_t len, bool mayBlock) {
+  if (!tud_cdc_connected() || !txLock) return;
+  if (len > 254) len = 254;
+
+  uint8_t header[3] = { CDC_SYNC, (uint8_t)(len + 1), type };
+  if (!mayBlock && tud_cdc_write_available() < sizeof(header) + len) return;
+  if (xSemaphoreTake(txLock, mayBlock ? pdMS_TO_TICKS(50) : 0) != pdTRUE) return;
+
+  const uint8_t* parts[2] = { header, data };
+  size_t sizes[2] = { sizeof(header), len };
+  for (int i = 0; i < 2; ++i) {
+    size_t done = 0;
+    int spins = 0;
+    while (done < sizes[i]) {
+      uint32_t n = tud_cdc_write(parts[i] + done, sizes[i] - done);
+      done += n;
+      if (n == 0) {
+        tud_cdc_write_flush();
+        if (++spins > 50) break; // host stopped reading
+        vTaskDelay(1);
+      }
+    }
+  }
+  tud_cdc_write_flush();
+  xSemaphoreGive(txLock);
+}
+
+void CDCControlClass::task(void* arg) {
+  CDCControlClass* self = static_cast<CDCControlClass*>(arg);
+  uint8_t buf[64];
+  for (;;) {
+    // tud_cdc_rx_cb always notifies, so there is nothing to poll for
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    while (tud_cdc_available()) {
+      uint32_t n = tud_cdc_read(buf, sizeof(buf));
+      for (uint32_t i = 0; i < n; ++i) self->feed(buf[i]);
+    }
+  }
+}
+
+void CDCControlClass::feed(uint8_t b) {
+  switch (rxState) {
+    case RX_SYNC:
+      if (b == CDC_SYNC) rxState = RX_LEN;
+      else syncErrors++;
+      break;
+    case RX_LEN:
+      rxLen = b;
+      rxPos = 0;
+      rxState = b ? RX_PAYLOAD : RX_SYNC;
+      break;
+    case RX_PAYLOAD:
+      rxBuf[rxPos++] = b;
+      if (rxPos == rxLen) {
+        rxState = RX_SYNC;
+        dispatch(rxBuf, rxLen);
+      }
+      break;
+  }
+}
+
+void CDCControlClass::dispatch(const uint8_t* data, size_t len) {
+  framesReceived++;
+  PowerControl::boost();
+
+  if (!isBinaryFrame(data, len)) {
+    DynamicJsonDocument doc(JSON_COMMAND_CAPACITY);
+    DeserializationError err = deserializeJson(doc, (const char*)data, len);
+    if (err) {
+      replyStatus(std::string("json_error:") + err.c_str());
+      return;
+    }
+    handleJsonCommand(doc, replyStatus);
+    return;
+  }
+
+  switch (data[0]) {
+    case FRAME_STATS_GET:
+      if (len > 1 && data[1] == STATS_SECTION_POWER) sendPowerStats();
+      else sendStats();
+      break;
+    case FRAME_STATS_RESET:
+      USBHID.resetStats();
+      framesReceived = 0;
+      syncErrors = 0;
+      replyStatus("stats_reset");
+      break;
+    case FRAME_LOG_STREAM:
+      logStreaming = len > 1 && data[1];
+      replyStatus(logStreaming ? "log_on" : "log_off");
+      break;
+    case FRAME_PING: {
+      uint8_t pong[64];
+      size_t echo = min(len - 1, sizeof(pong) - 4);
+      memcpy(pong, data + 1, echo);
+      uint32_t now = micros();
+      memcpy(pong + echo, &now, 4); // ESP32 is little-endian
+      send(CDC_MSG_PONG, pong, echo + 4);
+      break;
+    }
+    case FRAME_IDLE_MEASURE: {
+      uint8_t seconds = len > 1 && data[1] ? data[1] : 30;
+      replyStatus("idle_measure");
+      PowerControl::startIdleMeasurement(seconds);
+      break;
+    }
+    default:
+      if (!handleBinaryFrame(data, len, replyStatus)) replyStatus("unknown_opcode");
+      break;
+  }
+}
+
+void CDCControlClass::sendStats() {
+  static const char* busNames[] = { "unmounted", "active", "suspended" };
+  USBHIDClass::Stats hid = USBHID.getStats();
+  uint32_t latAvgUs = hid.sent ? (uint32_t)(hid.latencySumUs / hid.sent) : 0;
+
+  char json[320];
+  int n = snprintf(json, sizeof(json),
+    "{\"uptimeMs\":%lu,\"bus\":\"%s\",\"macro\":%s,\"heap\":%u,"
+    "\"hid\":{\"queued\":%u,\"sent\":%u,\"deduped\":%u,\"dropped\":%u,"
+    "\"queueMax\":%u,\"latMaxUs\":%u,\"latAvgUs\":%u},"
+    "\"cdc\":{\"frames\":%u,\"syncErrors\":%u}}",
+    (unsigned long)millis(), busNames[USBHID.busState()], MacroEngine.isRunning() ? "true" : "false",
+    (unsigned)ESP.getFreeHeap(),
+    (unsigned)hid.queued, (unsigned)hid.sent, (unsigned)hid.deduped, (unsigned)hid.dropped,
+    (unsigned)hid.queueHighWater, (unsigned)hid.latencyMaxUs, (unsigned)latAvgUs,
+    (unsigned)framesReceived, (unsigned)syncErrors);
+  send(CDC_MSG_STATS, (const uint8_t*)json, min(n, (int)sizeof(json) - 1));
+}
+
+void CDCControlClass::sendPowerStats() {
+  // Separate message: the main stats JSON already fills most of a CDC frame
+  PowerControl::Stats pm = PowerControl::getStats();
+  char json[160];
+  int n = snprintf(json, sizeof(json),
+    "{\"power\":{\"pm\":%s,\"cpuMhz\":%u,\"boosts\":%u,\"boostedMs\":%u,"
+    "\"usbLock\":%s,\"idleMeasuring\":%s}}",
+    pm.pmEnabled ? "true" : "false", (unsigned)pm.cpuMhz, (unsigned)pm.boosts, (unsigned)pm.boostedMs,
+    pm.busLockHeld ? "true" : "false", pm.idleMeasuring ? "true" : "false");
+  send(CDC_MSG_STATS, (const uint8_t*)json, min(n, (int)sizeof(json) - 1));
+  PowerControl::dumpLocks();
+}
+
+#else
+
+void CDCControlClass::begin() {
+  // CDC control channel disabled at compile time; nothing to do.
+}
+
+void CDCControlClass::onRx() {}
+void CDCControlClass::onLineState(bool dtr) {}
+void CDCControlClass::log(const char* line) {}
+void CDCControlClass::send(uint8_t type, const uint8_t* data, size_t len, bool mayBlock) {}
+
+#endif
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Optional CDC-ACM control channel (USE_USB_CDC=1). Carries the same command
+// frames as BLE, wrapped for a byte stream (see Protocol.h), plus telemetry
+// and log streaming so a wired test rig can drive and measure the GW.
+class CDCControlClass {
+public:
+  void begin();
+  void onRx();                  // from tud_cdc_rx_cb
+  void onLineState(bool dtr);   // from tud_cdc_line_state_cb
+  void log(const char* line);   // forwarded only while log streaming is on
+  void send(uint8_t type, const uint8_t* data, size_t len, bool mayBlock = true);
+
+private:
+  static void task(void* arg);
+  void feed(uint8_t b);
+  void dispatch(const uint8_t* data, size_t len);
+  void sendStats();
+  void sendPowerStats();
+
+  enum RxState : uint8_t { RX_SYNC, RX_LEN, RX_PAYLOAD };
+  RxState rxState = RX_SYNC;
+  uint8_t rxBuf[255];
+  uint8_t rxLen = 0;
+  uint8_t rxPos = 0;
+
+  volatile bool logStreaming = false;
+  uint32_t framesReceived = 0;
+  uint32_t syncErrors = 0;
+};
+
+extern CDCControlClass CDCControl;
+
+// Log a line to Serial and, when streaming is enabled, to the CDC channel
+void gwLog(const char* fmt, ...);
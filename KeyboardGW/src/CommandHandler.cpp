@@ -0,0 +1,94 @@
+#include "CommandHandler.h"
+#include "Config.h"
+#include "Protocol.h"
+#include "USBHID.h"
+#include "MacroEngine.h"
+#include "LEDIndicator.h"
+#include <vector>
+
+std::string deliveryAck(const std::string& ok) {
+    if (USBHID.busState() == USBHIDClass::BUS_ACTIVE) return ok;
+    return std::string("keys_") + USBHID.deliveryStatus();
+}
+
+static void replyMacroStarted(size_t steps, StatusSink reply) {
+    if (!steps) {
+        reply(std::string("macro_error:") + MacroEngine.getLoadError());
+        return;
+    }
+    reply(deliveryAck("macro_started:steps=" + std::to_string(steps)));
+}
+
+bool handleBinaryFrame(const uint8_t* data, size_t len, StatusSink reply) {
+    const uint8_t* usages = data + 1;
+    size_t count = len - 1;
+    bool ok = true;
+    switch (data[0]) {
+        // Key-state frames are not acked; only a rejected frame gets a reply
+        case FRAME_KEY_DOWN:    ok = USBHID.keyDown(usages, count); break;
+        case FRAME_KEY_UP:      ok = USBHID.keyUp(usages, count); break;
+        case FRAME_KEY_SET:     ok = USBHID.setKeys(usages, count); break;
+        case FRAME_RELEASE_ALL: USBHID.releaseAll(); return true;
+        case FRAME_KEEPALIVE:   USBHID.feedWatchdog(); return true;
+        case FRAME_MACRO:
+            replyMacroStarted(MacroEngine.loadBinary(data + 1, len - 1), reply);
+            LEDIndicator::blink(LED_WHITE, 80);
+            return true;
+        case FRAME_MACRO_CANCEL: MacroEngine.cancel(); return true;
+        default: return false;
+    }
+    if (!ok) reply("invalid_usage");
+    return true;
+}
+
+// JSON form of the key-state protocol: {"down":["shift"]} / {"up":["shift"]}
+static void applyJsonKeyState(JsonArray names, bool down) {
+    uint8_t usages[16];
+    size_t count = 0;
+    for (auto k : names) {
+        uint8_t usage = USBHID.usageFromName(k.as<const char*>());
+        if (usage != 0 && count < sizeof(usages)) usages[count++] = usage;
+    }
+    if (down) USBHID.keyDown(usages, count);
+    else USBHID.keyUp(usages, count);
+}
+
+void handleJsonCommand(JsonDocument& doc, StatusSink reply) {
+    if (doc.containsKey("down") || doc.containsKey("up")) {
+        if (doc["up"].is<JsonArray>()) applyJsonKeyState(doc["up"].as<JsonArray>(), false);
+        if (doc["down"].is<JsonArray>()) applyJsonKeyState(doc["down"].as<JsonArray>(), true);
+        return;
+    }
+
+    if (doc.containsKey("steps")) {
+        // Multi-step shortcut: run it on the GW with local timing
+        replyMacroStarted(MacroEngine.loadJson(doc.as<JsonObjectConst>()), reply);
+        LEDIndicator::blink(LED_WHITE, 80);
+        return;
+    }
+
+    if (!doc.containsKey("keys")) {
+        Serial.println("No 'keys' field in JSON");
+        reply("no_keys_field");
+        return;
+    }
+
+    JsonArray keys = doc["keys"].as<JsonArray>();
+    Serial.print("Keys array size: ");
+    Serial.println(keys.size());
+
+    std::vector<const char*> keyPtrs;
+    keyPtrs.reserve(keys.size());
+    for (auto k : keys) {
+        keyPtrs.push_back(k.as<const char*>());
+        Serial.print("Key: ");
+        Serial.println(keyPtrs.back());
+    }
+
+    USBHID.writeShortcut(keyPtrs.data(), keyPtrs.size());
+
+    // Indicate sending with a short white blink
+    LEDIndicator::blink(LED_WHITE, 80);
+
+    reply(deliveryAck("keys_sent_ok"));
+}
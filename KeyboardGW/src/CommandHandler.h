@@ -0,0 +1,26 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <string>
+#include "Config.h"
+
+// JSON document size for one command: a macro of MACRO_MAX_STEPS steps with
+// MACRO_MAX_KEYS_PER_STEP keys each, plus room for the key-name strings
+#define JSON_COMMAND_CAPACITY \
+  (JSON_OBJECT_SIZE(3) + JSON_ARRAY_SIZE(MACRO_MAX_STEPS) + \
+   MACRO_MAX_STEPS * (JSON_OBJECT_SIZE(3) + JSON_ARRAY_SIZE(MACRO_MAX_KEYS_PER_STEP)) + \
+   MACRO_MAX_STEPS * MACRO_MAX_KEYS_PER_STEP * 8)
+
+// Commands are shared by every transport (BLE shortcut characteristic, CDC
+// control channel). Replies go back through the transport's status sink.
+typedef void (*StatusSink)(const std::string& status);
+
+// Binary frame (see Protocol.h). Returns false for unknown opcodes.
+bool handleBinaryFrame(const uint8_t* data, size_t len, StatusSink reply);
+
+// Parsed JSON command: {"keys":[...]}, {"steps":[...]} or {"down"/"up":[...]}
+void handleJsonCommand(JsonDocument& doc, StatusSink reply);
+
+// Acks report whether the keys reached the host or are held for a suspended bus
+std::string deliveryAck(const std::string& ok);
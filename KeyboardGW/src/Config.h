@@ -21,3 +21,26 @@
 #define LED_RED 0xFF0000
 #define LED_WHITE 0xFFFFFF
 #define LED_YELLOW 0xFFFF00
+
+// HID report pump
+// Reports are emitted at most once per USB poll interval (bInterval of the HID endpoint).
+#define HID_POLL_INTERVAL_MS 10
+#define HID_REPORT_QUEUE_LEN 32
+#define SHORTCUT_HOLD_MS 50
+// While the host is suspended, queued reports are held this long for it to resume
+#define USB_SUSPEND_HOLD_MS 5000
+
+// Key-state streaming: release every held key if the client goes silent this long
+#define KEYSTREAM_WATCHDOG_MS 500
+
+// Macro engine (multi-step shortcuts executed on the GW)
+#define MACRO_MAX_STEPS 32
+#define MACRO_MAX_KEYS_PER_STEP 8
+#define MACRO_HOLD_MS 20          // how long each step's chord is held
+#define MACRO_DEFAULT_GAP_MS 30   // pause after a step when none is given
+
+// Power management (DFS + automatic light sleep, CONFIG_PM_ENABLE from sdkconfig.defaults)
+#define PM_MAX_CPU_FREQ_MHZ 240
+#define PM_MIN_CPU_FREQ_MHZ 80    // APB stays at 80 MHz for USB and BLE
+#define PM_BOOST_HOLD_MS 200      // keep max frequency this long after the last activity
+#define PM_USB_ENUM_TIMEOUT_MS 3000 // no mount within this time after boot: treat the bus as idle (charger/battery)
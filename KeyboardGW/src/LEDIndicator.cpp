@@ -9,6 +9,8 @@ static const uint8_t DEFAULT_BRIGHTNESS = 32; // dimmer
 
 // Keep track of current (active) color so we can restore after a blink
 static uint32_t currentColor = LED_OFF;
+// Cleared during idle current measurement
+static bool ledEnabled = true;
 
 void LEDIndicator::begin() {
   strip.begin();
@@ -18,6 +20,8 @@ void LEDIndicator::begin() {
 }
 
 void LEDIndicator::setColor(uint32_t color) {
+  currentColor = color;
+  if (!ledEnabled) return;
   // Adafruit expects color format as RGB tuple; we pass 0xRRGGBB
   for (int i = 0; i < strip.numPixels(); ++i) {
     uint8_t r = (color >> 16) & 0xFF;
@@ -26,10 +30,10 @@ void LEDIndicator::setColor(uint32_t color) {
     strip.setPixelColor(i, strip.Color(r, g, b));
   }
   strip.show();
-  currentColor = color;
 }
 
 void LEDIndicator::blink(uint32_t color, uint16_t ms) {
+  if (!ledEnabled) return;
   uint32_t prev = currentColor;
   setColor(color);
   delay(ms);
@@ -42,3 +46,13 @@ void LEDIndicator::off() {
   strip.show();
   currentColor = LED_OFF;
 }
+
+void LEDIndicator::setEnabled(bool enabled) {
+  ledEnabled = enabled;
+  if (enabled) {
+    setColor(currentColor);
+  } else {
+    for (int i = 0; i < strip.numPixels(); ++i) strip.setPixelColor(i, 0);
+    strip.show();
+  }
+}
@@ -8,6 +8,7 @@ public:
   static void setColor(uint32_t color); // color as 0xRRGGBB
   static void blink(uint32_t color, uint16_t ms);
   static void off();
+  static void setEnabled(bool enabled); // disabled: dark, but colors are remembered
 private:
   static Adafruit_NeoPixel strip;
 };
@@ -0,0 +1,181 @@
+#include "MacroEngine.h"
+#include "USBHID.h"
+#include "CDCControl.h"
+
+MacroEngineClass MacroEngine;
+
+static portMUX_TYPE macroMux = portMUX_INITIALIZER_UNLOCKED;
+
+void MacroEngineClass::begin() {
+  esp_timer_create_args_t args = {};
+  args.callback = &MacroEngineClass::onTimer;
+  args.arg = this;
+  args.name = "macro";
+  esp_timer_create(&args, &timer);
+}
+
+size_t MacroEngineClass::loadBinary(const uint8_t* data, size_t len) {
+  loadError = "bad_format";
+  if (len < 1) return 0;
+  cancel();
+
+  uint8_t repeat = data[0];
+  size_t pos = 1;
+  stepCount = 0;
+  while (pos < len) {
+    if (stepCount >= MACRO_MAX_STEPS) {
+      loadError = "too_many_steps";
+      stepCount = 0;
+      return 0;
+    }
+    uint8_t count = data[pos++];
+    if (count > MACRO_MAX_KEYS_PER_STEP) {
+      loadError = "too_many_keys";
+      stepCount = 0;
+      return 0;
+    }
+    if (pos + count + 2 > len) {
+      stepCount = 0;
+      return 0;
+    }
+
+    Step& st = steps[stepCount++];
+    memcpy(st.usages, data + pos, count);
+    st.count = count;
+    pos += count;
+    st.delayMs = (uint16_t)(data[pos] | (data[pos + 1] << 8));
+    pos += 2;
+  }
+  if (stepCount == 0) {
+    loadError = "no_steps";
+    return 0;
+  }
+
+  start(repeat);
+  return stepCount;
+}
+
+size_t MacroEngineClass::loadJson(JsonObjectConst obj) {
+  JsonArrayConst arr = obj["steps"].as<JsonArrayConst>();
+  if (arr.isNull()) {
+    loadError = "bad_format";
+    return 0;
+  }
+  // Reject oversized macros up front (the running one keeps going) instead of
+  // acking a truncated copy
+  if (arr.size() > MACRO_MAX_STEPS) {
+    loadError = "too_many_steps";
+    return 0;
+  }
+  for (JsonObjectConst stepObj : arr) {
+    if (stepObj["keys"].as<JsonArrayConst>().size() > MACRO_MAX_KEYS_PER_STEP) {
+      loadError = "too_many_keys";
+      return 0;
+    }
+  }
+  cancel();
+
+  // Same step shape as the shortcut catalogs: {"keys":[...]} or {"type":"wait","duration":ms}
+  stepCount = 0;
+  for (JsonObjectConst stepObj : arr) {
+    Step& st = steps[stepCount++];
+    st.count = 0;
+    for (JsonVariantConst k : stepObj["keys"].as<JsonArrayConst>()) {
+      uint8_t usage = USBHIDClass::usageFromName(k.as<const char*>());
+      if (usage != 0) st.usages[st.count++] = usage;
+    }
+    uint16_t fallback = st.count ? MACRO_DEFAULT_GAP_MS : 0;
+    st.delayMs = stepObj["duration"] | (stepObj["delay"] | fallback);
+  }
+  if (stepCount == 0) {
+    loadError = "no_steps";
+    return 0;
+  }
+
+  start(obj["repeat"] | 1);
+  return stepCount;
+}
+
+void MacroEngineClass::cancel() {
+  portENTER_CRITICAL(&macroMux);
+  running = false;
+  portEXIT_CRITICAL(&macroMux);
+  esp_timer_stop(timer); // harmless if not armed
+}
+
+bool MacroEngineClass::isRunning() {
+  return running;
+}
+
+void MacroEngineClass::start(uint8_t repeat) {
+  portENTER_CRITICAL(&macroMux);
+  generation++;
+  current = 0;
+  repeatsLeft = repeat ? repeat : 1;
+  nextDeadlineUs = esp_timer_get_time();
+  running = true;
+  portEXIT_CRITICAL(&macroMux);
+
+  gwLog("Macro started: %u steps x%u", (unsigned)stepCount, (unsigned)repeatsLeft);
+  esp_timer_start_once(timer, 0);
+}
+
+void MacroEngineClass::onTimer(void* arg) {
+  static_cast<MacroEngineClass*>(arg)->runStep();
+}
+
+void MacroEngineClass::runStep() {
+  Step st;
+  uint32_t gen;
+  portENTER_CRITICAL(&macroMux);
+  if (!running) {
+    portEXIT_CRITICAL(&macroMux);
+    return;
+  }
+  st = steps[current];
+  gen = generation;
+  portEXIT_CRITICAL(&macroMux);
+
+  int64_t now = esp_timer_get_time();
+  if (st.count > 0 && !USBHID.writeChord(st.usages, st.count, MACRO_HOLD_MS)) {
+    // Report queue is full: retry on the next poll interval without advancing
+    // (unless a new macro was started meanwhile; its start() armed the timer)
+    portENTER_CRITICAL(&macroMux);
+    bool stale = gen != generation || !running;
+    portEXIT_CRITICAL(&macroMux);
+    if (!stale) esp_timer_start_once(timer, HID_POLL_INTERVAL_MS * 1000);
+    return;
+  }
+
+  // Schedule against absolute deadlines so steps don't drift. A chord needs its
+  // hold plus one poll interval for the release report before the next press.
+  uint32_t gapMs = st.delayMs;
+  if (st.count > 0) {
+    gapMs = max(MACRO_HOLD_MS, HID_POLL_INTERVAL_MS) + max((int)st.delayMs, HID_POLL_INTERVAL_MS);
+  }
+
+  portENTER_CRITICAL(&macroMux);
+  if (gen != generation) {
+    // cancel() + start() ran while the chord was being queued: the new macro
+    // owns current/deadline/timer now
+    portEXIT_CRITICAL(&macroMux);
+    return;
+  }
+  int64_t firedUs = nextDeadlineUs > now ? nextDeadlineUs : now;
+  nextDeadlineUs = firedUs + (int64_t)gapMs * 1000;
+  int64_t deadlineUs = nextDeadlineUs;
+  if (++current >= stepCount) {
+    current = 0;
+    if (--repeatsLeft == 0) running = false;
+  }
+  bool more = running;
+  portEXIT_CRITICAL(&macroMux);
+
+  if (!more) {
+    gwLog("Macro finished");
+    return;
+  }
+
+  int64_t waitUs = deadlineUs - esp_timer_get_time();
+  esp_timer_start_once(timer, waitUs > 0 ? (uint64_t)waitUs : 0);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "esp_timer.h"
+#include "Config.h"
+
+// Runs multi-step shortcuts (e.g. Ctrl+K, Ctrl+S) on the GW so step timing
+// does not depend on BLE round trips. Steps are scheduled on an esp_timer
+// against absolute deadlines and fed into the USBHID report queue.
+class MacroEngineClass {
+public:
+  struct Step {
+    uint8_t usages[MACRO_MAX_KEYS_PER_STEP];
+    uint8_t count;    // 0 = wait only
+    uint16_t delayMs; // pause after the chord is released
+  };
+
+  void begin();
+  // Binary form: [repeat, step...], see Protocol.h. Returns number of steps or 0 on error.
+  size_t loadBinary(const uint8_t* data, size_t len);
+  // JSON form: {"steps":[{"keys":["ctrl","k"]},{"keys":["s"],"duration":50}],"repeat":1}
+  size_t loadJson(JsonObjectConst obj);
+  // Why the last load returned 0: "bad_format", "no_steps", "too_many_steps" or "too_many_keys"
+  const char* getLoadError() const { return loadError; }
+  void cancel();
+  bool isRunning();
+
+private:
+  void start(uint8_t repeat);
+  void runStep();
+  static void onTimer(void* arg);
+
+  Step steps[MACRO_MAX_STEPS];
+  size_t stepCount = 0;
+  size_t current = 0;
+  uint8_t repeatsLeft = 0;
+  int64_t nextDeadlineUs = 0;
+  volatile bool running = false;
+  uint32_t generation = 0; // bumped by start(); a runStep from an older macro must not touch the new one
+  const char* loadError = "";
+  esp_timer_handle_t timer = nullptr;
+};
+
+extern MacroEngineClass MacroEngine;
@@ -0,0 +1,162 @@
+#include "PowerControl.h"
+#include "Config.h"
+#include "LEDIndicator.h"
+#include "CDCControl.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+#if CONFIG_PM_ENABLE
+#include "esp_pm.h"
+static esp_pm_lock_handle_t cpuLock = nullptr; // ESP_PM_CPU_FREQ_MAX while boosted
+static esp_pm_lock_handle_t busLock = nullptr; // ESP_PM_NO_LIGHT_SLEEP while USB is mounted
+#endif
+
+static portMUX_TYPE pmMux = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t boostTimer = nullptr;
+static esp_timer_handle_t idleTimer = nullptr;
+static esp_timer_handle_t enumTimer = nullptr;
+static volatile bool busReported = false; // the USB stack has reported mount/suspend/resume/unmount
+static bool boosted = false;
+static uint32_t boostStartMs = 0;
+static volatile bool idleMeasuring = false;
+static PowerControl::Stats stats = {};
+
+static void onBoostExpired(void* arg) {
+  (void)arg;
+  portENTER_CRITICAL(&pmMux);
+  bool wasBoosted = boosted;
+  boosted = false;
+  if (wasBoosted) stats.boostedMs += millis() - boostStartMs;
+  portEXIT_CRITICAL(&pmMux);
+#if CONFIG_PM_ENABLE
+  if (wasBoosted && cpuLock) esp_pm_lock_release(cpuLock);
+#endif
+}
+
+static void onIdleMeasurementDone(void* arg) {
+  (void)arg;
+  idleMeasuring = false;
+  LEDIndicator::setEnabled(true);
+  gwLog("Idle measurement finished");
+}
+
+static void onEnumTimeout(void* arg) {
+  (void)arg;
+  // Powered from a charger or battery: no host will ever mount us, so the
+  // unmount callback never fires. Stop holding off light sleep.
+  if (busReported) return;
+  gwLog("USB not mounted after %d ms, allowing light sleep", PM_USB_ENUM_TIMEOUT_MS);
+  PowerControl::setBusActive(false);
+}
+
+void PowerControl::begin() {
+  esp_timer_create_args_t args = {};
+  args.callback = &onBoostExpired;
+  args.name = "pm_boost";
+  esp_timer_create(&args, &boostTimer);
+  args.callback = &onIdleMeasurementDone;
+  args.name = "pm_idle";
+  esp_timer_create(&args, &idleTimer);
+  args.callback = &onEnumTimeout;
+  args.name = "pm_enum";
+  esp_timer_create(&args, &enumTimer);
+
+#if CONFIG_PM_ENABLE
+#if ESP_IDF_VERSION_MAJOR >= 5
+  esp_pm_config_t pmConfig = {};
+#else
+  esp_pm_config_esp32s3_t pmConfig = {};
+#endif
+  pmConfig.max_freq_mhz = PM_MAX_CPU_FREQ_MHZ;
+  pmConfig.min_freq_mhz = PM_MIN_CPU_FREQ_MHZ;
+  pmConfig.light_sleep_enable = true;
+  esp_err_t err = esp_pm_configure(&pmConfig);
+  if (err != ESP_OK) {
+    gwLog("Power management unavailable: %s", esp_err_to_name(err));
+    return;
+  }
+
+  esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "gw_boost", &cpuLock);
+  esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "gw_usb", &busLock);
+  // USB is assumed active while the host enumerates us; if nothing is
+  // reported within PM_USB_ENUM_TIMEOUT_MS the lock is dropped again
+  esp_pm_lock_acquire(busLock);
+  stats.busLockHeld = true;
+  esp_timer_start_once(enumTimer, (uint64_t)PM_USB_ENUM_TIMEOUT_MS * 1000);
+  stats.pmEnabled = true;
+  gwLog("Power management: DFS %d-%d MHz, auto light sleep", PM_MIN_CPU_FREQ_MHZ, PM_MAX_CPU_FREQ_MHZ);
+  dumpLocks();
+#else
+  Serial.println("Power management disabled (CONFIG_PM_ENABLE not set)");
+#endif
+}
+
+void PowerControl::boost() {
+  if (idleMeasuring) return;
+
+  portENTER_CRITICAL(&pmMux);
+  bool start = !boosted;
+  if (start) {
+    boosted = true;
+    boostStartMs = millis();
+    stats.boosts++;
+  }
+  portEXIT_CRITICAL(&pmMux);
+
+#if CONFIG_PM_ENABLE
+  if (start && cpuLock) esp_pm_lock_acquire(cpuLock);
+#endif
+  // Extend the boost window from the latest activity
+  esp_timer_stop(boostTimer);
+  esp_timer_start_once(boostTimer, (uint64_t)PM_BOOST_HOLD_MS * 1000);
+}
+
+void PowerControl::setBusActive(bool active) {
+  busReported = true;
+#if CONFIG_PM_ENABLE
+  if (!busLock) return;
+  portENTER_CRITICAL(&pmMux);
+  bool changed = stats.busLockHeld != active;
+  stats.busLockHeld = active;
+  portEXIT_CRITICAL(&pmMux);
+  if (!changed) return;
+  if (active) esp_pm_lock_acquire(busLock);
+  else esp_pm_lock_release(busLock);
+#else
+  (void)active;
+#endif
+}
+
+void PowerControl::startIdleMeasurement(uint32_t seconds) {
+  // Put the GW in its idle configuration so an external meter sees the floor
+  gwLog("Idle measurement for %u s", (unsigned)seconds);
+  idleMeasuring = true;
+  LEDIndicator::setEnabled(false);
+  esp_timer_stop(boostTimer);
+  onBoostExpired(nullptr);
+
+  esp_timer_stop(idleTimer);
+  esp_timer_start_once(idleTimer, (uint64_t)seconds * 1000000);
+}
+
+bool PowerControl::isIdleMeasuring() {
+  return idleMeasuring;
+}
+
+void PowerControl::dumpLocks() {
+#if CONFIG_PM_ENABLE
+  // Lists gw_boost / gw_usb with their acquire counts (plus times with CONFIG_PM_PROFILING)
+  esp_pm_dump_locks(stdout);
+  fflush(stdout);
+#endif
+}
+
+PowerControl::Stats PowerControl::getStats() {
+  portENTER_CRITICAL(&pmMux);
+  Stats s = stats;
+  if (boosted) s.boostedMs += millis() - boostStartMs;
+  portEXIT_CRITICAL(&pmMux);
+  s.cpuMhz = getCpuFrequencyMhz();
+  s.idleMeasuring = idleMeasuring;
+  return s;
+}
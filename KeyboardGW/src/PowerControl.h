@@ -0,0 +1,27 @@
+#pragma once
+#include <Arduino.h>
+
+// ESP-IDF power management for the GW: the CPU idles at PM_MIN_CPU_FREQ_MHZ
+// and boosts to max while commands are being processed; automatic light sleep
+// is only allowed while no host has the bus mounted (the USB OTG peripheral
+// cannot run through light sleep, and a suspended bus must still catch the
+// host's resume signalling). Without CONFIG_PM_ENABLE every call is a no-op.
+class PowerControl {
+public:
+  static void begin();
+  static void boost();                    // run at max frequency for PM_BOOST_HOLD_MS
+  static void setBusActive(bool active);  // USB mounted: hold off light sleep
+  static void startIdleMeasurement(uint32_t seconds); // LED off, no boosts
+  static bool isIdleMeasuring();
+  static void dumpLocks();                // esp_pm_dump_locks to the console
+
+  struct Stats {
+    bool pmEnabled;
+    uint32_t cpuMhz;
+    uint32_t boosts;      // number of boost periods
+    uint32_t boostedMs;   // total time spent boosted
+    bool busLockHeld;     // light sleep blocked by a mounted USB bus
+    bool idleMeasuring;
+  };
+  static Stats getStats();
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Binary command frames written to the shortcut characteristic.
+// JSON payloads always start with '{' (or whitespace), so any first byte
+// >= 0x80 is treated as a binary opcode.
+//
+// Key-state streaming (press/hold/release):
+//   [KEY_DOWN, usage...]     press the given HID usages (0xE0-0xE7 = modifiers)
+//   [KEY_UP, usage...]       release the given HID usages
+//   [KEY_SET, usage...]      replace the whole held set (idempotent resync)
+//   [RELEASE_ALL]            release everything
+//   [KEEPALIVE]              feed the watchdog while keys are held
+//
+// Macros (executed locally with GW-side timing):
+//   [MACRO, repeat, step...] step = [n, usage x n, delayLo, delayHi]
+//                            n == 0 is a pure wait of delay ms
+//   [MACRO_CANCEL]           stop a running macro
+//
+// CDC control channel only (wired test rig):
+//   [STATS_GET, section?]    reply with a STATS message (JSON counters; section 1 = power)
+//   [STATS_RESET]            zero all counters
+//   [LOG_STREAM, on]         mirror GW log lines as LOG messages
+//   [PING, data...]          reply PONG with the same data + GW micros() (LE32)
+//   [IDLE_MEASURE, seconds]  LED off and no CPU boosts for a quiet current reading
+enum FrameOpcode : uint8_t {
+  FRAME_KEY_DOWN    = 0x81,
+  FRAME_KEY_UP      = 0x82,
+  FRAME_KEY_SET     = 0x83,
+  FRAME_RELEASE_ALL = 0x84,
+  FRAME_KEEPALIVE   = 0x85,
+  FRAME_MACRO       = 0x86,
+  FRAME_MACRO_CANCEL = 0x87,
+
+  FRAME_STATS_GET   = 0x90,
+  FRAME_STATS_RESET = 0x91,
+  FRAME_LOG_STREAM  = 0x92,
+  FRAME_PING        = 0x93,
+  FRAME_IDLE_MEASURE = 0x94,
+};
+
+// Optional second byte of FRAME_STATS_GET
+enum StatsSection : uint8_t {
+  STATS_SECTION_MAIN  = 0x00,
+  STATS_SECTION_POWER = 0x01,
+};
+
+// The CDC channel is a byte stream, so every message is wrapped as
+//   [CDC_SYNC, len, payload x len]
+// Host -> GW payloads are exactly what a BLE write would carry (binary frame
+// or JSON text). GW -> host payloads start with a message type byte.
+#define CDC_SYNC 0xA5
+
+enum CdcMessageType : uint8_t {
+  CDC_MSG_STATUS = 'S', // status ack text, same strings as the BLE status characteristic
+  CDC_MSG_LOG    = 'L', // log line
+  CDC_MSG_STATS  = 'T', // telemetry JSON
+  CDC_MSG_PONG   = 'P', // ping echo + GW timestamp
+};
+
+static inline bool isBinaryFrame(const uint8_t* data, size_t len) {
+  return len > 0 && data[0] >= 0x80;
+}
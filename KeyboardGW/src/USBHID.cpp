@@ -1,12 +1,11 @@
 #include "USBHID.h"
+#include "Config.h"
+#include "CDCControl.h"
+#include "PowerControl.h"
+#include <string.h>
 
 USBHIDClass USBHID;
 
-#if defined(USE_USB_HID) && USE_USB_HID == 1
-
-#include "tusb.h"
-#include <string.h>
-
 // HID report: 8 bytes: modifiers, reserved, 6 keycodes
 struct __attribute__((packed)) KeyboardReport {
   uint8_t modifiers;
@@ -14,6 +13,12 @@ struct __attribute__((packed)) KeyboardReport {
   uint8_t keys[6];
 };
 
+// HID usages 0xE0-0xE7 are the modifier keys (LCtrl, LShift, LAlt, LGUI, RCtrl, ...)
+static inline bool isModifierUsage(uint8_t usage) { return usage >= 0xE0 && usage <= 0xE7; }
+static inline uint8_t modifierBit(uint8_t usage) { return (uint8_t)(1u << (usage - 0xE0)); }
+// Keyboard usages the GW can hold: 0x04 (A) up to the last modifier 0xE7
+static inline bool isKeyUsage(uint8_t usage) { return usage >= 0x04 && usage <= 0xE7; }
+
 // Convert an ASCII character to HID usage and optional Shift modifier.
 // Returns true if mapped, false otherwise.
 static bool asciiToUsage(char c, uint8_t* outUsage, uint8_t* outModifier) {
@@ -82,14 +87,284 @@ static bool asciiToUsage(char c, uint8_t* outUsage, uint8_t* outModifier) {
   return false;
 }
 
+uint8_t USBHIDClass::usageFromName(const char* key) {
+  if (!key) return 0;
+
+  // Check for modifier keys (case insensitive)
+  if (strcasecmp(key, "cmd") == 0 || strcasecmp(key, "command") == 0 || strcasecmp(key, "gui") == 0 || strcasecmp(key, "win") == 0) {
+    return 0xE3; // Left GUI (Cmd/Win)
+  } else if (strcasecmp(key, "ctrl") == 0 || strcasecmp(key, "control") == 0) {
+    return 0xE0; // Left Ctrl
+  } else if (strcasecmp(key, "alt") == 0 || strcasecmp(key, "option") == 0) {
+    return 0xE2; // Left Alt
+  } else if (strcasecmp(key, "shift") == 0) {
+    return 0xE1; // Left Shift
+  }
+
+  // Check for special key names
+  if (strcasecmp(key, "space") == 0) {
+    return 0x2C; // Space key
+  } else if (strcasecmp(key, "enter") == 0 || strcasecmp(key, "return") == 0) {
+    return 0x28; // Enter key
+  } else if (strcasecmp(key, "tab") == 0) {
+    return 0x2B; // Tab key
+  } else if (strcasecmp(key, "backspace") == 0) {
+    return 0x2A; // Backspace key
+  } else if (strcasecmp(key, "delete") == 0) {
+    return 0x4C; // Delete key
+  } else if (strcasecmp(key, "escape") == 0 || strcasecmp(key, "esc") == 0) {
+    return 0x29; // Escape key
+
+  // Function keys F1-F12
+  } else if (strcasecmp(key, "f1") == 0) {
+    return 0x3A; // F1
+  } else if (strcasecmp(key, "f2") == 0) {
+    return 0x3B; // F2
+  } else if (strcasecmp(key, "f3") == 0) {
+    return 0x3C; // F3 (Mission Control)
+  } else if (strcasecmp(key, "f4") == 0) {
+    return 0x3D; // F4
+  } else if (strcasecmp(key, "f5") == 0) {
+    return 0x3E; // F5
+  } else if (strcasecmp(key, "f6") == 0) {
+    return 0x3F; // F6
+  } else if (strcasecmp(key, "f7") == 0) {
+    return 0x40; // F7
+  } else if (strcasecmp(key, "f8") == 0) {
+    return 0x41; // F8
+  } else if (strcasecmp(key, "f9") == 0) {
+    return 0x42; // F9
+  } else if (strcasecmp(key, "f10") == 0) {
+    return 0x43; // F10
+  } else if (strcasecmp(key, "f11") == 0) {
+    return 0x44; // F11
+  } else if (strcasecmp(key, "f12") == 0) {
+    return 0x45; // F12
+
+  // Arrow keys (English and symbol versions)
+  } else if (strcasecmp(key, "up") == 0 || strcmp(key, "↑") == 0) {
+    return 0x52; // Up Arrow
+  } else if (strcasecmp(key, "down") == 0 || strcmp(key, "↓") == 0) {
+    return 0x51; // Down Arrow
+  } else if (strcasecmp(key, "left") == 0 || strcmp(key, "←") == 0) {
+    return 0x50; // Left Arrow
+  } else if (strcasecmp(key, "right") == 0 || strcmp(key, "→") == 0) {
+    return 0x4F; // Right Arrow
+  } else if (strlen(key) == 1) {
+    // Regular single character key - convert to usage code
+    uint8_t usage = 0;
+    uint8_t mod = 0;
+    // Convert to lowercase for consistent handling
+    char lowercaseKey = tolower(key[0]);
+    if (asciiToUsage(lowercaseKey, &usage, &mod)) {
+      // Don't add individual key modifiers for shortcuts - use only explicit modifiers
+      return usage;
+    }
+  }
+
+  return 0;
+}
+
+#if defined(USE_USB_HID) && USE_USB_HID == 1
+
+#include "tusb.h"
+
+struct QueuedReport {
+  KeyboardReport report;
+  uint16_t holdMs;     // minimum time before the next report is sent
+  uint32_t queuedUs;   // micros() at enqueue, for latency stats
+};
+
+static USBHIDClass::Stats stats;
+
+static QueueHandle_t reportQueue = nullptr;
+static portMUX_TYPE stateMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Live key state from the streaming protocol, one bit per HID usage (NKRO).
+// The 6KRO boot report is derived from it on every change.
+static uint8_t heldKeys[32];
+static volatile bool stateDirty = false;
+static volatile uint32_t lastFeedMs = 0;
+
+// Set by the host in SET_FEATURE(DEVICE_REMOTE_WAKEUP); reported on suspend
+static volatile bool remoteWakeupEnabled = false;
+
+// Must be called with stateMux held
+static void buildLiveReport(KeyboardReport* rpt) {
+  memset(rpt, 0, sizeof(*rpt));
+  size_t n = 0;
+  bool rollover = false;
+  for (int usage = 0x04; usage <= 0xE7; ++usage) {
+    if (!(heldKeys[usage >> 3] & (1u << (usage & 7)))) continue;
+    if (isModifierUsage(usage)) {
+      rpt->modifiers |= modifierBit(usage);
+    } else if (n < sizeof(rpt->keys)) {
+      rpt->keys[n++] = usage;
+    } else {
+      rollover = true;
+    }
+  }
+  // More than 6 keys: report ErrorRollOver in every slot (HID 1.11, Appendix C)
+  if (rollover) memset(rpt->keys, 0x01, sizeof(rpt->keys));
+}
+
+static bool anyKeyHeld() {
+  bool held = false;
+  portENTER_CRITICAL(&stateMux);
+  for (size_t i = 0; i < sizeof(heldKeys); ++i) {
+    if (heldKeys[i]) { held = true; break; }
+  }
+  portEXIT_CRITICAL(&stateMux);
+  return held;
+}
+
+static bool enqueueReport(const KeyboardReport& rpt, uint16_t holdMs, TickType_t wait = pdMS_TO_TICKS(100)) {
+  QueuedReport item;
+  item.report = rpt;
+  item.holdMs = holdMs;
+  item.queuedUs = micros();
+  if (xQueueSend(reportQueue, &item, wait) != pdTRUE) return false;
+  stats.queued++;
+  uint32_t depth = uxQueueMessagesWaiting(reportQueue);
+  if (depth > stats.queueHighWater) stats.queueHighWater = depth;
+  return true;
+}
+
+// Queue a snapshot of the live state. If the queue is full the pump
+// picks up the latest state once it drains, so no release is ever lost.
+static void enqueueLiveState(uint16_t holdMs = 0) {
+  KeyboardReport rpt;
+  portENTER_CRITICAL(&stateMux);
+  buildLiveReport(&rpt);
+  portEXIT_CRITICAL(&stateMux);
+  if (!enqueueReport(rpt, holdMs)) stateDirty = true;
+}
+
+// Sends queued reports at most once per poll interval, skipping any report
+// identical to the last one sent, and releases stuck keys when the stream stalls.
+static void reportPumpTask(void* arg) {
+  (void)arg;
+  KeyboardReport lastSent;
+  memset(&lastSent, 0, sizeof(lastSent));
+  uint32_t holdStartMs = 0; // when delivery started waiting for the host to resume
+
+  for (;;) {
+    if (anyKeyHeld() && (millis() - lastFeedMs) > KEYSTREAM_WATCHDOG_MS) {
+      gwLog("Key stream watchdog expired - releasing all keys");
+      USBHID.releaseAll();
+    }
+
+    QueuedReport item;
+    bool fromQueue = xQueuePeek(reportQueue, &item, 0) == pdTRUE;
+    if (!fromQueue) {
+      if (stateDirty) {
+        stateDirty = false;
+        portENTER_CRITICAL(&stateMux);
+        buildLiveReport(&item.report);
+        portEXIT_CRITICAL(&stateMux);
+        item.holdMs = 0;
+        item.queuedUs = micros();
+      } else {
+        // Nothing to send: with no key held there is no watchdog to run either,
+        // so block until the next report instead of waking every poll interval
+        TickType_t idleWait = anyKeyHeld() ? pdMS_TO_TICKS(HID_POLL_INTERVAL_MS) : portMAX_DELAY;
+        xQueuePeek(reportQueue, &item, idleWait);
+        continue;
+      }
+    }
+
+    if (memcmp(&item.report, &lastSent, sizeof(lastSent)) == 0) {
+      if (fromQueue) xQueueReceive(reportQueue, &item, 0);
+      stats.deduped++;
+      continue;
+    }
+
+    if (tud_mounted() && tud_suspended()) {
+      // Host is asleep: keep the reports queued in order and wake it once
+      if (holdStartMs == 0) {
+        holdStartMs = millis();
+        if (remoteWakeupEnabled) {
+          gwLog("USB suspended - requesting remote wakeup");
+          tud_remote_wakeup();
+        }
+      } else if (millis() - holdStartMs > USB_SUSPEND_HOLD_MS) {
+        gwLog("Host did not resume - dropping queued reports");
+        stats.dropped += uxQueueMessagesWaiting(reportQueue);
+        xQueueReset(reportQueue);
+        holdStartMs = 0;
+        continue;
+      }
+      if (!fromQueue) stateDirty = true;
+      vTaskDelay(pdMS_TO_TICKS(HID_POLL_INTERVAL_MS));
+      continue;
+    }
+    holdStartMs = 0;
+
+    if (!tud_hid_ready()) {
+      if (!tud_mounted()) {
+        // No host to deliver to: drop the report
+        if (fromQueue) xQueueReceive(reportQueue, &item, 0);
+        stats.dropped++;
+        memset(&lastSent, 0, sizeof(lastSent));
+      } else {
+        if (!fromQueue) stateDirty = true;
+        vTaskDelay(1);
+      }
+      continue;
+    }
+
+    PowerControl::boost();
+    tud_hid_report(0, &item.report, sizeof(item.report));
+    lastSent = item.report;
+    uint32_t latencyUs = micros() - item.queuedUs;
+    stats.sent++;
+    stats.latencySumUs += latencyUs;
+    if (latencyUs > stats.latencyMaxUs) stats.latencyMaxUs = latencyUs;
+    if (fromQueue) xQueueReceive(reportQueue, &item, 0);
+
+    uint16_t waitMs = item.holdMs > HID_POLL_INTERVAL_MS ? item.holdMs : HID_POLL_INTERVAL_MS;
+    vTaskDelay(pdMS_TO_TICKS(waitMs));
+  }
+}
+
 void USBHIDClass::begin() {
-  // TinyUSB initialized by core/USB.begin(); nothing here for now
+  // TinyUSB initialized by core/USB.begin(); start the report pump here
+  memset(heldKeys, 0, sizeof(heldKeys));
+  reportQueue = xQueueCreate(HID_REPORT_QUEUE_LEN, sizeof(QueuedReport));
+  xTaskCreate(reportPumpTask, "hid_pump", 3072, nullptr, 5, nullptr);
+}
+
+// Press a chord on top of any streamed (held) keys, hold it, then release back
+// to the live state (and keep that for releaseHoldMs). Both reports are queued
+// together or not at all.
+static bool queueChord(const uint8_t* usages, size_t count, uint16_t holdMs, TickType_t wait,
+                       uint16_t releaseHoldMs = 0) {
+  KeyboardReport rpt;
+  portENTER_CRITICAL(&stateMux);
+  buildLiveReport(&rpt);
+  portEXIT_CRITICAL(&stateMux);
+  for (size_t i = 0; i < count; ++i) {
+    if (isModifierUsage(usages[i])) {
+      rpt.modifiers |= modifierBit(usages[i]);
+      continue;
+    }
+    if (memchr(rpt.keys, usages[i], sizeof(rpt.keys))) continue;
+    uint8_t* slot = (uint8_t*)memchr(rpt.keys, 0, sizeof(rpt.keys));
+    if (slot) *slot = usages[i];
+  }
+
+  if (wait == 0 && uxQueueSpacesAvailable(reportQueue) < 2) return false;
+  if (!enqueueReport(rpt, holdMs, wait)) return false;
+  enqueueLiveState(releaseHoldMs);
+  return true;
 }
 
 void USBHIDClass::writeKeys(const char** keys, size_t count) {
-  if (!tud_hid_ready()) return;
+  if (!tud_mounted()) return;
 
-  // For each received token, type it literally as text: iterate chars
+  // For each received token, type it literally as text: iterate chars.
+  // Each character is a chord on top of the streamed keys, so a key held via
+  // keyDown stays down on the host while text is typed.
   for (size_t i = 0; i < count; ++i) {
     const char* s = keys[i];
     if (!s) continue;
@@ -98,135 +373,147 @@ void USBHIDClass::writeKeys(const char** keys, size_t count) {
       uint8_t mod = 0;
       if (!asciiToUsage(s[j], &usage, &mod)) continue; // skip unmapped chars
 
-      KeyboardReport rpt;
-      memset(&rpt, 0, sizeof(rpt));
-      rpt.modifiers = mod;
-      rpt.keys[0] = usage;
-      // press
-      tud_hid_report(0, &rpt, sizeof(rpt));
-      delay(8);
-      // release
-      memset(&rpt, 0, sizeof(rpt));
-      tud_hid_report(0, &rpt, sizeof(rpt));
-      delay(6);
+      uint8_t chord[2];
+      size_t n = 0;
+      if (mod) chord[n++] = 0xE1; // asciiToUsage only ever adds Left Shift
+      chord[n++] = usage;
+      // small extra pause after the last char of a token
+      queueChord(chord, n, 8, pdMS_TO_TICKS(100), s[j + 1] == '\0' ? 10 : 6);
     }
-    // small pause between tokens
-    delay(10);
   }
 }
 
 void USBHIDClass::writeShortcut(const char** keys, size_t count) {
-  if (!tud_hid_ready()) return;
+  if (!tud_mounted()) return;
 
   uint8_t modifiers = 0;
-  uint8_t keyUsages[6] = {0}; // HID supports up to 6 simultaneous keys
+  uint8_t usages[6 + 8]; // HID supports up to 6 simultaneous keys (+ modifiers)
+  size_t usageCount = 0;
   size_t keyIndex = 0;
 
   // Parse keys and build modifier + key combination
   for (size_t i = 0; i < count && keyIndex < 6; ++i) {
-    const char* key = keys[i];
-    if (!key) continue;
-
-    // Check for modifier keys (case insensitive)
-    if (strcasecmp(key, "cmd") == 0 || strcasecmp(key, "command") == 0 || strcasecmp(key, "gui") == 0 || strcasecmp(key, "win") == 0) {
-      modifiers |= 0x08; // Left GUI (Cmd/Win)
-    } else if (strcasecmp(key, "ctrl") == 0 || strcasecmp(key, "control") == 0) {
-      modifiers |= 0x01; // Left Ctrl
-    } else if (strcasecmp(key, "alt") == 0 || strcasecmp(key, "option") == 0) {
-      modifiers |= 0x04; // Left Alt
-    } else if (strcasecmp(key, "shift") == 0) {
-      modifiers |= 0x02; // Left Shift
+    uint8_t usage = usageFromName(keys[i]);
+    if (usage == 0) continue;
+    if (isModifierUsage(usage)) {
+      modifiers |= modifierBit(usage);
     } else {
-      // Check for special key names first
-      if (strcasecmp(key, "space") == 0) {
-        keyUsages[keyIndex++] = 0x2C; // Space key
-      } else if (strcasecmp(key, "enter") == 0 || strcasecmp(key, "return") == 0) {
-        keyUsages[keyIndex++] = 0x28; // Enter key
-      } else if (strcasecmp(key, "tab") == 0) {
-        keyUsages[keyIndex++] = 0x2B; // Tab key
-      } else if (strcasecmp(key, "backspace") == 0) {
-        keyUsages[keyIndex++] = 0x2A; // Backspace key
-      } else if (strcasecmp(key, "delete") == 0) {
-        keyUsages[keyIndex++] = 0x4C; // Delete key
-      } else if (strcasecmp(key, "escape") == 0 || strcasecmp(key, "esc") == 0) {
-        keyUsages[keyIndex++] = 0x29; // Escape key
-      
-      // Function keys F1-F12
-      } else if (strcasecmp(key, "f1") == 0) {
-        keyUsages[keyIndex++] = 0x3A; // F1
-      } else if (strcasecmp(key, "f2") == 0) {
-        keyUsages[keyIndex++] = 0x3B; // F2
-      } else if (strcasecmp(key, "f3") == 0) {
-        keyUsages[keyIndex++] = 0x3C; // F3 (Mission Control)
-      } else if (strcasecmp(key, "f4") == 0) {
-        keyUsages[keyIndex++] = 0x3D; // F4
-      } else if (strcasecmp(key, "f5") == 0) {
-        keyUsages[keyIndex++] = 0x3E; // F5
-      } else if (strcasecmp(key, "f6") == 0) {
-        keyUsages[keyIndex++] = 0x3F; // F6
-      } else if (strcasecmp(key, "f7") == 0) {
-        keyUsages[keyIndex++] = 0x40; // F7
-      } else if (strcasecmp(key, "f8") == 0) {
-        keyUsages[keyIndex++] = 0x41; // F8
-      } else if (strcasecmp(key, "f9") == 0) {
-        keyUsages[keyIndex++] = 0x42; // F9
-      } else if (strcasecmp(key, "f10") == 0) {
-        keyUsages[keyIndex++] = 0x43; // F10
-      } else if (strcasecmp(key, "f11") == 0) {
-        keyUsages[keyIndex++] = 0x44; // F11
-      } else if (strcasecmp(key, "f12") == 0) {
-        keyUsages[keyIndex++] = 0x45; // F12
-      
-      // Arrow keys (English and symbol versions)
-      } else if (strcasecmp(key, "up") == 0 || strcmp(key, "↑") == 0) {
-        keyUsages[keyIndex++] = 0x52; // Up Arrow
-      } else if (strcasecmp(key, "down") == 0 || strcmp(key, "↓") == 0) {
-        keyUsages[keyIndex++] = 0x51; // Down Arrow
-      } else if (strcasecmp(key, "left") == 0 || strcmp(key, "←") == 0) {
-        keyUsages[keyIndex++] = 0x50; // Left Arrow
-      } else if (strcasecmp(key, "right") == 0 || strcmp(key, "→") == 0) {
-        keyUsages[keyIndex++] = 0x4F; // Right Arrow
-      } else if (strlen(key) == 1) {
-        // Regular single character key - convert to usage code
-        uint8_t usage = 0;
-        uint8_t mod = 0;
-        // Convert to lowercase for consistent handling
-        char lowercaseKey = tolower(key[0]);
-        if (asciiToUsage(lowercaseKey, &usage, &mod)) {
-          keyUsages[keyIndex++] = usage;
-          // Don't add individual key modifiers for shortcuts - use only explicit modifiers
-          // modifiers |= mod; 
-        }
-      }
+      keyIndex++;
     }
+    usages[usageCount++] = usage;
   }
 
   // Debug: print what we're about to send
   Serial.print("Sending shortcut - Modifiers: 0x");
   Serial.print(modifiers, HEX);
   Serial.print(", Keys: ");
-  for (int i = 0; i < 6; i++) {
-    if (keyUsages[i] != 0) {
+  for (size_t i = 0; i < usageCount; i++) {
+    if (!isModifierUsage(usages[i])) {
       Serial.print("0x");
-      Serial.print(keyUsages[i], HEX);
+      Serial.print(usages[i], HEX);
       Serial.print(" ");
     }
   }
   Serial.println();
 
-  // Send the complete shortcut as one key combination
-  KeyboardReport rpt;
-  memset(&rpt, 0, sizeof(rpt));
-  rpt.modifiers = modifiers;
-  memcpy(rpt.keys, keyUsages, sizeof(keyUsages));
-  
-  // Press all keys
-  tud_hid_report(0, &rpt, sizeof(rpt));
-  delay(50); // Hold for a bit
-  
-  // Release all keys
-  memset(&rpt, 0, sizeof(rpt));
-  tud_hid_report(0, &rpt, sizeof(rpt));
+  // Press all keys and hold for a bit
+  queueChord(usages, usageCount, SHORTCUT_HOLD_MS, pdMS_TO_TICKS(100));
+}
+
+bool USBHIDClass::writeChord(const uint8_t* usages, size_t count, uint16_t holdMs) {
+  if (!tud_mounted()) return true; // nothing to deliver to; don't stall the caller
+  return queueChord(usages, count, holdMs, 0);
+}
+
+// Frames carrying anything outside 0x04-0xE7 are rejected as a whole
+static bool validUsages(const uint8_t* usages, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    if (!isKeyUsage(usages[i])) {
+      gwLog("Rejected key frame: invalid usage 0x%02X", usages[i]);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool USBHIDClass::keyDown(const uint8_t* usages, size_t count) {
+  if (!validUsages(usages, count)) return false;
+  portENTER_CRITICAL(&stateMux);
+  for (size_t i = 0; i < count; ++i) {
+    heldKeys[usages[i] >> 3] |= (uint8_t)(1u << (usages[i] & 7));
+  }
+  portEXIT_CRITICAL(&stateMux);
+  feedWatchdog();
+  enqueueLiveState();
+  return true;
+}
+
+bool USBHIDClass::keyUp(const uint8_t* usages, size_t count) {
+  if (!validUsages(usages, count)) return false;
+  portENTER_CRITICAL(&stateMux);
+  for (size_t i = 0; i < count; ++i) {
+    heldKeys[usages[i] >> 3] &= (uint8_t)~(1u << (usages[i] & 7));
+  }
+  portEXIT_CRITICAL(&stateMux);
+  feedWatchdog();
+  enqueueLiveState();
+  return true;
+}
+
+bool USBHIDClass::setKeys(const uint8_t* usages, size_t count) {
+  if (!validUsages(usages, count)) return false;
+  portENTER_CRITICAL(&stateMux);
+  memset(heldKeys, 0, sizeof(heldKeys));
+  for (size_t i = 0; i < count; ++i) {
+    heldKeys[usages[i] >> 3] |= (uint8_t)(1u << (usages[i] & 7));
+  }
+  portEXIT_CRITICAL(&stateMux);
+  feedWatchdog();
+  enqueueLiveState();
+  return true;
+}
+
+void USBHIDClass::releaseAll() {
+  portENTER_CRITICAL(&stateMux);
+  memset(heldKeys, 0, sizeof(heldKeys));
+  portEXIT_CRITICAL(&stateMux);
+  enqueueLiveState();
+}
+
+void USBHIDClass::feedWatchdog() {
+  lastFeedMs = millis();
+}
+
+void USBHIDClass::onBusSuspend(bool remoteWakeupEn) {
+  remoteWakeupEnabled = remoteWakeupEn;
+  // Light sleep stays blocked: the PHY must catch the host's resume signalling.
+  // Only an unmount (or no host at all) releases the USB lock.
+  gwLog("USB suspended (remote wakeup %s)", remoteWakeupEn ? "enabled" : "disabled");
+}
+
+void USBHIDClass::onBusResume() {
+  gwLog("USB resumed");
+}
+
+USBHIDClass::BusState USBHIDClass::busState() {
+  if (!tud_mounted()) return BUS_UNMOUNTED;
+  return tud_suspended() ? BUS_SUSPENDED : BUS_ACTIVE;
+}
+
+USBHIDClass::Stats USBHIDClass::getStats() {
+  return stats;
+}
+
+void USBHIDClass::resetStats() {
+  stats = Stats();
+}
+
+const char* USBHIDClass::deliveryStatus() {
+  switch (busState()) {
+    case BUS_UNMOUNTED: return "dropped:no_host";
+    case BUS_SUSPENDED: return remoteWakeupEnabled ? "queued:waking_host" : "queued:host_suspended";
+    default: return "sent";
+  }
 }
 
 #else
@@ -243,5 +530,17 @@ void USBHIDClass::writeShortcut(const char** keys, size_t count) {
   // Fallback: do nothing (USB HID disabled).
 }
 
-#endif
+bool USBHIDClass::writeChord(const uint8_t* usages, size_t count, uint16_t holdMs) { return true; }
+bool USBHIDClass::keyDown(const uint8_t* usages, size_t count) { return true; }
+bool USBHIDClass::keyUp(const uint8_t* usages, size_t count) { return true; }
+bool USBHIDClass::setKeys(const uint8_t* usages, size_t count) { return true; }
+void USBHIDClass::releaseAll() {}
+void USBHIDClass::feedWatchdog() {}
+void USBHIDClass::onBusSuspend(bool remoteWakeupEn) {}
+void USBHIDClass::onBusResume() {}
+USBHIDClass::BusState USBHIDClass::busState() { return BUS_UNMOUNTED; }
+const char* USBHIDClass::deliveryStatus() { return "dropped:no_host"; }
+USBHIDClass::Stats USBHIDClass::getStats() { return Stats(); }
+void USBHIDClass::resetStats() {}
 
+#endif
@@ -7,6 +7,45 @@ public:
   void begin();
   void writeKeys(const char** keys, size_t count);
   void writeShortcut(const char** keys, size_t count); // New: for keyboard shortcuts
+  // Non-blocking press+release of HID usages; returns false if the report queue is full
+  bool writeChord(const uint8_t* usages, size_t count, uint16_t holdMs);
+
+  // Key-state streaming: the client sends down/up deltas and the GW keeps
+  // the live state, emitting a report only when it changes. Returns false (and
+  // changes nothing) if any usage is outside 0x04-0xE7.
+  bool keyDown(const uint8_t* usages, size_t count);
+  bool keyUp(const uint8_t* usages, size_t count);
+  bool setKeys(const uint8_t* usages, size_t count);
+  void releaseAll();
+  void feedWatchdog();
+
+  // USB bus state. While suspended, reports stay queued and the host is
+  // woken with a remote wakeup (if it allowed one); they are delivered in
+  // order on resume.
+  enum BusState : uint8_t { BUS_UNMOUNTED, BUS_ACTIVE, BUS_SUSPENDED };
+  void onBusSuspend(bool remoteWakeupEn); // from tud_suspend_cb
+  void onBusResume();                     // from tud_resume_cb
+  BusState busState();
+  // Delivery outcome for status acks: "sent", "queued:waking_host",
+  // "queued:host_suspended" or "dropped:no_host"
+  const char* deliveryStatus();
+
+  // Report pump counters (telemetry over the CDC control channel)
+  struct Stats {
+    uint32_t queued = 0;         // reports accepted into the queue
+    uint32_t sent = 0;           // reports delivered to the host
+    uint32_t deduped = 0;        // reports skipped as identical to the last one
+    uint32_t dropped = 0;        // reports discarded (no host / suspend timeout)
+    uint32_t queueHighWater = 0;
+    uint32_t latencyMaxUs = 0;   // enqueue -> tud_hid_report
+    uint64_t latencySumUs = 0;
+  };
+  Stats getStats();
+  void resetStats();
+
+  // Map a key name ("ctrl", "a", "f5", "↑", ...) to a HID usage.
+  // Modifiers map to 0xE0-0xE7. Returns 0 if unknown.
+  static uint8_t usageFromName(const char* key);
 };
 
 extern USBHIDClass USBHID;
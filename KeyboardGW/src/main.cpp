@@ -6,6 +6,11 @@
 #include "Config.h"
 #include "USBHID.h"
 #include "LEDIndicator.h"
+#include "Protocol.h"
+#include "MacroEngine.h"
+#include "CommandHandler.h"
+#include "CDCControl.h"
+#include "PowerControl.h"
 
 // Temporary debug: when set to 1, type debug information to the USB host via HID keyboard
 // (useful for verifying what the iOS app actually sends in Notepad). Disable for normal operation.
@@ -76,6 +81,10 @@ String bytesToHex(const std::string& data) {
 }
 #endif
 
+static void notifyStatus(const std::string& status) {
+    if (pStatusChar) { pStatusChar->setValue(status); pStatusChar->notify(); }
+}
+
 class ShortcutCallbacks : public NimBLECharacteristicCallbacks {
 private:
     std::string fragmentBuffer;
@@ -84,6 +93,7 @@ private:
 
 public:
     void onWrite(NimBLECharacteristic* pCharacteristic) override {
+        PowerControl::boost();
         std::string value = pCharacteristic->getValue();
         uint32_t currentTime = millis();
         
@@ -92,6 +102,16 @@ public:
             return;
         }
 
+        // Binary frames (key-state streaming is high-rate): handle them before any logging.
+        // A pending JSON fragment may continue with UTF-8 bytes >= 0x80, so only
+        // treat the write as binary when no fragment sequence is in progress.
+        const uint8_t* raw = (const uint8_t*)value.data();
+        bool fragmentPending = !fragmentBuffer.empty() && (currentTime - lastFragmentTime) < FRAGMENT_TIMEOUT_MS;
+        if (!fragmentPending && isBinaryFrame(raw, value.length())) {
+            if (!handleBinaryFrame(raw, value.length(), notifyStatus)) notifyStatus("unknown_opcode");
+            return;
+        }
+
 #if DEBUG_RAW_BYTES
         // Immediately type raw received bytes for debugging
         typeDebugString("RAW");
@@ -156,7 +176,7 @@ public:
         lastFragmentTime = currentTime;
         
         // Try to parse as JSON
-        StaticJsonDocument<512> doc;
+        DynamicJsonDocument doc(JSON_COMMAND_CAPACITY);
         DeserializationError err = deserializeJson(doc, completePayload);
         
         if (err) {
@@ -172,8 +192,9 @@ public:
             typeDebugString("\n");
 #endif
             
-            // If single fragment failed, wait for more fragments
-            if (!isFragment && value.length() > 20) {
+            // If single fragment failed, wait for more fragments (a full
+            // document is an error of its own, not a missing fragment)
+            if (!isFragment && value.length() > 20 && err != DeserializationError::NoMemory) {
                 Serial.println("Parse failed but payload looks incomplete - waiting for fragments");
 #if DEBUG_TYPE_RAW
                 typeDebugString("dbg2wait\n");
@@ -211,77 +232,41 @@ public:
             pStatusChar->notify();
         }
 
-        if (!doc.containsKey("keys")) {
-            Serial.println("No 'keys' field in JSON");
-            if (pStatusChar) { pStatusChar->setValue("no_keys_field"); pStatusChar->notify(); }
-            return;
-        }
-
-        JsonArray keys = doc["keys"].as<JsonArray>();
-        Serial.print("Keys array size: ");
-        Serial.println(keys.size());
-
 #if DEBUG_TYPE_RAW
+        JsonArray keys = doc["keys"].as<JsonArray>();
         typeDebugString("dbg4keycnt");
         typeDebugString(String(keys.size()));
         typeDebugString("\n");
-#endif
-        
-        std::vector<String> keyStrings;
-        keyStrings.reserve(keys.size());
+        size_t keyNo = 0;
         for (auto k : keys) {
-            keyStrings.emplace_back(k.as<const char*>());
-            Serial.print("Key: ");
-            Serial.println(keyStrings.back().c_str());
-#if DEBUG_TYPE_RAW
             typeDebugString("dbg4k");
-            typeDebugString(String(keyStrings.size()-1));
+            typeDebugString(String(keyNo++));
             typeDebugString("hex");
-            typeDebugString(bytesToHex(keyStrings.back().c_str()));
+            typeDebugString(bytesToHex(k.as<const char*>()));
             typeDebugString("\n");
-#endif
         }
-
-#if DEBUG_TYPE_RAW
         typeDebugString("dbg9end\n\n");
         // Don't actually send keys in debug mode - just show what would be sent
         typeDebugString("dbgnokeys\n\n");
         LEDIndicator::blink(LED_WHITE, 80);
-        if (pStatusChar) { pStatusChar->setValue("debug_complete"); pStatusChar->notify(); }
+        notifyStatus("debug_complete");
 #else
-        std::vector<const char*> keyPtrs;
-        keyPtrs.reserve(keyStrings.size());
-        for (auto &s : keyStrings) keyPtrs.push_back(s.c_str());
-
-#if DEBUG_TYPE_RAW
-        typeDebugString("keys");
-        for (size_t i = 0; i < keyStrings.size(); i++) {
-            typeDebugString(keyStrings[i].c_str());
-            if (i < keyStrings.size() - 1) typeDebugString(",");
-        }
-        typeDebugString("\n");
-        typeDebugString("dbgnokeys\n");
-#else
-        USBHID.writeShortcut(keyPtrs.data(), keyPtrs.size());
-#endif
-
-        // Indicate sending with a short white blink
-        LEDIndicator::blink(LED_WHITE, 80);
-
-        if (pStatusChar) { pStatusChar->setValue("keys_sent_ok"); pStatusChar->notify(); }
+        handleJsonCommand(doc, notifyStatus);
 #endif
     }
 };
 
 class ServerCallbacks : public NimBLEServerCallbacks {
     void onConnect(NimBLEServer* pServer) override {
-        Serial.println("BLE connected");
+        gwLog("BLE connected");
         // Switch LED to green when a client connects
         LEDIndicator::setColor(LED_GREEN);
     }
 
     void onDisconnect(NimBLEServer* pServer) override {
-        Serial.println("BLE disconnected");
+        gwLog("BLE disconnected");
+        // Never leave keys stuck down on the host when the link drops
+        USBHID.releaseAll();
         // Return to advertising color (blue) and restart advertising
         LEDIndicator::setColor(LED_BLUE);
         NimBLEDevice::getAdvertising()->start();
@@ -293,7 +278,10 @@ void setup() {
     delay(100);
     Serial.println("=== EasyShortcutKey KeyboardGW (PlatformIO) Starting ===");
 
+    PowerControl::begin();
     USBHID.begin();
+    MacroEngine.begin();
+    CDCControl.begin();
     // Ensure TinyUSB / USB stack is started so HID interface is enumerated
     USB.begin();
     // Initialize LED indicator and show startup sequence
@@ -325,6 +313,8 @@ void setup() {
 }
 
 void loop() {
-    delay(1000);
+    // Everything runs from callbacks and tasks; drop the loop task so it
+    // does not wake the CPU once a second
+    vTaskDelete(NULL);
 }
 
@@ -1,9 +1,28 @@
 // USB descriptors and TinyUSB configuration for CDC + HID composite device
 #include "tusb.h"
+#include "Config.h"
+#include "USBHID.h"
+#include "CDCControl.h"
+#include "PowerControl.h"
 
 // Arduino-ESP32 TinyUSB integration requires these specific callback names
 // to override the default descriptors
 
+#if defined(USE_USB_CDC) && USE_USB_CDC == 1
+// CDC-ACM control channel (2 interfaces) + HID keyboard
+enum
+{
+  ITF_NUM_CDC = 0,
+  ITF_NUM_CDC_DATA,
+  ITF_NUM_HID,
+};
+
+#define ITF_NUM_TOTAL 3
+#define TUSB_DESC_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_CDC_DESC_LEN + TUD_HID_DESC_LEN)
+#define EPNUM_CDC_NOTIF 0x82
+#define EPNUM_CDC_OUT 0x03
+#define EPNUM_CDC_IN 0x83
+#else
 enum
 {
   ITF_NUM_HID = 0,
@@ -11,6 +30,7 @@ enum
 
 #define ITF_NUM_TOTAL 1
 #define TUSB_DESC_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_HID_DESC_LEN)
+#endif
 #define EPNUM_HID 0x81
 
 // Export descriptors and callbacks with C linkage so esp-idf component
@@ -29,14 +49,28 @@ const tusb_desc_device_t descriptor_device = {
   .bLength = sizeof(tusb_desc_device_t),
   .bDescriptorType = TUSB_DESC_DEVICE,
   .bcdUSB = 0x0200,
+#if defined(USE_USB_CDC) && USE_USB_CDC == 1
+  // CDC needs an IAD to group its two interfaces, which requires the MISC class
+  .bDeviceClass = TUSB_CLASS_MISC,
+  .bDeviceSubClass = MISC_SUBCLASS_COMMON,
+  .bDeviceProtocol = MISC_PROTOCOL_IAD,
+#else
   // Use per-interface class (0) to avoid IAD / MISC warnings on Windows
   .bDeviceClass = 0x00,
   .bDeviceSubClass = 0x00,
   .bDeviceProtocol = 0x00,
+#endif
   .bMaxPacketSize0 = CFG_TUD_ENDPOINT0_SIZE,
   .idVendor = 0x303A, // Espressif
-  .idProduct = 0x0002, // Custom PID for HID+CDC
+#if defined(USE_USB_CDC) && USE_USB_CDC == 1
+  // Different PID / release for the HID+CDC composite so hosts (Windows in
+  // particular) do not apply the cached descriptors of the HID-only device
+  .idProduct = 0x0003,
+  .bcdDevice = 0x0101,
+#else
+  .idProduct = 0x0002, // Custom PID (HID-only)
   .bcdDevice = 0x0100,
+#endif
   .iManufacturer = 0x01,
   .iProduct = 0x02,
   .iSerialNumber = 0x03,
@@ -62,8 +96,13 @@ uint8_t const* tud_hid_descriptor_report_cb(uint8_t instance)
 const uint8_t configuration_descriptor[] = {
   TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, TUSB_DESC_TOTAL_LEN, TUSB_DESC_CONFIG_ATT_REMOTE_WAKEUP, 100),
 
+#if defined(USE_USB_CDC) && USE_USB_CDC == 1
+  // CDC-ACM control channel: command frames, telemetry and logs for a wired test rig
+  TUD_CDC_DESCRIPTOR(ITF_NUM_CDC, 5, EPNUM_CDC_NOTIF, 8, EPNUM_CDC_OUT, EPNUM_CDC_IN, 64),
+#endif
+
   // HID interface - keyboard protocol (single interface)
-  TUD_HID_DESCRIPTOR(ITF_NUM_HID, 4, HID_ITF_PROTOCOL_KEYBOARD, sizeof(hid_report_descriptor), EPNUM_HID, 8, 10),
+  TUD_HID_DESCRIPTOR(ITF_NUM_HID, 4, HID_ITF_PROTOCOL_KEYBOARD, sizeof(hid_report_descriptor), EPNUM_HID, 8, HID_POLL_INTERVAL_MS),
 };
 
 // String descriptors
@@ -73,6 +112,7 @@ const char* string_descriptor[] = {
   "EasyShortcutKey GW",// 2: Product
   "ESPKGW-0001",       // 3: Serial
   "HID Interface",     // 4: HID Interface
+  "Control Channel",   // 5: CDC Interface
 };
 
 // Export string count so C users can determine the array length
@@ -154,29 +194,31 @@ const uint16_t* tud_descriptor_string_cb(uint8_t index, uint16_t langid)
 
 // Invoked when device is mounted
 void tud_mount_cb(void) {
-  // Optional: Add mount handling
+  PowerControl::setBusActive(true);
 }
 
 // Invoked when device is unmounted  
 void tud_umount_cb(void) {
-  // Optional: Add unmount handling
+  // No host: allow light sleep until we are plugged in again
+  PowerControl::setBusActive(false);
 }
 
 // Invoked when usb bus is suspended
 void tud_suspend_cb(bool remote_wakeup_en) {
-  (void) remote_wakeup_en;
-  // Optional: Add suspend handling
+  // Reports are held while suspended; remember whether we may wake the host
+  USBHID.onBusSuspend(remote_wakeup_en);
 }
 
 // Invoked when usb bus is resumed
 void tud_resume_cb(void) {
-  // Optional: Add resume handling
+  // Held reports are flushed by the report pump once the bus is active
+  USBHID.onBusResume();
 }
 
 // Invoked when CDC line state changed
 void tud_cdc_line_state_cb(uint8_t itf, bool dtr, bool rts) {
-  (void) itf; (void) dtr; (void) rts;
-  // Optional: Handle line state changes
+  (void) itf; (void) rts;
+  CDCControl.onLineState(dtr);
 }
 
 // Invoked when CDC line coding is changed via SET_LINE_CODING
@@ -188,7 +230,8 @@ void tud_cdc_line_coding_cb(uint8_t itf, cdc_line_coding_t const* p_line_coding)
 // Invoked when received new data
 void tud_cdc_rx_cb(uint8_t itf) {
   (void) itf;
-  // Optional: Handle incoming data
+  // Wake the control channel task to drain and parse the frames
+  CDCControl.onRx();
 }
 
 // End C linkage block
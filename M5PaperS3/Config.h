@@ -2,6 +2,7 @@
 #define CONFIG_H
 
 #include <Arduino.h>
+#include <vector>
 
 // M5PaperS3固有設定
 #define DEVICE_NAME "EasyShortcutKey-Paper"
@@ -40,10 +41,66 @@
 #define FOOTER_HEIGHT 50
 #define CONTENT_HEIGHT (DISPLAY_HEIGHT - HEADER_HEIGHT - FOOTER_HEIGHT)
 
+// リスト表示設定（グループ見出し付きの縦スクロール）
+#define LIST_HEADER_HEIGHT 36     // グループ見出しの行
+#define LIST_ROW_HEIGHT 60        // ショートカットの行
+#define LIST_PADDING 12           // 行内の左右の余白
+#define LIST_SCROLL_STEP (BUTTON_AREA_HEIGHT * 3 / 4)  // 1回のスワイプで送る量（px）
+
+// グループタブ（ボタン領域の上端）とアプリ選択画面
+#define TAB_BAR_HEIGHT 44
+#define TAB_PADDING 12            // タブ内の文字の左右の余白
+#define TAB_GAP 4
+#define TAB_ARROW_WIDTH 36        // 収まらないタブを送る ‹ › の幅
+#define BUTTON_AREA_Y (HEADER_HEIGHT + TAB_BAR_HEIGHT)
+#define BUTTON_AREA_HEIGHT (CONTENT_HEIGHT - TAB_BAR_HEIGHT)
+#define APP_PICKER_ROWS 10        // アプリ選択画面の1ページの行数
+#define APP_PICKER_PITCH 64
+
+// アイコン（icons/*.txt から scripts/icon_atlas.py で生成したフラッシュ上のアトラス）
+#define ICON_TEXT_GAP 6           // ボタン内のアイコンと文字の間隔
+
+// 部分更新領域（ヘッダー内のステータス表示・バッテリー表示）
+#define STATUS_AREA_X 4
+#define STATUS_AREA_Y 30
+#define STATUS_AREA_WIDTH 296
+#define STATUS_AREA_HEIGHT 28
+#define BATTERY_AREA_X (DISPLAY_WIDTH - 124)
+#define BATTERY_AREA_Y 4
+#define BATTERY_AREA_WIDTH 120
+#define BATTERY_AREA_HEIGHT 52
+#define PARTIAL_MERGE_SLOTS 4     // これより多くのボタン枠が変わったら1矩形にまとめて転送
+#define PRESS_FEEDBACK_MS 150     // 押下時の反転表示を元に戻すまでの時間
+#define PAGE_CACHE_PAGES 3        // PSRAMに保持するページ画像数（現在・前・次）
+
+// 描画タスク設定（loop() は Core 1 で動くので、描画は Core 0 に置く）
+#define RENDER_TASK_CORE 0
+#define RENDER_TASK_PRIORITY 2
+#define RENDER_TASK_STACK 8192
+#define RENDER_QUEUE_LENGTH 16
+#define RENDER_IDLE_POLL_MS 500        // アイドル時（残像掃除・先読み）の確認間隔
+#define RENDER_SYNC_TIMEOUT_MS 5000    // 同期コマンドの完了待ち上限
+#define RENDER_STATS_WINDOW 256        // 描画時間のヒストグラムはこの回数ごとに半分にする（直近の分布を見る）
+
 // タッチ設定
 #define TOUCH_THRESHOLD 40
+#define HIT_CELL_SIZE 16          // ヒットテスト用グリッドの1セル（px）
+#define HIT_GRID_COLS ((DISPLAY_WIDTH + HIT_CELL_SIZE - 1) / HIT_CELL_SIZE)
+#define HIT_GRID_ROWS ((DISPLAY_HEIGHT + HIT_CELL_SIZE - 1) / HIT_CELL_SIZE)
+#define HIT_CELL_CANDIDATES 4     // 1セルに掛かりうる領域の数（余白 < セル幅だと4つのボタンの角が1セルに集まる）
 #define LONG_PRESS_DURATION 1000  // ms
 #define DOUBLE_TAP_INTERVAL 300   // ms
+#define TOUCH_INT_PIN 36          // GT911 の INT（M5EPD の配線）
+#define TOUCH_TASK_CORE 1
+#define TOUCH_TASK_PRIORITY 3     // loop()（優先度1）より先に座標を読む
+#define TOUCH_TASK_STACK 4096
+#define TOUCH_RING_SIZE 32        // 1ストローク分の生サンプル
+#define TOUCH_QUEUE_LENGTH 8      // 認識済みジェスチャーの受け渡し
+#define TOUCH_RELEASE_TIMEOUT_MS 200  // 離したINTを取りこぼしたとみなすまでの時間
+#define TOUCH_LOOP_WAIT_MS 50     // loop() がタッチイベントを待つ上限（電源ボタン確認の間隔）
+#define TAP_MAX_MOVE 20           // これ以内の移動ならタップ / 長押し（px）
+#define SWIPE_MIN_DISTANCE 80     // これ以上動いたらスワイプ（px）
+#define WAKE_TAP_SEND_TIMEOUT_MS 3000  // 起こしたタップのショートカットをホストの準備まで待つ上限
 
 // 電力管理設定
 #define AUTO_SLEEP_TIME 30000     // 30秒でスリープ
@@ -55,10 +112,18 @@
 #define UPDATE_MODE_QUALITY 1     // 高品質更新（残像なし）
 #define DEFAULT_UPDATE_MODE UPDATE_MODE_QUALITY
 
+// 残像クリーンアップ設定（/config.json で上書き可）
+#define GHOST_CLEANUP_THRESHOLD 5      // この回数の部分更新で GC16 クリーンアップ対象
+#define GHOST_CLEANUP_IDLE_MS 3000     // 操作が止まってからクリーンアップするまでの時間
+#define GHOST_CLEANUP_MAX_REGIONS 4    // 1回のアイドル処理でクリーンアップする領域数（残像の多い順）
+#define GHOST_FULL_CLEANUP_REGIONS 8   // スリープ前にこれより多くの領域が汚れていれば全画面 GC16
+
 // データファイル設定
 #define SHORTCUTS_FILE "/shortcuts.json"
 #define CONFIG_FILE "/config.json"
 #define SD_CS_PIN 4
+#define CATALOG_INDEX_JSON_SIZE 8192   // 目次作成で1アプリ分に使う JSON メモリ
+#define CATALOG_GROUP_JSON_SIZE 16384  // グループを開くときに1アプリ分に使う JSON メモリ
 
 // システム設定
 #define SERIAL_BAUD_RATE 115200
@@ -69,6 +134,10 @@
 #define FONT_SIZE_MEDIUM 20
 #define FONT_SIZE_LARGE 24
 #define FONT_SIZE_HEADER 28
+#define FONT_FILE "/font.ttf"       // TFカード上のTTF（無ければ内蔵フォントで描く）
+#define FONT_RENDER_CACHE 256       // M5EPD のサイズごとのラスタライズキャッシュ
+#define GLYPH_CACHE_ENTRIES 512     // PSRAM に置くグリフキャッシュの数（LRU）
+#define GLYPH_MAX_BOX 40            // キャッシュするグリフの最大辺（px、はみ出す部分は切る）
 
 // 色設定（e-ink用グレースケール）
 #define COLOR_WHITE 15
@@ -99,10 +168,11 @@ enum KeyboardMode {
 
 // 表示モード定義
 enum DisplayMode {
-  MODE_SHORTCUTS = 0,
+  MODE_SHORTCUTS = 0,   // 開いているグループのボタン（上端にグループタブ）
   MODE_SETTINGS,
   MODE_BATTERY_INFO,
-  MODE_ABOUT
+  MODE_ABOUT,
+  MODE_APPS             // アプリ選択
 };
 
 // タッチイベント定義
@@ -129,6 +199,34 @@ struct Button {
   int id;
 };
 
+// ショートカットのグループ（buttons の連続した範囲）
+struct ShortcutGroup {
+  String name;
+  int firstButton;
+  int count;
+};
+
+// ショートカット集の目次（アプリ → グループ）
+// 起動時は名前と並び順だけを読み、ショートカット本体はグループを開くときに読む
+struct CatalogGroup {
+  String name;
+  int order;
+  int source;     // アプリ内での JSON 上の位置
+  int count;      // ショートカット数
+};
+
+struct CatalogApp {
+  String name;
+  int order;
+  int source;     // JSON 上の位置（ルート配列の要素番号）
+  std::vector<CatalogGroup> groups;  // order 順
+};
+
+// 画面上の矩形領域
+struct DisplayRect {
+  int x, y, width, height;
+};
+
 // ページ情報構造体
 struct PageInfo {
   int currentPage;
@@ -148,6 +246,9 @@ struct SystemConfig {
   KeyboardMode keyboardMode;  // USB/Bluetooth切り替え
   bool autoShutdownEnabled;
   int autoShutdownTime;  // 自動シャットダウン時間（分）
+  int ghostCleanupThreshold;  // 残像クリーンアップまでの部分更新回数
+  int ghostCleanupIdleMs;     // クリーンアップ開始までのアイドル時間
+  bool listView;              // ショートカットをグループ見出し付きのリストで表示
 };
 
 // バッテリー情報構造体
@@ -167,6 +268,26 @@ struct TouchInfo {
   bool isValid;
 };
 
+// タッチされた操作対象
+enum HitTarget {
+  HIT_NONE = 0,
+  HIT_BUTTON,          // ショートカットボタン（index = buttons の番号）
+  HIT_PREV_PAGE,
+  HIT_NEXT_PAGE,
+  HIT_SETTINGS,
+  HIT_BACK,            // 設定・バッテリー・About 画面の戻る
+  HIT_KEYBOARD_MODE,   // 設定画面のキーボードモード切り替え
+  HIT_VIEW_MODE,       // 設定画面のグリッド / リスト表示の切り替え
+  HIT_APP,             // アプリ選択画面のアプリ（index = 目次の番号）
+  HIT_APPS,            // グループタブの「Apps」（アプリ選択へ戻る）
+  HIT_GROUP_TAB        // グループタブ（index = アプリ内のグループ番号）
+};
+
+struct HitResult {
+  HitTarget target;
+  int index;
+};
+
 // ショートカットコマンド構造体（KeyboardGWと共通）
 struct ShortcutCommand {
   String keys[8];
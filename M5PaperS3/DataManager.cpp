@@ -1,9 +1,44 @@
 #include "DataManager.h"
+#include <algorithm>
+
+// 内蔵データ・インポートしたデータを SD のファイルと同じように先頭から読むためのストリーム
+class MemoryStream : public Stream {
+private:
+  const char* data;
+  size_t length;
+  size_t position;
+
+public:
+  MemoryStream() : data(""), length(0), position(0) {}
+  void begin(const char* text) {
+    data = text;
+    length = strlen(text);
+    position = 0;
+  }
+  int available() override { return length - position; }
+  int read() override { return position < length ? (uint8_t)data[position++] : -1; }
+  int peek() override { return position < length ? (uint8_t)data[position] : -1; }
+  size_t write(uint8_t) override { return 0; }
+  void flush() override {}
+};
+
+// 空白を読み飛ばして次の文字を返す（読み進めない）
+static int peekToken(Stream& in) {
+  int c = in.peek();
+  while (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+    in.read();
+    c = in.peek();
+  }
+  return c;
+}
 
 DataManager::DataManager() {
   sdCardAvailable = false;
   dataLoaded = false;
   currentDataSource = "internal";
+  sourceFile = SHORTCUTS_FILE;
+  openedApp = -1;
+  openedGroup = -1;
   setDefaultConfig();
 }
 
@@ -32,7 +67,7 @@ void DataManager::begin() {
   loadConfig();
   
   Serial.println("[Data] Data Manager initialized - Source: " + currentDataSource);
-  Serial.println("[Data] Shortcuts loaded: " + String(shortcuts.size()));
+  Serial.println("[Data] Catalog loaded: " + String(catalog.size()) + " apps");
 }
 
 bool DataManager::loadFromSDCard(const String& filename) {
@@ -46,19 +81,18 @@ bool DataManager::loadFromSDCard(const String& filename) {
     return false;
   }
   
-  String jsonData = readFile(filename);
-  if (jsonData.length() == 0) {
-    Serial.println("[Data] Failed to read file: " + filename);
-    return false;
-  }
-  
-  return parseShortcutsJSON(jsonData);
+  // 目次だけを作り、ショートカットはグループを開くときにファイルから読み直す
+  sourceFile = filename;
+  currentDataSource = "sdcard";
+  importedJSON = "";
+  return buildCatalog();
 }
 
 bool DataManager::loadFromInternal() {
   Serial.println("[Data] Loading internal default shortcuts");
   currentDataSource = "internal";
-  return parseShortcutsJSON(String(defaultShortcuts));
+  importedJSON = "";
+  return buildCatalog();
 }
 
 bool DataManager::loadConfig() {
@@ -91,6 +125,9 @@ bool DataManager::loadConfig() {
   systemConfig.touchSensitivity = doc["touchSensitivity"] | TOUCH_THRESHOLD;
   systemConfig.deepSleepEnabled = doc["deepSleepEnabled"] | true;
   systemConfig.dataSource = doc["dataSource"] | "internal";
+  systemConfig.ghostCleanupThreshold = doc["ghostCleanupThreshold"] | GHOST_CLEANUP_THRESHOLD;
+  systemConfig.ghostCleanupIdleMs = doc["ghostCleanupIdleMs"] | GHOST_CLEANUP_IDLE_MS;
+  systemConfig.listView = doc["listView"] | false;
   
   Serial.println("[Data] Config loaded successfully");
   return true;
@@ -109,6 +146,9 @@ void DataManager::saveConfig() {
   doc["touchSensitivity"] = systemConfig.touchSensitivity;
   doc["deepSleepEnabled"] = systemConfig.deepSleepEnabled;
   doc["dataSource"] = systemConfig.dataSource;
+  doc["ghostCleanupThreshold"] = systemConfig.ghostCleanupThreshold;
+  doc["ghostCleanupIdleMs"] = systemConfig.ghostCleanupIdleMs;
+  doc["listView"] = systemConfig.listView;
   
   String configJson;
   serializeJsonPretty(doc, configJson);
@@ -120,10 +160,80 @@ void DataManager::saveConfig() {
   }
 }
 
+const std::vector<CatalogApp>& DataManager::getCatalog() {
+  return catalog;
+}
+
+bool DataManager::openGroup(int app, int group) {
+  if (app < 0 || app >= (int)catalog.size()) return false;
+  if (group < 0 || group >= (int)catalog[app].groups.size()) return false;
+  if (app == openedApp && group == openedGroup) return true;
+  
+  // 前のグループを先に解放してから読む（2グループ分を同時に持たない）
+  closeGroup();
+  const CatalogApp& appInfo = catalog[app];
+  const CatalogGroup& groupInfo = appInfo.groups[group];
+  
+  // ボタンに使う項目だけを残す。読むのはこのアプリ1つ分で、ほかのアプリは読み飛ばす
+  StaticJsonDocument<256> filter;
+  JsonObject shortcutFilter = filter.createNestedArray("groups").createNestedObject()
+                                    .createNestedArray("shortcuts").createNestedObject();
+  shortcutFilter["action"] = true;
+  shortcutFilter["name"] = true;
+  shortcutFilter["keys"] = true;
+  shortcutFilter["description"] = true;
+  shortcutFilter["order"] = true;
+  
+  std::vector<Button> loaded;
+  bool ok = readApps(appInfo.source, filter, CATALOG_GROUP_JSON_SIZE, [&](int index, JsonObject root) {
+    JsonArray shortcutsArray = root["groups"][groupInfo.source]["shortcuts"];
+    std::vector<JsonObject> items;
+    for (JsonObject shortcutObj : shortcutsArray) items.push_back(shortcutObj);
+    std::stable_sort(items.begin(), items.end(), [](JsonObject a, JsonObject b) {
+      return (a["order"] | 0) < (b["order"] | 0);
+    });
+    
+    loaded.reserve(items.size());
+    for (JsonObject shortcutObj : items) {
+      loaded.push_back(createButtonFromJSON(shortcutObj, loaded.size()));
+    }
+  });
+  if (!ok) return false;
+  
+  shortcuts.swap(loaded);
+  groups.push_back({ groupInfo.name, 0, (int)shortcuts.size() });
+  openedApp = app;
+  openedGroup = group;
+  
+  Serial.println("[Data] Opened " + appInfo.name + " / " + groupInfo.name + ": " +
+                 String(shortcuts.size()) + " shortcuts (free heap " + String(ESP.getFreeHeap()) + ")");
+  return true;
+}
+
+void DataManager::closeGroup() {
+  // 確保した領域ごと手放す（clear() では容量が残る）
+  std::vector<Button>().swap(shortcuts);
+  std::vector<ShortcutGroup>().swap(groups);
+  openedApp = -1;
+  openedGroup = -1;
+}
+
+int DataManager::getOpenApp() {
+  return openedApp;
+}
+
+int DataManager::getOpenGroup() {
+  return openedGroup;
+}
+
 std::vector<Button> DataManager::getShortcuts() {
   return shortcuts;
 }
 
+std::vector<ShortcutGroup> DataManager::getGroups() {
+  return groups;
+}
+
 bool DataManager::addShortcut(const Button& shortcut) {
   shortcuts.push_back(shortcut);
   Serial.println("[Data] Shortcut added: " + shortcut.text);
@@ -159,6 +269,7 @@ bool DataManager::removeShortcut(int id) {
 
 void DataManager::clearShortcuts() {
   shortcuts.clear();
+  groups.clear();
   Serial.println("[Data] All shortcuts cleared");
 }
 
@@ -225,8 +336,10 @@ String DataManager::exportToJSON() {
 }
 
 bool DataManager::importFromJSON(const String& jsonData) {
-  clearShortcuts();
-  return parseShortcutsJSON(jsonData);
+  // 渡されたデータを読み出し元にして目次を作り直す
+  importedJSON = jsonData;
+  currentDataSource = "import";
+  return buildCatalog();
 }
 
 bool DataManager::saveToSDCard(const String& filename) {
@@ -309,11 +422,14 @@ void DataManager::printConfig() {
   Serial.println("Touch Sensitivity: " + String(systemConfig.touchSensitivity));
   Serial.println("Deep Sleep: " + String(systemConfig.deepSleepEnabled ? "Enabled" : "Disabled"));
   Serial.println("Data Source: " + systemConfig.dataSource);
+  Serial.println("Ghost Cleanup: " + String(systemConfig.ghostCleanupThreshold) + " updates, " +
+                 String(systemConfig.ghostCleanupIdleMs) + "ms idle");
   Serial.println("==============\n");
 }
 
 String DataManager::getDataInfo() {
   String info = "Data Source: " + currentDataSource + "\n";
+  info += "Apps: " + String(catalog.size()) + "\n";
   info += "Shortcuts: " + String(shortcuts.size()) + "\n";
   info += "SD Card: " + String(sdCardAvailable ? "Available" : "Not available") + "\n";
   return info;
@@ -329,59 +445,117 @@ bool DataManager::initSDCard() {
   return true;
 }
 
-bool DataManager::parseShortcutsJSON(const String& jsonData) {
-  DynamicJsonDocument doc(8192);
-  DeserializationError error = deserializeJson(doc, jsonData);
-  
-  if (error) {
-    Serial.println("[Data] JSON parsing failed: " + String(error.c_str()));
-    return false;
-  }
-  
-  clearShortcuts();
-  
-  // 新しい形式: 配列でアプリが分かれている
-  if (doc.is<JsonArray>()) {
-    JsonArray apps = doc.as<JsonArray>();
-    int buttonId = 0;
+bool DataManager::buildCatalog() {
+  closeGroup();
+  catalog.clear();
+  
+  // アプリ名・グループ名・並び順と、グループごとのショートカット数だけを残す
+  StaticJsonDocument<512> filter;
+  filter["appName"] = true;
+  filter["order"] = true;
+  JsonObject groupFilter = filter.createNestedArray("groups").createNestedObject();
+  groupFilter["groupName"] = true;
+  groupFilter["name"] = true;   // 旧形式・エクスポート形式のグループ名
+  groupFilter["order"] = true;
+  groupFilter.createNestedArray("shortcuts").createNestedObject();  // 中身は捨てて数だけ数える
+  
+  bool ok = readApps(-1, filter, CATALOG_INDEX_JSON_SIZE, [this](int index, JsonObject app) {
+    CatalogApp info;
+    info.name = app["appName"] | "";
+    if (info.name.length() == 0) info.name = "App " + String(index + 1);
+    info.order = app["order"] | 0;
+    info.source = index;
     
-    for (JsonObject app : apps) {
-      if (app.containsKey("groups") && app["groups"].is<JsonArray>()) {
-        JsonArray groups = app["groups"];
-        
-        for (JsonObject group : groups) {
-          if (group.containsKey("shortcuts") && group["shortcuts"].is<JsonArray>()) {
-            JsonArray shortcutsArray = group["shortcuts"];
-            
-            for (JsonObject shortcutObj : shortcutsArray) {
-              Button button = createButtonFromJSON(shortcutObj, buttonId++);
-              shortcuts.push_back(button);
-            }
-          }
-        }
-      }
+    int position = 0;
+    for (JsonObject group : app["groups"].as<JsonArray>()) {
+      int source = position++;
+      if (!group["shortcuts"].is<JsonArray>()) continue;
+      CatalogGroup entry;
+      entry.name = group["groupName"] | (group["name"] | "");
+      entry.order = group["order"] | 0;
+      entry.source = source;
+      entry.count = group["shortcuts"].as<JsonArray>().size();
+      info.groups.push_back(entry);
     }
-  }
-  // 旧形式: オブジェクトで直接groupsを持つ
-  else if (doc.containsKey("groups") && doc["groups"].is<JsonArray>()) {
-    JsonArray groups = doc["groups"];
-    int buttonId = 0;
+    if (info.groups.empty()) return;
+    
+    std::stable_sort(info.groups.begin(), info.groups.end(), [](const CatalogGroup& a, const CatalogGroup& b) {
+      return a.order < b.order;
+    });
+    catalog.push_back(info);
+  });
+  
+  std::stable_sort(catalog.begin(), catalog.end(), [](const CatalogApp& a, const CatalogApp& b) {
+    return a.order < b.order;
+  });
+  dataLoaded = ok;
+  
+  int groupCount = 0;
+  for (const CatalogApp& app : catalog) groupCount += app.groups.size();
+  Serial.println("[Data] Catalog built: " + String(catalog.size()) + " apps, " + String(groupCount) + " groups");
+  return ok;
+}
+
+bool DataManager::readApps(int only, const JsonDocument& filter, size_t capacity,
+                           const std::function<void(int, JsonObject)>& visit) {
+  // ルートがアプリの配列なら要素を1つずつ読み、読み終えた要素のメモリはすぐ捨てる
+  // only >= 0 ならその要素だけを読み、手前の要素は中身を残さずに読み飛ばす
+  File file;
+  MemoryStream memory;
+  Stream* in;
+  if (currentDataSource == "sdcard") {
+    file = SD.open(sourceFile);
+    if (!file) {
+      Serial.println("[Data] Failed to open file for reading: " + sourceFile);
+      return false;
+    }
+    in = &file;
+  } else {
+    memory.begin(currentDataSource == "import" ? importedJSON.c_str() : defaultShortcuts);
+    in = &memory;
+  }
+  
+  bool ok = true;
+  DeserializationError error;
+  int c = peekToken(*in);
+  
+  if (c == '{') {
+    // 1アプリだけのファイル（config/shortcutJsons の各ファイル・旧形式）
+    DynamicJsonDocument doc(capacity);
+    error = deserializeJson(doc, *in, DeserializationOption::Filter(filter));
+    if (!error) visit(0, doc.as<JsonObject>());
+  } else if (c == '[') {
+    in->read();
+    StaticJsonDocument<16> skipFilter;
+    skipFilter.to<JsonObject>();   // 空のオブジェクト = 中身をすべて読み飛ばす
     
-    for (JsonObject group : groups) {
-      if (group.containsKey("shortcuts") && group["shortcuts"].is<JsonArray>()) {
-        JsonArray shortcutsArray = group["shortcuts"];
-        
-        for (JsonObject shortcutObj : shortcutsArray) {
-          Button button = createButtonFromJSON(shortcutObj, buttonId++);
-          shortcuts.push_back(button);
-        }
+    for (int index = 0; ; index++) {
+      c = peekToken(*in);
+      if (c == ']' || c < 0) break;
+      
+      if (only >= 0 && index != only) {
+        StaticJsonDocument<64> skipped;
+        error = deserializeJson(skipped, *in, DeserializationOption::Filter(skipFilter));
+      } else {
+        DynamicJsonDocument doc(capacity);
+        error = deserializeJson(doc, *in, DeserializationOption::Filter(filter));
+        if (!error) visit(index, doc.as<JsonObject>());
       }
+      if (error || index == only) break;
+      
+      if (peekToken(*in) == ',') in->read();
     }
+  } else {
+    Serial.println("[Data] Unexpected JSON root");
+    ok = false;
   }
   
-  dataLoaded = true;
-  Serial.println("[Data] JSON parsed successfully, shortcuts: " + String(shortcuts.size()));
-  return true;
+  if (error) {
+    Serial.println("[Data] JSON parsing failed: " + String(error.c_str()));
+    ok = false;
+  }
+  if (file) file.close();
+  return ok;
 }
 
 Button DataManager::createButtonFromJSON(JsonObject shortcutObj, int id) {
@@ -428,6 +602,9 @@ void DataManager::setDefaultConfig() {
   systemConfig.touchSensitivity = TOUCH_THRESHOLD;
   systemConfig.deepSleepEnabled = true;
   systemConfig.dataSource = "internal";
+  systemConfig.ghostCleanupThreshold = GHOST_CLEANUP_THRESHOLD;
+  systemConfig.ghostCleanupIdleMs = GHOST_CLEANUP_IDLE_MS;
+  systemConfig.listView = false;
 }
 
 String DataManager::readFile(const String& filename) {
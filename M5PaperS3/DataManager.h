@@ -5,14 +5,23 @@
 #include <SD.h>
 #include <ArduinoJson.h>
 #include <vector>
+#include <functional>
 
 class DataManager {
 private:
-  std::vector<Button> shortcuts;
+  // ショートカット集は目次（catalog）だけを常に持ち、ボタンは開いているグループの分だけ作る
+  // JSON はアプリ（ルート配列の要素）単位で1つずつ読み、読み終えたら捨てる
+  std::vector<CatalogApp> catalog;
+  std::vector<Button> shortcuts;       // 開いているグループのショートカット
+  std::vector<ShortcutGroup> groups;   // 開いているグループ（shortcuts 全体を覆う1つ）
+  int openedApp;                       // 開いているグループ（-1 = なし）
+  int openedGroup;
   SystemConfig systemConfig;
   bool sdCardAvailable;
   bool dataLoaded;
   String currentDataSource;
+  String sourceFile;                   // SD カードから読むときのファイル名
+  String importedJSON;                 // importFromJSON で渡されたデータ
   
   // 内蔵データ
   const char* defaultShortcuts = R"([
@@ -56,8 +65,16 @@ public:
   bool loadConfig();
   void saveConfig();
   
-  // ショートカット管理
+  // カタログ（アプリ → グループ → ショートカット）
+  const std::vector<CatalogApp>& getCatalog();
+  bool openGroup(int app, int group);    // そのグループのショートカットだけを読み込む
+  void closeGroup();                     // 読み込んだショートカットを解放する
+  int getOpenApp();
+  int getOpenGroup();
+  
+  // ショートカット管理（開いているグループ）
   std::vector<Button> getShortcuts();
+  std::vector<ShortcutGroup> getGroups();
   bool addShortcut(const Button& shortcut);
   bool updateShortcut(int id, const Button& shortcut);
   bool removeShortcut(int id);
@@ -90,7 +107,9 @@ public:
 
 private:
   bool initSDCard();
-  bool parseShortcutsJSON(const String& jsonData);
+  bool buildCatalog();
+  bool readApps(int only, const JsonDocument& filter, size_t capacity,
+                const std::function<void(int, JsonObject)>& visit);
   Button createButtonFromJSON(JsonObject shortcutObj, int id);
   String formatKeysArray(const Button& button);
   void setDefaultConfig();
@@ -1,17 +1,49 @@
 #include "DisplayHandler.h"
+#include <algorithm>
+
+static_assert(REFRESH_CLEANUP + 1 == RENDER_STATS_KINDS, "RenderStats の RefreshKind の数を合わせる");
 
 DisplayHandler::DisplayHandler() {
   currentStatus = STATUS_STARTING;
   currentMode = MODE_SHORTCUTS;
   lastUpdateTime = 0;
-  needsUpdate = true;
   isInitialized = false;
+  dirtyRegions = REGION_FULL;
+  dirtySlots = 0;
+  highlightSlots = 0;
+  pressedIndex = -1;
+  pressRestoreTime = 0;
+  renderTaskHandle = nullptr;
+  renderQueue = nullptr;
+  stateMutex = nullptr;
+  overlayActive = false;
+  panelRetained = false;
+  textLayoutColumns = 0;
+  listHeight = 0;
+  listScrollY = 0;
+  listDrawnScrollY = -1;
+  currentApp = -1;
+  currentGroup = -1;
+  appPage = 0;
+  strips[STRIP_HEADER].y = 0;
+  strips[STRIP_HEADER].height = HEADER_HEIGHT;
+  strips[STRIP_GRID].y = HEADER_HEIGHT;
+  strips[STRIP_GRID].height = CONTENT_HEIGHT;
+  strips[STRIP_FOOTER].y = DISPLAY_HEIGHT - FOOTER_HEIGHT;
+  strips[STRIP_FOOTER].height = FOOTER_HEIGHT;
+  drawTarget = &strips[STRIP_HEADER].canvas;
+  drawOriginY = 0;
+  memset(hitCells, 0xFF, sizeof(hitCells));
   
   // デフォルト設定
   config.layoutColumns = DEFAULT_LAYOUT;
   config.updateMode = DEFAULT_UPDATE_MODE;
   config.autoSleepTime = AUTO_SLEEP_TIME;
   config.touchSensitivity = TOUCH_THRESHOLD;
+  config.ghostCleanupThreshold = GHOST_CLEANUP_THRESHOLD;
+  config.ghostCleanupIdleMs = GHOST_CLEANUP_IDLE_MS;
+  config.listView = false;
+  resetGhostCounts();
   
   // ページ情報初期化
   pageInfo.currentPage = 0;
@@ -20,23 +52,37 @@ DisplayHandler::DisplayHandler() {
   pageInfo.totalButtons = 0;
 }
 
-void DisplayHandler::begin() {
+void DisplayHandler::begin(bool keepPanel) {
   Serial.println("[Display] Initializing M5EPD...");
   
   M5.begin();
   M5.EPD.SetRotation(DISPLAY_ROTATION);
-  M5.EPD.Clear(true);
+  if (keepPanel) {
+    // 残っている画像を使えるかは restoreRetainedState() で決める（それまでは何も描かない）
+    panelRetained = true;
+  } else {
+    M5.EPD.Clear(true);
+  }
   
   initCanvas();
   
   isInitialized = true;
-  needsUpdate = true;
+  markDirty(REGION_FULL);
+  
+  // EPD転送で loop() が止まらないよう、描画は別コアのタスクで行う
+  stateMutex = xSemaphoreCreateRecursiveMutex();
+  renderQueue = xQueueCreate(RENDER_QUEUE_LENGTH, sizeof(RenderCommand));
+  xTaskCreatePinnedToCore(renderTask, "render", RENDER_TASK_STACK, this,
+                          RENDER_TASK_PRIORITY, &renderTaskHandle, RENDER_TASK_CORE);
   
   Serial.println("[Display] M5EPD initialized");
 }
 
 void DisplayHandler::setButtons(const std::vector<Button>& buttonList) {
-  buttons = buttonList;
+  lockState();
+  // 前のグループの分は容量ごと手放す（代入だけでは大きいグループの領域が残る）
+  std::vector<Button>(buttonList).swap(buttons);
+  std::vector<ButtonTextLayout>().swap(textLayouts);
   pageInfo.totalButtons = buttons.size();
   pageInfo.buttonsPerPage = getButtonsPerPage();
   pageInfo.totalPages = (pageInfo.totalButtons + pageInfo.buttonsPerPage - 1) / pageInfo.buttonsPerPage;
@@ -46,27 +92,82 @@ void DisplayHandler::setButtons(const std::vector<Button>& buttonList) {
     pageInfo.currentPage = pageInfo.totalPages - 1;
   }
   
+  textLayoutColumns = 0;
   calculateButtonLayout();
-  needsUpdate = true;
+  pageCache.invalidate();
+  // ほかの画面にいる間は、ショートカット画面へ切り替えるときに描く
+  if (currentMode == MODE_SHORTCUTS) markDirty(REGION_FULL);
+  unlockState();
+  sendCommand(RENDER_REFRESH);
   
   Serial.println("[Display] Buttons updated: " + String(buttons.size()) + " buttons");
 }
 
+void DisplayHandler::setGroups(const std::vector<ShortcutGroup>& groupList) {
+  lockState();
+  shortcutGroups = groupList;
+  unlockState();
+}
+
+void DisplayHandler::setCatalog(const std::vector<CatalogApp>& apps) {
+  lockState();
+  catalog = apps;
+  appPage = 0;
+  currentApp = -1;
+  currentGroup = -1;
+  groupTabs.clear();
+  refreshWidgets();
+  unlockState();
+  sendCommand(RENDER_REFRESH);
+}
+
+void DisplayHandler::setLocation(int app, int group) {
+  // setButtons より先に呼ぶ（描画はボタンの差し替えか画面の切り替えでまとめて1回）
+  lockState();
+  if (app != currentApp || group != currentGroup) {
+    currentApp = app;
+    currentGroup = group;
+    pageInfo.currentPage = 0;
+    listScrollY = 0;
+    layoutGroupTabs();
+    calculateButtonLayout();
+    if (currentMode == MODE_SHORTCUTS) markDirty(REGION_FULL);
+  }
+  unlockState();
+}
+
 void DisplayHandler::setStatus(DeviceStatus status) {
   if (currentStatus != status) {
+    lockState();
     currentStatus = status;
-    needsUpdate = true;
+    markDirty(REGION_STATUS);
+    unlockState();
+    sendCommand(RENDER_REFRESH);
     Serial.println("[Display] Status updated: " + String(status));
   }
 }
 
 void DisplayHandler::setBatteryInfo(const BatteryInfo& battery) {
+  bool changed = (battery.percentage != batteryInfo.percentage ||
+                  battery.isCharging != batteryInfo.isCharging ||
+                  battery.voltage != batteryInfo.voltage);
+  if (!changed) return;
+  
+  lockState();
   batteryInfo = battery;
-  needsUpdate = true;
+  // バッテリー情報画面では変わった行だけ、それ以外はヘッダーのアイコン部分だけ
+  if (currentMode == MODE_BATTERY_INFO) {
+    refreshWidgets();
+  } else {
+    markDirty(REGION_BATTERY);
+  }
+  unlockState();
+  sendCommand(RENDER_REFRESH);
 }
 
 void DisplayHandler::setConfig(const SystemConfig& cfg) {
-  bool layoutChanged = (config.layoutColumns != cfg.layoutColumns);
+  lockState();
+  bool layoutChanged = (config.layoutColumns != cfg.layoutColumns || config.listView != cfg.listView);
   config = cfg;
   
   if (layoutChanged) {
@@ -74,106 +175,537 @@ void DisplayHandler::setConfig(const SystemConfig& cfg) {
     calculateButtonLayout();
   }
   
-  needsUpdate = true;
+  pageCache.invalidate();
+  // 設定画面などにいる間は変わった項目だけ（ショートカット画面へ戻るときに全体を描き直す）
+  if (currentMode == MODE_SHORTCUTS) {
+    markDirty(REGION_FULL);
+  } else {
+    refreshWidgets();
+  }
+  unlockState();
+  sendCommand(RENDER_REFRESH);
 }
 
 void DisplayHandler::showShortcuts() {
-  currentMode = MODE_SHORTCUTS;
-  needsUpdate = true;
+  setDisplayMode(MODE_SHORTCUTS);
+}
+
+void DisplayHandler::showApps() {
+  setDisplayMode(MODE_APPS);
 }
 
 void DisplayHandler::showSettings() {
-  currentMode = MODE_SETTINGS;
-  needsUpdate = true;
+  setDisplayMode(MODE_SETTINGS);
 }
 
 void DisplayHandler::showBatteryInfo() {
-  currentMode = MODE_BATTERY_INFO;
-  needsUpdate = true;
+  setDisplayMode(MODE_BATTERY_INFO);
 }
 
 void DisplayHandler::showAbout() {
-  currentMode = MODE_ABOUT;
-  needsUpdate = true;
+  setDisplayMode(MODE_ABOUT);
 }
 
 void DisplayHandler::showSleepScreen() {
-  clear();
-  drawSleepScreen();
-  forceUpdate();
+  sendCommand(RENDER_SLEEP_SCREEN, 0, true);
 }
 
 void DisplayHandler::showShutdownScreen() {
-  clear();
-  drawShutdownScreen();
-  forceUpdate();
+  sendCommand(RENDER_SHUTDOWN_SCREEN, 0, true);
 }
 
 void DisplayHandler::update() {
-  if (!isInitialized || !needsUpdate) return;
+  sendCommand(RENDER_REFRESH);
+}
+
+void DisplayHandler::sendCommand(RenderCommandType type, int arg, bool wait) {
+  if (!renderQueue) return;
+  
+  // 描画要求は1つ積まれていれば十分（描画時には最新の状態をまとめて描く）
+  if (type == RENDER_REFRESH && uxQueueMessagesWaiting(renderQueue) > 0) return;
+  
+  RenderCommand cmd = { type, arg, wait ? xTaskGetCurrentTaskHandle() : nullptr };
+  if (xQueueSend(renderQueue, &cmd, wait ? portMAX_DELAY : 0) != pdTRUE) {
+    Serial.println("[Display] Render queue full, command dropped: " + String(type));
+    return;
+  }
+  if (wait) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(RENDER_SYNC_TIMEOUT_MS));
+  }
+}
+
+void DisplayHandler::renderTask(void* arg) {
+  DisplayHandler* self = static_cast<DisplayHandler*>(arg);
+  RenderCommand cmd;
+  TaskHandle_t waiters[RENDER_QUEUE_LENGTH];
+  
+  for (;;) {
+    int waiterCount = 0;
+    if (xQueueReceive(self->renderQueue, &cmd, self->nextRenderWait()) == pdTRUE) {
+      // 溜まったコマンドをまとめて処理し、途中の状態は描かずに最新の状態だけを描く
+      do {
+        self->handleCommand(cmd);
+        if (cmd.waiter && waiterCount < RENDER_QUEUE_LENGTH) waiters[waiterCount++] = cmd.waiter;
+      } while (xQueueReceive(self->renderQueue, &cmd, 0) == pdTRUE);
+    }
+    
+    self->render();
+    
+    for (int i = 0; i < waiterCount; i++) {
+      xTaskNotifyGive(waiters[i]);
+    }
+  }
+}
+
+void DisplayHandler::handleCommand(const RenderCommand& cmd) {
+  switch (cmd.type) {
+    case RENDER_REFRESH:
+      // ダーティフラグはフロントエンドで設定済み
+      break;
+    case RENDER_FULL:
+      lockState();
+      overlayActive = false;
+      panelRetained = false;
+      markDirty(REGION_FULL);
+      unlockState();
+      break;
+    case RENDER_FLASH:
+      // タップのフィードバックは他の描画より先にすぐ転送する
+      flashSlot(cmd.arg);
+      break;
+    case RENDER_CLEAR:
+      M5.EPD.Clear(true);
+      lockState();
+      panelRetained = false;
+      markDirty(REGION_FULL);
+      unlockState();
+      break;
+    case RENDER_SLEEP_SCREEN:
+    case RENDER_SHUTDOWN_SCREEN:
+      M5.EPD.Clear(true);
+      if (cmd.type == RENDER_SLEEP_SCREEN) {
+        drawAcrossStrips(&DisplayHandler::drawSleepScreen);
+      } else {
+        drawAcrossStrips(&DisplayHandler::drawShutdownScreen);
+      }
+      pushAllStrips(UPDATE_MODE_GC16);
+      resetGhostCounts();
+      // 次の全画面更新（復帰時）まで通常の描画で上書きしない
+      lockState();
+      overlayActive = true;
+      markDirty(REGION_FULL);
+      unlockState();
+      break;
+    case RENDER_SLEEP_CLEANUP:
+      lockState();
+      if (!overlayActive && !panelRetained) {
+        render();
+        runGhostCleanup(true);
+      }
+      unlockState();
+      flushPushes();
+      break;
+    case RENDER_ADOPT:
+      adoptPanel();
+      break;
+    case RENDER_STATS:
+      stats.print();
+      Serial.println("page cache: " + String(pageCache.getHits()) + " hits / " + String(pageCache.getMisses()) + " misses");
+      Serial.println("glyph cache: " + String(fonts.getCacheHits()) + " hits / " + String(fonts.getCacheMisses()) + " misses");
+      Serial.println("----------------------------\n");
+      if (cmd.arg) {
+        stats.reset();
+        Serial.println("[Display] Render stats reset");
+      }
+      break;
+  }
+}
+
+void DisplayHandler::printRenderStats(bool reset) {
+  // 計測値は描画タスクが書き換えるので、表示も描画タスクで行う
+  sendCommand(RENDER_STATS, reset ? 1 : 0, true);
+}
+
+TickType_t DisplayHandler::nextRenderWait() {
+  // 反転表示中はその復元時刻まで、それ以外はアイドル処理の間隔で起きる
+  if (pressedIndex >= 0) {
+    long remaining = (long)(pressRestoreTime - millis());
+    return remaining > 0 ? pdMS_TO_TICKS(remaining) : 0;
+  }
+  return pdMS_TO_TICKS(RENDER_IDLE_POLL_MS);
+}
+
+void DisplayHandler::lockState() {
+  if (stateMutex) xSemaphoreTakeRecursive(stateMutex, portMAX_DELAY);
+}
+
+void DisplayHandler::unlockState() {
+  if (stateMutex) xSemaphoreGiveRecursive(stateMutex);
+}
+
+void DisplayHandler::render() {
+  if (!isInitialized) return;
+  
+  // 状態を読んでキャンバスに描くところまではロック中、遅いパネル転送はロック外で行う
+  uint32_t start = micros();
+  lockState();
+  if (isFeedbackDue()) restorePressedButton();
+  
+  if (overlayActive || panelRetained) {
+    // スリープ/シャットダウン画面を表示中、または復帰直後でパネルの画像を使うか未定
+  } else if (!isDirty()) {
+    // 操作が止まっていれば残像の溜まった領域を掃除し、その後で前後のページを先読み
+    if (millis() - lastUpdateTime >= (unsigned long)config.ghostCleanupIdleMs) {
+      runGhostCleanup(false);
+    }
+    prefetchPages();
+  } else if (currentMode == MODE_SHORTCUTS || (dirtyRegions & (REGION_FULL | REGION_WIDGETS))) {
+    // ショートカット以外の画面はウィジェット単位で更新（ヘッダー等の変更は画面遷移時に反映）
+    if (dirtyRegions & REGION_FULL) {
+      redrawFull();
+    } else if (currentMode == MODE_SHORTCUTS) {
+      updatePartial();
+    } else {
+      updateWidgets();
+    }
+    
+    dirtyRegions = REGION_NONE;
+    dirtySlots = 0;
+    highlightSlots = 0;
+    lastUpdateTime = millis();
+  }
+  // 何も描かず転送もしなかったサイクル（アイドルの確認だけ）は数えない
+  bool worked = !pendingPushes.empty();
+  unlockState();
   
-  canvas.fillCanvas(COLOR_WHITE);
+  flushPushes();
+  if (worked) stats.record(STAGE_FRAME, start);
+}
+
+void DisplayHandler::redrawFull() {
+  drawScreen();
+  pushRegion({0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT}, REFRESH_FULL);
+  
+  if (selectUpdateMode(REFRESH_FULL) == UPDATE_MODE_GC16) {
+    resetGhostCounts();
+  } else {
+    for (int i = 0; i < GHOST_REGION_COUNT; i++) recordPartial(i);
+  }
+}
+
+void DisplayHandler::drawScreen() {
+  // 現在の画面をすべてのキャンバスに描く（転送はしない）
+  for (CanvasStrip& strip : strips) {
+    strip.canvas.fillCanvas(COLOR_WHITE);
+  }
   
   switch (currentMode) {
     case MODE_SHORTCUTS:
       drawHeader();
-      drawButtons();
+      drawGroupTabs();
+      if (config.listView) {
+        listDrawnScrollY = -1;
+        drawListViewport();
+      } else {
+        drawButtons();
+      }
       drawFooter();
       break;
     case MODE_SETTINGS:
-      drawSettingsScreen();
-      break;
     case MODE_BATTERY_INFO:
-      drawBatteryInfoScreen();
-      break;
     case MODE_ABOUT:
-      drawAboutScreen();
+    case MODE_APPS: {
+      RenderTimer timer(stats, STAGE_WIDGETS);
+      drawAcrossStrips(&DisplayHandler::drawWidgets);
+      screenWidgets.clearDamage();
       break;
+    }
+  }
+}
+
+void DisplayHandler::adoptPanel() {
+  unsigned long start = millis();
+  lockState();
+  // パネルには眠る前と同じ画面が残っているので、キャンバスに描いて「転送済み」として記録するだけ
+  // （この後のステータスやバッテリーの変化は差分転送でその部分だけ書き換わる）
+  panelRetained = false;
+  drawScreen();
+  for (CanvasStrip& strip : strips) {
+    strip.frameDiff.commitAll((const uint8_t*)strip.canvas.frameBuffer());
   }
+  dirtyRegions = REGION_NONE;
+  dirtySlots = 0;
+  highlightSlots = 0;
+  // スリープ前に部分更新の領域は GC16 で掃除してある
+  resetGhostCounts();
+  lastUpdateTime = millis();
+  unlockState();
+  
+  Serial.println("[Display] Retained panel image adopted in " + String(millis() - start) + "ms");
+}
+
+void DisplayHandler::updatePartial() {
+  uint32_t slotCount = getSlotCount();
+  uint32_t allSlots = (slotCount >= 32) ? 0xFFFFFFFF : ((1u << slotCount) - 1);
+  uint32_t contentSlots = (dirtyRegions & REGION_GRID) ? allSlots : (dirtySlots & allSlots);
+  uint32_t pressSlots = highlightSlots & allSlots & ~contentSlots;
   
-  // 更新モードに応じてディスプレイ更新
-  if (config.updateMode == UPDATE_MODE_FAST) {
-    canvas.pushCanvas(0, 0, UPDATE_MODE_A2);
+  // ページキャッシュにあればボタン領域は描き直さずにコピーして転送する
+  // （キャッシュは非押下状態で描いてあるので押下表示の復元も不要）
+  // リスト表示のスクロールは、前回の画像をずらして新しく見えた行だけ描く
+  bool gridWhole = false;
+  if (dirtyRegions & REGION_GRID) {
+    if (config.listView) {
+      drawListViewport();
+      gridWhole = true;
+    } else {
+      RenderTimer timer(stats, STAGE_BUTTONS);
+      gridWhole = pageCache.load(pageInfo.currentPage, gridFrameBuffer());
+    }
+  }
+  if (gridWhole) {
+    contentSlots = 0;
+    pressSlots = 0;
+  }
+  
+  // キャンバス上で変更部分だけ描き直す（キャンバスは常に画面と同じ内容を保つ）
+  if (dirtyRegions & (REGION_HEADER | REGION_STATUS | REGION_BATTERY)) drawHeader();
+  if (dirtyRegions & REGION_FOOTER) drawFooter();
+  for (uint32_t slot = 0; slot < slotCount; slot++) {
+    if ((contentSlots | pressSlots) & (1u << slot)) drawSlot(slot);
+  }
+  
+  // 変更された矩形だけをパネルへ転送
+  if (dirtyRegions & (REGION_HEADER | REGION_STATUS | REGION_BATTERY)) recordPartial(GHOST_REGION_HEADER);
+  if (dirtyRegions & REGION_HEADER) {
+    pushRegion({0, 0, DISPLAY_WIDTH, HEADER_HEIGHT}, REFRESH_TEXT);
   } else {
-    canvas.pushCanvas(0, 0, UPDATE_MODE_GC16);
+    if (dirtyRegions & REGION_STATUS) {
+      pushRegion({STATUS_AREA_X, STATUS_AREA_Y, STATUS_AREA_WIDTH, STATUS_AREA_HEIGHT}, REFRESH_TEXT);
+    }
+    if (dirtyRegions & REGION_BATTERY) {
+      pushRegion({BATTERY_AREA_X, BATTERY_AREA_Y, BATTERY_AREA_WIDTH, BATTERY_AREA_HEIGHT}, REFRESH_TEXT);
+    }
   }
   
-  needsUpdate = false;
-  lastUpdateTime = millis();
+  for (uint32_t slot = 0; slot < slotCount; slot++) {
+    if (pressSlots & (1u << slot)) {
+      pushRegion(getSlotRect(slot), REFRESH_HIGHLIGHT);
+      recordPartial(GHOST_REGION_SLOT_BASE + slot);
+    }
+  }
+  
+  if (gridWhole || __builtin_popcount(contentSlots) > PARTIAL_MERGE_SLOTS) {
+    // 小さな転送を大量に行うより、ボタン領域全体を1回で送る方が速い
+    pushRegion({0, BUTTON_AREA_Y, DISPLAY_WIDTH, BUTTON_AREA_HEIGHT}, REFRESH_CONTENT);
+    for (uint32_t slot = 0; slot < slotCount; slot++) recordPartial(GHOST_REGION_SLOT_BASE + slot);
+  } else {
+    for (uint32_t slot = 0; slot < slotCount; slot++) {
+      if (contentSlots & (1u << slot)) {
+        pushRegion(getSlotRect(slot), REFRESH_CONTENT);
+        recordPartial(GHOST_REGION_SLOT_BASE + slot);
+      }
+    }
+  }
+  
+  if (dirtyRegions & REGION_FOOTER) {
+    pushRegion({0, DISPLAY_HEIGHT - FOOTER_HEIGHT, DISPLAY_WIDTH, FOOTER_HEIGHT}, REFRESH_TEXT);
+    recordPartial(GHOST_REGION_FOOTER);
+  }
+}
+
+void DisplayHandler::cleanupGhosting(bool beforeSleep) {
+  if (beforeSleep) {
+    sendCommand(RENDER_SLEEP_CLEANUP, 0, true);
+  } else {
+    sendCommand(RENDER_REFRESH);
+  }
+}
+
+void DisplayHandler::runGhostCleanup(bool beforeSleep) {
+  if (!isInitialized || currentMode != MODE_SHORTCUTS) return;
+  // 未反映の変更や反転表示中の枠があるうちは掃除しない（通常の更新を優先）
+  if (!beforeSleep && (isDirty() || pressedIndex >= 0)) return;
+  if (beforeSleep && pressedIndex >= 0) {
+    restorePressedButton();
+    render();
+  }
+  
+  // スリープ前は少しでも部分更新された領域すべて、アイドル時はしきい値を超えた領域だけ
+  int threshold = beforeSleep ? 1 : max(config.ghostCleanupThreshold, 1);
+  int candidates[GHOST_REGION_COUNT];
+  int candidateCount = 0;
+  int slotCount = getSlotCount();
+  for (int i = 0; i < GHOST_REGION_SLOT_BASE + slotCount; i++) {
+    if (ghostCounts[i] >= threshold) candidates[candidateCount++] = i;
+  }
+  if (candidateCount == 0) return;
+  
+  if (beforeSleep && candidateCount > GHOST_FULL_CLEANUP_REGIONS) {
+    Serial.println("[Display] Ghost cleanup: full screen GC16");
+    pushRegion({0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT}, REFRESH_CLEANUP);
+    resetGhostCounts();
+    return;
+  }
+  
+  // 残像の多い順に並べる
+  std::sort(candidates, candidates + candidateCount, [this](int a, int b) {
+    return ghostCounts[a] > ghostCounts[b];
+  });
+  
+  // アイドル時は1回の処理量を制限して、次の操作をすぐ受け付けられるようにする
+  int limit = beforeSleep ? candidateCount : min(candidateCount, GHOST_CLEANUP_MAX_REGIONS);
+  for (int i = 0; i < limit; i++) {
+    int region = candidates[i];
+    // キャンバスは画面と同じ内容なので、転送だけで描き直せる
+    pushRegion(getGhostRegionRect(region), REFRESH_CLEANUP);
+    ghostCounts[region] = 0;
+  }
+  Serial.println("[Display] Ghost cleanup: " + String(limit) + "/" + String(candidateCount) + " regions");
+}
+
+void DisplayHandler::recordPartial(int region) {
+  if (region < 0 || region >= GHOST_REGION_COUNT) return;
+  if (ghostCounts[region] < 255) ghostCounts[region]++;
+}
+
+void DisplayHandler::resetGhostCounts() {
+  memset(ghostCounts, 0, sizeof(ghostCounts));
+}
+
+DisplayRect DisplayHandler::getGhostRegionRect(int region) {
+  if (region == GHOST_REGION_HEADER) return {0, 0, DISPLAY_WIDTH, HEADER_HEIGHT};
+  if (region == GHOST_REGION_FOOTER) return {0, DISPLAY_HEIGHT - FOOTER_HEIGHT, DISPLAY_WIDTH, FOOTER_HEIGHT};
+  return getSlotRect(region - GHOST_REGION_SLOT_BASE);
 }
 
 void DisplayHandler::forceUpdate() {
-  needsUpdate = true;
-  update();
+  sendCommand(RENDER_FULL, 0, true);
+}
+
+void DisplayHandler::markDirty(uint32_t regions) {
+  dirtyRegions |= regions;
+}
+
+void DisplayHandler::markSlotDirty(int slot, bool highlightOnly) {
+  if (slot < 0 || slot >= 32) {
+    markDirty(REGION_GRID);
+    return;
+  }
+  if (highlightOnly) {
+    highlightSlots |= (1u << slot);
+  } else {
+    dirtySlots |= (1u << slot);
+  }
+}
+
+bool DisplayHandler::isDirty() {
+  return dirtyRegions != REGION_NONE || dirtySlots != 0 || highlightSlots != 0;
 }
 
 void DisplayHandler::clear() {
-  M5.EPD.Clear(true);
+  sendCommand(RENDER_CLEAR, 0, true);
 }
 
 void DisplayHandler::nextPage() {
+  if (currentMode == MODE_APPS) {
+    scrollApps(1);
+    return;
+  }
+  if (config.listView) {
+    scrollList(LIST_SCROLL_STEP);
+    return;
+  }
   if (pageInfo.currentPage < pageInfo.totalPages - 1) {
+    lockState();
     pageInfo.currentPage++;
-    needsUpdate = true;
+    onPageChanged();
+    unlockState();
+    sendCommand(RENDER_REFRESH);
     Serial.println("[Display] Next page: " + String(pageInfo.currentPage + 1) + "/" + String(pageInfo.totalPages));
   }
 }
 
 void DisplayHandler::prevPage() {
+  if (currentMode == MODE_APPS) {
+    scrollApps(-1);
+    return;
+  }
+  if (config.listView) {
+    scrollList(-LIST_SCROLL_STEP);
+    return;
+  }
   if (pageInfo.currentPage > 0) {
+    lockState();
     pageInfo.currentPage--;
-    needsUpdate = true;
+    onPageChanged();
+    unlockState();
+    sendCommand(RENDER_REFRESH);
     Serial.println("[Display] Previous page: " + String(pageInfo.currentPage + 1) + "/" + String(pageInfo.totalPages));
   }
 }
 
+void DisplayHandler::scrollApps(int delta) {
+  int pages = max(((int)catalog.size() + APP_PICKER_ROWS - 1) / APP_PICKER_ROWS, 1);
+  int next = constrain(appPage + delta, 0, pages - 1);
+  if (next == appPage) return;
+  
+  lockState();
+  appPage = next;
+  refreshWidgets();
+  unlockState();
+  sendCommand(RENDER_REFRESH);
+}
+
 void DisplayHandler::setPage(int page) {
   if (page >= 0 && page < pageInfo.totalPages) {
+    lockState();
     pageInfo.currentPage = page;
-    needsUpdate = true;
+    onPageChanged();
+    unlockState();
+    sendCommand(RENDER_REFRESH);
   }
 }
 
+void DisplayHandler::onPageChanged() {
+  // 表示対象ボタンを切り替え、ボタン領域とページ表示だけを更新
+  // （キャッシュからの復元は描画タスクが行う）
+  calculateButtonLayout();
+  markDirty(REGION_GRID | REGION_FOOTER);
+}
+
+void DisplayHandler::prefetchPages() {
+  if (!pageCache.isAvailable() || currentMode != MODE_SHORTCUTS || config.listView) return;
+  
+  // 次 → 前 → 現在 の順に、1回の呼び出しで1ページだけ描く
+  int current = pageInfo.currentPage;
+  int order[] = { current + 1, current - 1, current };
+  for (int page : order) {
+    if (page < 0 || page >= pageInfo.totalPages || pageCache.contains(page)) continue;
+    renderPageToCache(page);
+    return;
+  }
+}
+
+void DisplayHandler::renderPageToCache(int page) {
+  unsigned long start = millis();
+  
+  pageCanvas.fillCanvas(COLOR_WHITE);
+  int startIndex = page * pageInfo.buttonsPerPage;
+  int endIndex = min(startIndex + pageInfo.buttonsPerPage, (int)buttons.size());
+  for (int i = startIndex; i < endIndex; i++) {
+    drawButton(pageCanvas, buttons[i], false, -BUTTON_AREA_Y);
+  }
+  pageCache.store(page, pageInfo.currentPage, (const uint8_t*)pageCanvas.frameBuffer());
+  
+  Serial.println("[Display] Page " + String(page + 1) + " cached in " + String(millis() - start) + "ms");
+}
+
+uint8_t* DisplayHandler::gridFrameBuffer() {
+  // ボタン領域（グループタブの下）の先頭。ページキャッシュとリストのスクロールはここから下だけを扱う
+  return (uint8_t*)strips[STRIP_GRID].canvas.frameBuffer() + TAB_BAR_HEIGHT * (DISPLAY_WIDTH / 2);
+}
+
 int DisplayHandler::getCurrentPage() {
   return pageInfo.currentPage;
 }
@@ -182,34 +714,122 @@ int DisplayHandler::getTotalPages() {
   return pageInfo.totalPages;
 }
 
-TouchInfo DisplayHandler::getTouch() {
-  TouchInfo touch;
-  touch.isValid = false;
-  touch.event = TOUCH_NONE;
+HitResult DisplayHandler::hitTest(int x, int y) {
+  HitResult result = { HIT_NONE, -1 };
+  if (x < 0 || y < 0 || x >= DISPLAY_WIDTH || y >= DISPLAY_HEIGHT) return result;
   
-  if (M5.TP.available()) {
-    if (M5.TP.isFingerUp()) {
-      touch.x = M5.TP.readFingerX(0);
-      touch.y = M5.TP.readFingerY(0);
-      touch.timestamp = millis();
-      touch.event = TOUCH_TAP;
-      touch.isValid = true;
-      
-      Serial.println("[Display] Touch detected: (" + String(touch.x) + ", " + String(touch.y) + ")");
+  lockState();
+  const uint8_t* candidates = hitCells[y / HIT_CELL_SIZE][x / HIT_CELL_SIZE];
+  for (int i = 0; i < HIT_CELL_CANDIDATES && candidates[i] != 0xFF; i++) {
+    const HitWidget& widget = hitWidgets[candidates[i]];
+    if (x >= widget.rect.x && x < widget.rect.x + widget.rect.width &&
+        y >= widget.rect.y && y < widget.rect.y + widget.rect.height) {
+      result.target = widget.target;
+      result.index = widget.index;
+      break;
     }
   }
-  
-  lastTouch = touch;
-  return touch;
+  unlockState();
+  return result;
 }
 
 Button* DisplayHandler::getTouchedButton(int x, int y) {
-  for (auto& button : buttons) {
-    if (button.isVisible && isInButton(x, y, button)) {
-      return &button;
+  HitResult hit = hitTest(x, y);
+  return hit.target == HIT_BUTTON ? &buttons[hit.index] : nullptr;
+}
+
+Button* DisplayHandler::getButton(int index) {
+  if (index < 0 || index >= (int)buttons.size()) return nullptr;
+  return &buttons[index];
+}
+
+void DisplayHandler::rebuildHitIndex() {
+  // 現在の画面で押せる領域だけを登録する（ページ・画面が変わるたびに作り直す）
+  hitWidgets.clear();
+  memset(hitCells, 0xFF, sizeof(hitCells));
+  
+  if (currentMode == MODE_SHORTCUTS) {
+    bool canPrev, canNext;
+    if (config.listView) {
+      // 見えている行だけ（見出しは押せない）
+      for (size_t i = 0; i < visibleRows.size(); i++) {
+        if (visibleRows[i].header) continue;
+        DisplayRect rect = getSlotRect(i);
+        if (rect.height > 0) addHitWidget(rect, HIT_BUTTON, visibleRows[i].index);
+      }
+      canPrev = listScrollY > 0;
+      canNext = listScrollY < listHeight - BUTTON_AREA_HEIGHT;
+    } else {
+      int startIndex = pageInfo.currentPage * pageInfo.buttonsPerPage;
+      int endIndex = min(startIndex + pageInfo.buttonsPerPage, (int)buttons.size());
+      for (int i = startIndex; i < endIndex; i++) {
+        addHitWidget({ buttons[i].x, buttons[i].y, buttons[i].width, buttons[i].height }, HIT_BUTTON, i);
+      }
+      canPrev = pageInfo.currentPage > 0;
+      canNext = pageInfo.currentPage < pageInfo.totalPages - 1;
     }
+    
+    // フッターは描画より広め（フッターの高さ全体）で受ける
+    int footerY = DISPLAY_HEIGHT - FOOTER_HEIGHT;
+    if (canPrev) {
+      addHitWidget({ 0, footerY, 100, FOOTER_HEIGHT }, HIT_PREV_PAGE);
+    }
+    if (canNext) {
+      addHitWidget({ DISPLAY_WIDTH - 100, footerY, 100, FOOTER_HEIGHT }, HIT_NEXT_PAGE);
+    }
+    addHitWidget({ DISPLAY_WIDTH / 2 - 50, footerY, 100, FOOTER_HEIGHT }, HIT_SETTINGS);
+    
+    // グループタブ（タブ列の高さ全体で受ける）
+    for (const GroupTab& tab : groupTabs) {
+      DisplayRect rect = { tab.rect.x, HEADER_HEIGHT, tab.rect.width, TAB_BAR_HEIGHT };
+      addHitWidget(rect, tab.group < 0 ? HIT_APPS : HIT_GROUP_TAB, tab.group);
+    }
+    return;
+  }
+  
+  // 押せるウィジェットを描画と同じツリーから登録する
+  for (int id = 0; id < screenWidgets.size(); id++) {
+    const Widget& widget = screenWidgets.get(id);
+    if (widget.type != WIDGET_BUTTON || widget.target == HIT_NONE) continue;
+    
+    DisplayRect rect = widget.rect;
+    // 戻るボタンは画面下端まで受ける
+    if (widget.target == HIT_BACK) rect.height = DISPLAY_HEIGHT - rect.y;
+    addHitWidget(rect, widget.target, widget.index);
+  }
+}
+
+void DisplayHandler::addHitWidget(const DisplayRect& rect, HitTarget target, int index) {
+  if (hitWidgets.size() >= 0xFF) return;
+  uint8_t id = hitWidgets.size();
+  hitWidgets.push_back({ rect, target, index });
+  
+  int col0 = max(rect.x, 0) / HIT_CELL_SIZE;
+  int row0 = max(rect.y, 0) / HIT_CELL_SIZE;
+  int col1 = min(rect.x + rect.width - 1, DISPLAY_WIDTH - 1) / HIT_CELL_SIZE;
+  int row1 = min(rect.y + rect.height - 1, DISPLAY_HEIGHT - 1) / HIT_CELL_SIZE;
+  bool overflow = false;
+  for (int row = row0; row <= row1; row++) {
+    for (int col = col0; col <= col1; col++) {
+      uint8_t* candidates = hitCells[row][col];
+      int i = 0;
+      while (i < HIT_CELL_CANDIDATES && candidates[i] != 0xFF) i++;
+      if (i < HIT_CELL_CANDIDATES) {
+        candidates[i] = id;
+      } else {
+        overflow = true;
+      }
+    }
+  }
+  // 候補が埋まったセルではこの領域をタップしても当たらない（HIT_CELL_CANDIDATES を増やす）
+  if (overflow) {
+    Serial.println("[Display] Hit cell full, target " + String((int)target) + " index " + String(index) +
+                   " only partly tappable");
   }
-  return nullptr;
+}
+
+DisplayRect DisplayHandler::getBackButtonRect() {
+  return { DISPLAY_WIDTH / 2 - 50, DISPLAY_HEIGHT - 100, 100, 40 };
 }
 
 bool DisplayHandler::isInButton(int x, int y, const Button& button) {
@@ -217,80 +837,310 @@ bool DisplayHandler::isInButton(int x, int y, const Button& button) {
           y >= button.y && y <= button.y + button.height);
 }
 
+void DisplayHandler::setButtonPressed(Button* button, bool pressed) {
+  if (!button || button->isPressed == pressed) return;
+  lockState();
+  button->isPressed = pressed;
+  int slot = slotOfButton(button->id);
+  if (slot >= 0) {
+    markSlotDirty(slot, true);
+  }
+  unlockState();
+  sendCommand(RENDER_REFRESH);
+}
+
+void DisplayHandler::flashButton(Button* button) {
+  if (!button) return;
+  sendCommand(RENDER_FLASH, button->id);
+}
+
+void DisplayHandler::flashSlot(int index) {
+  lockState();
+  int slot = slotOfButton(index);
+  if (!isInitialized || overlayActive || panelRetained || currentMode != MODE_SHORTCUTS || slot < 0 ||
+      (config.listView && listDrawnScrollY != listScrollY)) {
+    // コマンドが届くまでにページや画面が切り替わっていれば（リストならスクロールが未反映なら）何もしない
+    unlockState();
+    return;
+  }
+  
+  // 別のボタンが反転中なら先に戻す
+  if (pressedIndex >= 0 && pressedIndex != index) restorePressedButton();
+  
+  // 他の保留中の更新は待たず、このボタン枠だけを A2 で即時転送
+  buttons[index].isPressed = true;
+  drawSlot(slot);
+  pushRegion(getSlotRect(slot), REFRESH_PRESS);
+  recordPartial(GHOST_REGION_SLOT_BASE + slot);
+  
+  pressedIndex = index;
+  pressRestoreTime = millis() + PRESS_FEEDBACK_MS;
+  unlockState();
+  
+  flushPushes();
+}
+
+bool DisplayHandler::isFeedbackDue() {
+  return pressedIndex >= 0 && (long)(millis() - pressRestoreTime) >= 0;
+}
+
+void DisplayHandler::restorePressedButton() {
+  int index = pressedIndex;
+  pressedIndex = -1;
+  // ボタン一覧が差し替えられていれば全体更新で描き直される
+  if (index < 0 || index >= (int)buttons.size()) return;
+  
+  // 描画タスク内（ロック中）から呼ばれるので、フラグだけ立てて同じ描画サイクルで描く
+  buttons[index].isPressed = false;
+  int slot = slotOfButton(index);
+  if (slot >= 0) {
+    markSlotDirty(slot, true);
+  }
+}
+
 void DisplayHandler::setDisplayMode(DisplayMode mode) {
+  lockState();
   currentMode = mode;
-  needsUpdate = true;
+  overlayActive = false;
+  screenWidgets.clear();
+  describeScreen(screenWidgets);
+  rebuildHitIndex();
+  markDirty(REGION_FULL);
+  unlockState();
+  sendCommand(RENDER_REFRESH);
 }
 
 DisplayMode DisplayHandler::getDisplayMode() {
   return currentMode;
 }
 
+static uint32_t hashBytes(uint32_t hash, const void* data, size_t length) {
+  // FNV-1a
+  const uint8_t* bytes = (const uint8_t*)data;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= bytes[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+static uint32_t hashString(uint32_t hash, const String& text) {
+  return hashBytes(hash, text.c_str(), text.length() + 1);
+}
+
+uint32_t DisplayHandler::computeLayoutHash() {
+  // 画面の内容を決めるもの: 表示に効く設定、開いているグループ、ボタンの文字とキー、目次の名前
+  uint32_t hash = 2166136261u;
+  int values[] = { config.layoutColumns, config.listView, config.updateMode, config.autoSleepTime,
+                   currentApp, currentGroup };
+  hash = hashBytes(hash, values, sizeof(values));
+  for (const Button& button : buttons) {
+    hash = hashString(hash, button.text);
+    hash = hashString(hash, button.description);
+    for (int i = 0; i < button.keyCount; i++) hash = hashString(hash, button.keys[i]);
+  }
+  for (const CatalogApp& app : catalog) {
+    hash = hashString(hash, app.name);
+    for (const CatalogGroup& group : app.groups) hash = hashString(hash, group.name);
+  }
+  return hash;
+}
+
+void DisplayHandler::captureRetainedState(RetainedUiState& state) {
+  memset(&state, 0, sizeof(state));
+  lockState();
+  // スリープ画面の表示中や未反映の変更があるときは、パネルの画像と状態が一致しないので無効にする
+  if (isInitialized && !overlayActive && !panelRetained && !isDirty() && pressedIndex < 0) {
+    state.magic = RETAINED_STATE_MAGIC;
+  }
+  state.layoutHash = computeLayoutHash();
+  state.mode = currentMode;
+  state.app = currentApp;
+  state.group = currentGroup;
+  state.page = (currentMode == MODE_APPS) ? appPage : pageInfo.currentPage;
+  state.listScrollY = listScrollY;
+  state.status = currentStatus;
+  state.batteryPercent = batteryInfo.percentage;
+  state.batteryCharging = batteryInfo.isCharging;
+  state.batteryVoltage = batteryInfo.voltage;
+  
+  // ショートカット画面なら、見えているボタンの位置（当たり判定と同じ矩形）と送るキー
+  if (currentMode == MODE_SHORTCUTS) {
+    for (const HitWidget& widget : hitWidgets) {
+      if (widget.target != HIT_BUTTON || state.buttonCount >= RETAINED_MAX_BUTTONS) continue;
+      const Button& button = buttons[widget.index];
+      RetainedButton& entry = state.buttons[state.buttonCount++];
+      entry.x = widget.rect.x;
+      entry.y = widget.rect.y;
+      entry.width = widget.rect.width;
+      entry.height = widget.rect.height;
+      entry.index = widget.index;
+      
+      bool fits = button.keyCount <= RETAINED_MAX_KEYS;
+      for (int k = 0; fits && k < button.keyCount; k++) {
+        fits = button.keys[k].length() < RETAINED_KEY_NAME;
+        if (fits) strlcpy(entry.keys[k], button.keys[k].c_str(), RETAINED_KEY_NAME);
+      }
+      entry.keyCount = fits ? button.keyCount : 0;
+    }
+  }
+  unlockState();
+}
+
+bool DisplayHandler::restoreRetainedState(const RetainedUiState& state) {
+  // 設定・目次・開いているグループ・ボタンを眠る前と同じように渡してから呼ぶ
+  lockState();
+  if (!panelRetained || computeLayoutHash() != state.layoutHash) {
+    unlockState();
+    Serial.println("[Display] Retained state does not match, full redraw");
+    return false;
+  }
+  
+  // パネルに表示されている状態に合わせる（ステータス・バッテリーはこの後の更新で差分だけ描く）
+  currentMode = (DisplayMode)state.mode;
+  currentStatus = (DeviceStatus)state.status;
+  batteryInfo.percentage = state.batteryPercent;
+  batteryInfo.isCharging = state.batteryCharging;
+  batteryInfo.voltage = state.batteryVoltage;
+  if (currentMode == MODE_APPS) {
+    appPage = state.page;
+  } else {
+    pageInfo.currentPage = constrain((int)state.page, 0, pageInfo.totalPages - 1);
+  }
+  listScrollY = state.listScrollY;
+  calculateButtonLayout();
+  screenWidgets.clear();
+  describeScreen(screenWidgets);
+  rebuildHitIndex();
+  unlockState();
+  
+  sendCommand(RENDER_ADOPT, 0, true);
+  return true;
+}
+
 void DisplayHandler::initCanvas() {
-  canvas.createCanvas(DISPLAY_WIDTH, DISPLAY_HEIGHT);
-  canvas.setTextSize(FONT_SIZE_MEDIUM);
-  canvas.setTextColor(COLOR_BLACK);
+  // ヘッダー・ボタン領域・フッターを別々のキャンバスにし、変わった領域のキャンバスだけを転送する
+  // 差分転送用の直前フレームも領域ごとに持つ。確保できないか自己チェックに通らなければ指定された矩形をそのまま転送する
+  bool frameDiffOk = FrameDiff::selfCheck();
+  if (!frameDiffOk) {
+    Serial.println("[Display] Frame diff disabled (self-check failed)");
+  }
+  for (int i = 0; i < STRIP_COUNT; i++) {
+    CanvasStrip& strip = strips[i];
+    strip.canvas.createCanvas(DISPLAY_WIDTH, strip.height);
+    strip.canvas.setTextSize(FONT_SIZE_MEDIUM);
+    strip.canvas.setTextColor(COLOR_BLACK);
+    if (frameDiffOk && !strip.frameDiff.begin(DISPLAY_WIDTH, strip.height)) {
+      Serial.println("[Display] Frame diff disabled for strip " + String(i) + " (allocation failed)");
+    }
+  }
+  selectStrip(STRIP_HEADER);
+  fonts.begin();
+  
+  // ページキャッシュ（PSRAM）。確保できなければ毎回描画する
+  if (pageCache.begin((DISPLAY_WIDTH / 2) * BUTTON_AREA_HEIGHT)) {
+    pageCanvas.createCanvas(DISPLAY_WIDTH, BUTTON_AREA_HEIGHT);
+    pageCanvas.setTextColor(COLOR_BLACK);
+  }
+}
+
+void DisplayHandler::selectStrip(int strip) {
+  drawTarget = &strips[strip].canvas;
+  drawOriginY = strips[strip].y;
+}
+
+void DisplayHandler::drawAcrossStrips(void (DisplayHandler::*draw)()) {
+  // 画面全体のレイアウトの画面は、領域ごとに同じ描画を繰り返す（はみ出した分はキャンバスで切られる）
+  for (int i = 0; i < STRIP_COUNT; i++) {
+    selectStrip(i);
+    (this->*draw)();
+  }
 }
 
 void DisplayHandler::drawHeader() {
+  RenderTimer timer(stats, STAGE_HEADER);
+  selectStrip(STRIP_HEADER);
+  
   // ヘッダー背景
-  canvas.fillRect(0, 0, DISPLAY_WIDTH, HEADER_HEIGHT, COLOR_GRAY_LIGHT);
-  canvas.drawRect(0, 0, DISPLAY_WIDTH, HEADER_HEIGHT, COLOR_BLACK);
+  fillRect(0, 0, DISPLAY_WIDTH, HEADER_HEIGHT, COLOR_GRAY_LIGHT);
+  drawRect(0, 0, DISPLAY_WIDTH, HEADER_HEIGHT, COLOR_BLACK);
   
   // タイトル
-  canvas.setTextSize(FONT_SIZE_HEADER);
   drawCenteredText(DEVICE_NAME, 0, 20, DISPLAY_WIDTH / 2, FONT_SIZE_HEADER);
   
   // バッテリーアイコン
   int batteryX = DISPLAY_WIDTH - 120;
   int batteryY = 15;
   drawBatteryIcon(batteryX, batteryY, batteryInfo.percentage);
-  canvas.setTextSize(FONT_SIZE_SMALL);
-  canvas.setCursor(batteryX + 35, batteryY + 5);
-  canvas.printf("%d%%", batteryInfo.percentage);
+  drawText(String(batteryInfo.percentage) + "%", batteryX + 35, batteryY + 5, FONT_SIZE_SMALL);
   
-  // 接続状態
-  String statusText = "";
+  // 接続状態（アイコンはヘッダーの背景色込みの不透明な絵なので、行ごとのコピーで済む）
+  IconId statusIcon;
+  String statusText;
   switch (currentStatus) {
     case STATUS_READY:
-      statusText = "� USB Ready";
+      statusIcon = ICON_USB;
+      statusText = "USB Ready";
       break;
     case STATUS_SENDING_KEYS:
-      statusText = "⌨️ Sending";
+      statusIcon = ICON_KEYBOARD;
+      statusText = "Sending";
       break;
     case STATUS_ERROR:
-      statusText = "❌ Error";
+      statusIcon = ICON_ERROR;
+      statusText = "Error";
       break;
     case STATUS_LOW_BATTERY:
-      statusText = "🔋 Low Battery";
+      statusIcon = ICON_BATTERY_LOW;
+      statusText = "Low Battery";
       break;
     default:
-      statusText = "🔄 Starting";
+      statusIcon = ICON_HOURGLASS;
+      statusText = "Starting";
       break;
   }
   
-  canvas.setTextSize(FONT_SIZE_SMALL);
-  canvas.setCursor(10, 35);
-  canvas.print(statusText);
+  drawIcon(statusIcon, 10, 36);
+  drawText(statusText, 32, 35, FONT_SIZE_SMALL);
 }
 
 void DisplayHandler::drawFooter() {
+  RenderTimer timer(stats, STAGE_FOOTER);
   int footerY = DISPLAY_HEIGHT - FOOTER_HEIGHT;
+  selectStrip(STRIP_FOOTER);
   
   // フッター背景
-  canvas.fillRect(0, footerY, DISPLAY_WIDTH, FOOTER_HEIGHT, COLOR_GRAY_LIGHT);
-  canvas.drawRect(0, footerY, DISPLAY_WIDTH, FOOTER_HEIGHT, COLOR_BLACK);
+  fillRect(0, footerY, DISPLAY_WIDTH, FOOTER_HEIGHT, COLOR_GRAY_LIGHT);
+  drawRect(0, footerY, DISPLAY_WIDTH, FOOTER_HEIGHT, COLOR_BLACK);
   
-  // ページネーション
-  if (pageInfo.totalPages > 1) {
+  if (config.listView) {
+    // スクロール位置（見えているショートカットの範囲）
+    if (listScrollY > 0) {
+      drawRectButton(10, footerY + 10, 80, 30, "Up", false, ICON_UP);
+    }
+    if (listScrollY < listHeight - BUTTON_AREA_HEIGHT) {
+      drawRectButton(DISPLAY_WIDTH - 90, footerY + 10, 80, 30, "Down", false, ICON_DOWN, true);
+    }
+    int first = -1, last = -1;
+    for (const ListRow& row : visibleRows) {
+      if (row.header) continue;
+      if (first < 0) first = row.index;
+      last = row.index;
+    }
+    if (first >= 0) {
+      String rangeText = String(first + 1) + "-" + String(last + 1) + "/" + String(buttons.size());
+      drawCenteredText(rangeText, 0, footerY + 15, DISPLAY_WIDTH, FONT_SIZE_SMALL);
+    }
+  } else if (pageInfo.totalPages > 1) {
+    // ページネーション
     // Previous button
     if (pageInfo.currentPage > 0) {
-      drawRectButton(10, footerY + 10, 80, 30, "◀ Prev", false);
+      drawRectButton(10, footerY + 10, 80, 30, "Prev", false, ICON_PREV);
     }
     
     // Next button
     if (pageInfo.currentPage < pageInfo.totalPages - 1) {
-      drawRectButton(DISPLAY_WIDTH - 90, footerY + 10, 80, 30, "Next ▶", false);
+      drawRectButton(DISPLAY_WIDTH - 90, footerY + 10, 80, 30, "Next", false, ICON_NEXT, true);
     }
     
     // Page info
@@ -299,10 +1149,77 @@ void DisplayHandler::drawFooter() {
   }
   
   // Settings button
-  drawRectButton(DISPLAY_WIDTH/2 - 50, footerY + 10, 100, 30, "⚙️ Settings", false);
+  drawRectButton(DISPLAY_WIDTH/2 - 50, footerY + 10, 100, 30, "Settings", false, ICON_SETTINGS);
+}
+
+void DisplayHandler::layoutGroupTabs() {
+  // 「Apps」の後ろに今のアプリのグループを並べ、入りきらなければ開いているグループが見える所から並べる
+  // （隠れた分は ‹ › のタブで隣のグループを開く）
+  groupTabs.clear();
+  if (currentApp < 0 || currentApp >= (int)catalog.size()) return;
+  const std::vector<CatalogGroup>& groups = catalog[currentApp].groups;
+  
+  int y = HEADER_HEIGHT + 4;
+  int height = TAB_BAR_HEIGHT - 8;
+  int x = TAB_GAP;
+  String appsLabel = "≡ Apps";
+  int appsWidth = getTextWidth(appsLabel, FONT_SIZE_SMALL) + TAB_PADDING * 2;
+  groupTabs.push_back({ { x, y, appsWidth, height }, -1, appsLabel });
+  x += appsWidth + TAB_GAP;
+  
+  std::vector<int> widths;
+  for (const CatalogGroup& group : groups) {
+    widths.push_back(getTextWidth(group.name, FONT_SIZE_SMALL) + TAB_PADDING * 2);
+  }
+  
+  // 右端には › の分を空けておく（最後のグループまで入るなら不要）
+  int right = DISPLAY_WIDTH - TAB_GAP;
+  int arrow = TAB_ARROW_WIDTH + TAB_GAP;
+  int current = constrain(currentGroup, 0, (int)groups.size() - 1);
+  int first = 0;
+  while (first < current) {
+    int width = (first > 0 ? arrow : 0);
+    for (int i = first; i <= current; i++) width += widths[i] + TAB_GAP;
+    int limit = right - x - (current < (int)groups.size() - 1 ? arrow : 0);
+    if (width <= limit) break;
+    first++;
+  }
+  
+  if (first > 0) {
+    groupTabs.push_back({ { x, y, TAB_ARROW_WIDTH, height }, first - 1, "‹" });
+    x += arrow;
+  }
+  int next = first;
+  for (; next < (int)groups.size(); next++) {
+    bool lastTab = (next == (int)groups.size() - 1);
+    if (x + widths[next] > right - (lastTab ? 0 : arrow)) break;
+    groupTabs.push_back({ { x, y, widths[next], height }, next, groups[next].name });
+    x += widths[next] + TAB_GAP;
+  }
+  if (next < (int)groups.size()) {
+    groupTabs.push_back({ { right - TAB_ARROW_WIDTH, y, TAB_ARROW_WIDTH, height }, next, "›" });
+  }
+}
+
+void DisplayHandler::drawGroupTabs() {
+  selectStrip(STRIP_GRID);
+  fillRect(0, HEADER_HEIGHT, DISPLAY_WIDTH, TAB_BAR_HEIGHT, COLOR_WHITE);
+  fillRect(0, BUTTON_AREA_Y - 1, DISPLAY_WIDTH, 1, COLOR_BLACK);
+  
+  for (const GroupTab& tab : groupTabs) {
+    const DisplayRect& r = tab.rect;
+    if (tab.group == currentGroup) {
+      // 開いているグループは白黒反転
+      fillRect(r.x, r.y, r.width, r.height, COLOR_BLACK);
+      drawCenteredText(tab.label, r.x, r.y + r.height / 2 - 8, r.width, FONT_SIZE_SMALL, COLOR_WHITE);
+    } else {
+      drawRectButton(r.x, r.y, r.width, r.height, tab.label, false);
+    }
+  }
 }
 
 void DisplayHandler::drawButtons() {
+  RenderTimer timer(stats, STAGE_BUTTONS);
   int startIndex = pageInfo.currentPage * pageInfo.buttonsPerPage;
   int endIndex = min(startIndex + pageInfo.buttonsPerPage, (int)buttons.size());
   
@@ -313,65 +1230,310 @@ void DisplayHandler::drawButtons() {
   }
 }
 
+void DisplayHandler::drawSlot(int slot) {
+  RenderTimer timer(stats, STAGE_SLOT);
+  // 枠ごと消してから、その位置にボタンがあれば描く（最終ページの空き枠も消す）
+  DisplayRect rect = getSlotRect(slot);
+  selectStrip(STRIP_GRID);
+  fillRect(rect.x, rect.y, rect.width, rect.height, COLOR_WHITE);
+  
+  if (config.listView) {
+    if (slot < (int)visibleRows.size()) drawListRow(visibleRows[slot]);
+    return;
+  }
+  
+  int index = pageInfo.currentPage * pageInfo.buttonsPerPage + slot;
+  if (index < (int)buttons.size() && buttons[index].isVisible) {
+    drawButton(buttons[index], buttons[index].isPressed);
+  }
+}
+
 void DisplayHandler::drawButton(const Button& button, bool pressed) {
-  // ボタン背景
-  int bgColor = pressed ? COLOR_GRAY_DARK : COLOR_WHITE;
+  drawButton(strips[STRIP_GRID].canvas, button, pressed, -HEADER_HEIGHT);
+}
+
+void DisplayHandler::drawButton(M5EPD_Canvas& target, const Button& button, bool pressed, int offsetY) {
+  // ボタン背景（押下中は白黒反転。A2/DU でもそのまま表示できる）
+  int bgColor = pressed ? COLOR_BLACK : COLOR_WHITE;
   int borderColor = COLOR_BLACK;
+  int y = button.y + offsetY;
   
-  canvas.fillRect(button.x, button.y, button.width, button.height, bgColor);
-  canvas.drawRect(button.x, button.y, button.width, button.height, borderColor);
+  target.fillRect(button.x, y, button.width, button.height, bgColor);
+  target.drawRect(button.x, y, button.width, button.height, borderColor);
+  int textColor = pressed ? COLOR_WHITE : COLOR_BLACK;
   
-  // ショートカットキー表示
-  String keyText = formatShortcutKeys(button);
-  canvas.setTextSize(FONT_SIZE_MEDIUM);
-  drawCenteredText(keyText, button.x, button.y + 10, button.width, FONT_SIZE_MEDIUM);
+  // 文字列と位置は buildTextLayouts() で計算済み
+  const ButtonTextLayout& layout = textLayouts[button.id];
+  drawText(target, layout.keyLabel, button.x + layout.keyX, y + layout.keyY, FONT_SIZE_MEDIUM, textColor);
   
-  // 説明テキスト
-  if (button.description.length() > 0) {
-    canvas.setTextSize(FONT_SIZE_SMALL);
-    drawCenteredText(button.description, button.x, button.y + button.height - 25, button.width, FONT_SIZE_SMALL);
+  if (layout.descY >= 0) {
+    drawText(target, button.description, button.x + layout.descX, y + layout.descY, FONT_SIZE_SMALL, textColor);
   }
 }
 
 void DisplayHandler::drawBatteryIcon(int x, int y, int percentage) {
-  // バッテリー外枠
-  canvas.drawRect(x, y, 30, 15, COLOR_BLACK);
-  canvas.drawRect(x + 30, y + 4, 3, 7, COLOR_BLACK);
+  // バッテリー外枠（アトラスの絵）
+  drawIcon(ICON_BATTERY, x, y);
   
   // バッテリー残量
-  int fillWidth = (percentage * 26) / 100;
+  int fillWidth = (constrain(percentage, 0, 100) * 26) / 100;
   int fillColor = percentage > 20 ? COLOR_GRAY_DARK : COLOR_BLACK;
-  canvas.fillRect(x + 2, y + 2, fillWidth, 11, fillColor);
+  fillRect(x + 2, y + 2, fillWidth, 12, fillColor);
 }
 
 void DisplayHandler::calculateButtonLayout() {
-  if (buttons.empty()) return;
+  pageInfo.buttonsPerPage = getButtonsPerPage();
+  if (config.listView) {
+    // リスト表示ではボタンごとの配置は作らず、見えている行だけを組み立てる
+    rebuildListIndex();
+    materializeListRows();
+    rebuildHitIndex();
+    return;
+  }
+  if (buttons.empty()) {
+    rebuildHitIndex();
+    return;
+  }
+  
+  for (size_t i = 0; i < buttons.size(); i++) {
+    int page = i / pageInfo.buttonsPerPage;
+    DisplayRect rect = getSlotRect(i % pageInfo.buttonsPerPage);
+    
+    buttons[i].x = rect.x;
+    buttons[i].y = rect.y;
+    buttons[i].width = rect.width;
+    buttons[i].height = rect.height;
+    buttons[i].isVisible = (page == pageInfo.currentPage);
+    buttons[i].id = i;
+  }
+  
+  // 文字列の配置はボタンの幅（列数）が変わったときだけ作り直す
+  if (textLayoutColumns != config.layoutColumns || textLayouts.size() != buttons.size()) {
+    buildTextLayouts();
+  }
+  
+  rebuildHitIndex();
+}
+
+void DisplayHandler::buildTextLayouts() {
+  textLayouts.resize(buttons.size());
+  
+  for (size_t i = 0; i < buttons.size(); i++) {
+    const Button& button = buttons[i];
+    ButtonTextLayout& layout = textLayouts[i];
+    
+    layout.keyLabel = formatShortcutKeys(button);
+    layout.keyX = (button.width - getTextWidth(layout.keyLabel, FONT_SIZE_MEDIUM)) / 2;
+    layout.keyY = 10;
+    
+    if (button.description.length() > 0) {
+      layout.descX = (button.width - getTextWidth(button.description, FONT_SIZE_SMALL)) / 2;
+      layout.descY = button.height - 25;
+    } else {
+      layout.descX = 0;
+      layout.descY = -1;
+    }
+  }
+  
+  textLayoutColumns = config.layoutColumns;
+}
+
+DisplayRect DisplayHandler::getSlotRect(int slot) {
+  if (config.listView) {
+    // 見えている行の矩形（ボタン領域の外にはみ出す部分は除く）
+    if (slot < 0 || slot >= (int)visibleRows.size()) return { 0, BUTTON_AREA_Y, 0, 0 };
+    const ListRow& row = visibleRows[slot];
+    int y0 = max(row.top - listScrollY, 0);
+    int y1 = min(row.top - listScrollY + row.height, BUTTON_AREA_HEIGHT);
+    return { 0, BUTTON_AREA_Y + y0, DISPLAY_WIDTH, max(y1 - y0, 0) };
+  }
   
   int buttonWidth = (config.layoutColumns == 2) ? BUTTON_WIDTH_2COL : BUTTON_WIDTH_3COL;
   int buttonHeight = (config.layoutColumns == 2) ? BUTTON_HEIGHT_2COL : BUTTON_HEIGHT_3COL;
   
   int cols = config.layoutColumns;
-  int startY = HEADER_HEIGHT + BUTTON_MARGIN;
-  int availableHeight = CONTENT_HEIGHT - BUTTON_MARGIN * 2;
-  int rows = availableHeight / (buttonHeight + BUTTON_MARGIN);
-  
-  pageInfo.buttonsPerPage = cols * rows;
-  
+  int startY = BUTTON_AREA_Y + BUTTON_MARGIN;
   int totalWidth = cols * buttonWidth + (cols - 1) * BUTTON_MARGIN;
   int startX = (DISPLAY_WIDTH - totalWidth) / 2;
   
-  for (size_t i = 0; i < buttons.size(); i++) {
-    int page = i / pageInfo.buttonsPerPage;
-    int indexInPage = i % pageInfo.buttonsPerPage;
-    int row = indexInPage / cols;
-    int col = indexInPage % cols;
+  int row = slot / cols;
+  int col = slot % cols;
+  return { startX + col * (buttonWidth + BUTTON_MARGIN),
+           startY + row * (buttonHeight + BUTTON_MARGIN),
+           buttonWidth, buttonHeight };
+}
+
+int DisplayHandler::getSlotCount() {
+  // 部分更新・残像カウントの単位（グリッドはページ内のボタン枠、リストは見えている行）
+  int count = config.listView ? (int)visibleRows.size() : pageInfo.buttonsPerPage;
+  return min(count, 32);
+}
+
+int DisplayHandler::slotOfButton(int index) {
+  // 表示されていなければ -1
+  if (index < 0 || index >= (int)buttons.size()) return -1;
+  if (config.listView) {
+    for (size_t i = 0; i < visibleRows.size() && i < 32; i++) {
+      if (!visibleRows[i].header && visibleRows[i].index == index) return i;
+    }
+    return -1;
+  }
+  return buttons[index].isVisible ? index - pageInfo.currentPage * pageInfo.buttonsPerPage : -1;
+}
+
+void DisplayHandler::rebuildListIndex() {
+  // DataManager のグループを buttons の並びに合わせて整える（覆っていない部分は名前なしのグループ）
+  listGroups.clear();
+  int covered = 0;
+  for (const ShortcutGroup& group : shortcutGroups) {
+    if (group.firstButton != covered || group.count < 0 || covered + group.count > (int)buttons.size()) break;
+    listGroups.push_back(group);
+    covered += group.count;
+  }
+  if (covered < (int)buttons.size()) {
+    listGroups.push_back({ "", covered, (int)buttons.size() - covered });
+  }
+  
+  groupTops.clear();
+  int top = 0;
+  for (const ShortcutGroup& group : listGroups) {
+    groupTops.push_back(top);
+    top += LIST_HEADER_HEIGHT + group.count * LIST_ROW_HEIGHT;
+  }
+  listHeight = top;
+  listScrollY = constrain(listScrollY, 0, max(listHeight - BUTTON_AREA_HEIGHT, 0));
+  listDrawnScrollY = -1;
+  visibleRows.clear();
+}
+
+void DisplayHandler::materializeListRows() {
+  std::vector<ListRow> rows;
+  size_t reuse = 0;
+  int viewTop = listScrollY;
+  int viewBottom = listScrollY + BUTTON_AREA_HEIGHT;
+  
+  // 表示先頭を含むグループから順に、画面の下端を越えるまで
+  int g = std::upper_bound(groupTops.begin(), groupTops.end(), viewTop) - groupTops.begin() - 1;
+  for (g = max(g, 0); g < (int)listGroups.size() && groupTops[g] < viewBottom; g++) {
+    int top = groupTops[g];
+    if (top + LIST_HEADER_HEIGHT > viewTop) {
+      appendListRow(rows, reuse, true, g, top, LIST_HEADER_HEIGHT);
+    }
     
-    buttons[i].x = startX + col * (buttonWidth + BUTTON_MARGIN);
-    buttons[i].y = startY + row * (buttonHeight + BUTTON_MARGIN);
-    buttons[i].width = buttonWidth;
-    buttons[i].height = buttonHeight;
-    buttons[i].isVisible = (page == pageInfo.currentPage);
-    buttons[i].id = i;
+    // グループ内の最初に見える行は位置から計算する
+    int itemsTop = top + LIST_HEADER_HEIGHT;
+    int first = max((viewTop - itemsTop) / LIST_ROW_HEIGHT, 0);
+    for (int i = first; i < listGroups[g].count; i++) {
+      int rowTop = itemsTop + i * LIST_ROW_HEIGHT;
+      if (rowTop >= viewBottom) break;
+      appendListRow(rows, reuse, false, listGroups[g].firstButton + i, rowTop, LIST_ROW_HEIGHT);
+    }
+  }
+  
+  visibleRows.swap(rows);
+}
+
+void DisplayHandler::appendListRow(std::vector<ListRow>& rows, size_t& reuse, bool header, int index, int top, int height) {
+  ListRow row;
+  row.top = top;
+  row.height = height;
+  row.header = header;
+  row.index = index;
+  row.keyX = 0;
+  
+  if (!header) {
+    // 前回も見えていた行は文字列と配置を使い回す（どちらも位置順に並んでいる）
+    while (reuse < visibleRows.size() && visibleRows[reuse].top < top) reuse++;
+    if (reuse < visibleRows.size() && visibleRows[reuse].top == top && !visibleRows[reuse].header) {
+      row.keyLabel = visibleRows[reuse].keyLabel;
+      row.keyX = visibleRows[reuse].keyX;
+    } else {
+      row.keyLabel = formatShortcutKeys(buttons[index]);
+      row.keyX = DISPLAY_WIDTH - LIST_PADDING - getTextWidth(row.keyLabel, FONT_SIZE_SMALL);
+    }
+  }
+  rows.push_back(row);
+}
+
+void DisplayHandler::scrollList(int delta) {
+  lockState();
+  int next = constrain(listScrollY + delta, 0, max(listHeight - BUTTON_AREA_HEIGHT, 0));
+  if (next == listScrollY) {
+    unlockState();
+    return;
+  }
+  listScrollY = next;
+  materializeListRows();
+  rebuildHitIndex();
+  markDirty(REGION_GRID | REGION_FOOTER);
+  unlockState();
+  sendCommand(RENDER_REFRESH);
+  
+  Serial.println("[Display] List scrolled to " + String(listScrollY) + "/" + String(listHeight));
+}
+
+void DisplayHandler::drawListViewport() {
+  RenderTimer timer(stats, STAGE_BUTTONS);
+  uint8_t* frame = (uint8_t*)gridFrameBuffer();
+  size_t stride = DISPLAY_WIDTH / 2;
+  int delta = listScrollY - listDrawnScrollY;
+  
+  // キャンバス上で描き直す帯
+  int bandTop = 0;
+  int bandBottom = BUTTON_AREA_HEIGHT;
+  if (listDrawnScrollY >= 0 && delta != 0 && abs(delta) < BUTTON_AREA_HEIGHT) {
+    // 前回の画像をスクロール量だけずらし、新しく見えた帯だけ描く
+    if (delta > 0) {
+      memmove(frame, frame + delta * stride, (BUTTON_AREA_HEIGHT - delta) * stride);
+      bandTop = BUTTON_AREA_HEIGHT - delta;
+    } else {
+      int shift = -delta;
+      memmove(frame + shift * stride, frame, (BUTTON_AREA_HEIGHT - shift) * stride);
+      bandBottom = shift;
+    }
+    // 帯に掛かる行は丸ごと描き直す（途中までしか描いていなかった行を含む）
+    for (const ListRow& row : visibleRows) {
+      int y0 = row.top - listScrollY;
+      int y1 = y0 + row.height;
+      if (y1 <= bandTop || y0 >= bandBottom) continue;
+      bandTop = min(bandTop, y0);
+      bandBottom = max(bandBottom, y1);
+    }
+    bandTop = max(bandTop, 0);
+    bandBottom = min(bandBottom, BUTTON_AREA_HEIGHT);
+  }
+  
+  strips[STRIP_GRID].canvas.fillRect(0, TAB_BAR_HEIGHT + bandTop, DISPLAY_WIDTH, bandBottom - bandTop, COLOR_WHITE);
+  for (const ListRow& row : visibleRows) {
+    int y0 = row.top - listScrollY;
+    if (y0 + row.height <= bandTop || y0 >= bandBottom) continue;
+    drawListRow(row);
+  }
+  listDrawnScrollY = listScrollY;
+}
+
+void DisplayHandler::drawListRow(const ListRow& row) {
+  M5EPD_Canvas& grid = strips[STRIP_GRID].canvas;
+  int y = TAB_BAR_HEIGHT + row.top - listScrollY;  // キャンバス上の位置（タブの下から）
+  
+  if (row.header) {
+    const String& name = listGroups[row.index].name;
+    grid.fillRect(0, y, DISPLAY_WIDTH, row.height, COLOR_GRAY_LIGHT);
+    drawText(grid, name.length() > 0 ? name : String("Shortcuts"), LIST_PADDING, y + 8, FONT_SIZE_MEDIUM);
+    return;
+  }
+  
+  // 押下中は白黒反転（グリッドのボタンと同じ）
+  const Button& button = buttons[row.index];
+  int bgColor = button.isPressed ? COLOR_BLACK : COLOR_WHITE;
+  int textColor = button.isPressed ? COLOR_WHITE : COLOR_BLACK;
+  grid.fillRect(0, y, DISPLAY_WIDTH, row.height, bgColor);
+  grid.fillRect(0, y + row.height - 1, DISPLAY_WIDTH, 1, COLOR_GRAY_DARK);
+  
+  drawText(grid, button.text, LIST_PADDING, y + 8, FONT_SIZE_MEDIUM, textColor);
+  drawText(grid, row.keyLabel, row.keyX, y + 10, FONT_SIZE_SMALL, textColor);
+  if (button.description.length() > 0) {
+    drawText(grid, button.description, LIST_PADDING, y + 34, FONT_SIZE_SMALL, textColor);
   }
 }
 
@@ -386,86 +1548,172 @@ String DisplayHandler::formatShortcutKeys(const Button& button) {
   return result;
 }
 
-void DisplayHandler::drawSettingsScreen() {
-  canvas.setTextSize(FONT_SIZE_LARGE);
-  drawCenteredText("Settings", 0, 50, DISPLAY_WIDTH, FONT_SIZE_LARGE);
-  
-  int y = 120;
-  canvas.setTextSize(FONT_SIZE_MEDIUM);
-  
-  // Layout setting
-  canvas.setCursor(50, y);
-  canvas.print("Layout: " + String(config.layoutColumns) + " columns");
-  y += 60;
+void DisplayHandler::describeScreen(WidgetTree& tree) {
+  switch (currentMode) {
+    case MODE_SETTINGS:
+      describeSettingsScreen(tree);
+      break;
+    case MODE_BATTERY_INFO:
+      describeBatteryInfoScreen(tree);
+      break;
+    case MODE_ABOUT:
+      describeAboutScreen(tree);
+      break;
+    case MODE_APPS:
+      describeAppsScreen(tree);
+      break;
+    default:
+      break;
+  }
+  tree.layout();
+}
+
+void DisplayHandler::describeSettingsScreen(WidgetTree& tree) {
+  tree.addLabel(-1, { 0, 50, DISPLAY_WIDTH, 40 }, "Settings", FONT_SIZE_LARGE, true);
   
-  // Update mode
+  int list = tree.addList({ 50, 120, DISPLAY_WIDTH - 100, 0 }, 60);
+  tree.addLabel(list, { 0, 0, 0, 0 }, "Layout: " + String(config.layoutColumns) + " columns", FONT_SIZE_MEDIUM);
   String updateModeText = (config.updateMode == UPDATE_MODE_FAST) ? "Fast" : "Quality";
-  canvas.setCursor(50, y);
-  canvas.print("Update Mode: " + updateModeText);
-  y += 60;
+  tree.addLabel(list, { 0, 0, 0, 0 }, "Update Mode: " + updateModeText, FONT_SIZE_MEDIUM);
+  tree.addLabel(list, { 0, 0, 0, 0 }, "Auto Sleep: " + String(config.autoSleepTime / 1000) + "s", FONT_SIZE_MEDIUM);
+  tree.addButton(list, { 0, 0, 0, 40 }, "Switch Keyboard Mode", HIT_KEYBOARD_MODE);
+  tree.addButton(list, { 0, 0, 0, 40 }, config.listView ? "View: List" : "View: Grid", HIT_VIEW_MODE);
   
-  // Auto sleep
-  canvas.setCursor(50, y);
-  canvas.print("Auto Sleep: " + String(config.autoSleepTime / 1000) + "s");
-  y += 60;
+  tree.addButton(-1, getBackButtonRect(), "Back", HIT_BACK);
+}
+
+void DisplayHandler::describeBatteryInfoScreen(WidgetTree& tree) {
+  tree.addLabel(-1, { 0, 50, DISPLAY_WIDTH, 40 }, "Battery Info", FONT_SIZE_LARGE, true);
   
-  // Keyboard mode button
-  drawRectButton(50, y, DISPLAY_WIDTH - 100, 40, "Switch Keyboard Mode", false);
-  y += 60;
+  int list = tree.addList({ 50, 150, DISPLAY_WIDTH - 100, 0 }, 60);
+  tree.addLabel(list, { 0, 0, 0, 0 }, "Battery: " + String(batteryInfo.percentage) + "%", FONT_SIZE_MEDIUM);
+  tree.addLabel(list, { 0, 0, 0, 0 }, "Voltage: " + String(batteryInfo.voltage, 2) + "V", FONT_SIZE_MEDIUM);
+  tree.addLabel(list, { 0, 0, 0, 0 }, "Status: " + String(batteryInfo.isCharging ? "Charging" : "Discharging"), FONT_SIZE_MEDIUM);
+  // 大きめのバッテリーアイコン（画面中央寄せ）
+  tree.addBatteryIcon(list, { DISPLAY_WIDTH / 2 - 100, 20, 33, 15 }, batteryInfo.percentage);
   
-  // Back button
-  drawRectButton(DISPLAY_WIDTH/2 - 50, DISPLAY_HEIGHT - 100, 100, 40, "Back", false);
+  tree.addButton(-1, getBackButtonRect(), "Back", HIT_BACK);
 }
 
-void DisplayHandler::drawBatteryInfoScreen() {
-  canvas.setTextSize(FONT_SIZE_LARGE);
-  drawCenteredText("Battery Info", 0, 50, DISPLAY_WIDTH, FONT_SIZE_LARGE);
+void DisplayHandler::describeAboutScreen(WidgetTree& tree) {
+  tree.addLabel(-1, { 0, 50, DISPLAY_WIDTH, 40 }, "About", FONT_SIZE_LARGE, true);
   
-  int y = 150;
-  canvas.setTextSize(FONT_SIZE_MEDIUM);
+  int list = tree.addList({ 0, 150, DISPLAY_WIDTH, 0 }, 50);
+  tree.addLabel(list, { 0, 0, 0, 0 }, "EasyShortcutKey", FONT_SIZE_MEDIUM, true);
+  tree.addLabel(list, { 0, 0, 0, 0 }, "M5PaperS3 Edition", FONT_SIZE_MEDIUM, true);
+  tree.addLabel(list, { 0, 0, 0, 0 }, "v1.0", FONT_SIZE_MEDIUM, true);
   
-  // Battery percentage
-  canvas.setCursor(50, y);
-  canvas.printf("Battery: %d%%", batteryInfo.percentage);
-  y += 60;
-  
-  // Voltage
-  canvas.setCursor(50, y);
-  canvas.printf("Voltage: %.2fV", batteryInfo.voltage);
-  y += 60;
+  tree.addButton(-1, getBackButtonRect(), "Back", HIT_BACK);
+}
+
+void DisplayHandler::describeAppsScreen(WidgetTree& tree) {
+  tree.addLabel(-1, { 0, 50, DISPLAY_WIDTH, 40 }, "Apps", FONT_SIZE_LARGE, true);
   
-  // Charging status
-  canvas.setCursor(50, y);
-  canvas.print("Status: " + String(batteryInfo.isCharging ? "Charging" : "Discharging"));
+  // 目次の名前だけで描く（ショートカットはアプリを選んでグループを開くまで読まない）
+  int list = tree.addList({ 40, 110, DISPLAY_WIDTH - 80, 0 }, APP_PICKER_PITCH);
+  int first = appPage * APP_PICKER_ROWS;
+  int last = min(first + APP_PICKER_ROWS, (int)catalog.size());
+  for (int i = first; i < last; i++) {
+    const CatalogApp& app = catalog[i];
+    String label = app.name + " (" + String(app.groups.size()) + ")";
+    tree.addButton(list, { 0, 0, 0, APP_PICKER_PITCH - 12 }, label, HIT_APP, i);
+  }
   
-  // Battery icon (large)
-  drawBatteryIcon(DISPLAY_WIDTH/2 - 50, y + 80, batteryInfo.percentage);
+  int pages = ((int)catalog.size() + APP_PICKER_ROWS - 1) / APP_PICKER_ROWS;
+  if (pages > 1) {
+    int y = DISPLAY_HEIGHT - 150;
+    if (appPage > 0) tree.addButton(-1, { 40, y, 100, 40 }, "Prev", HIT_PREV_PAGE, -1, ICON_PREV);
+    if (appPage < pages - 1) tree.addButton(-1, { DISPLAY_WIDTH - 140, y, 100, 40 }, "Next", HIT_NEXT_PAGE, -1, ICON_NEXT, true);
+    tree.addLabel(-1, { 0, y + 12, DISPLAY_WIDTH, 20 }, String(appPage + 1) + "/" + String(pages), FONT_SIZE_SMALL, true);
+  }
   
-  // Back button
-  drawRectButton(DISPLAY_WIDTH/2 - 50, DISPLAY_HEIGHT - 100, 100, 40, "Back", false);
+  tree.addButton(-1, getBackButtonRect(), "Settings", HIT_SETTINGS, -1, ICON_SETTINGS);
 }
 
-void DisplayHandler::drawAboutScreen() {
-  canvas.setTextSize(FONT_SIZE_LARGE);
-  drawCenteredText("About", 0, 50, DISPLAY_WIDTH, FONT_SIZE_LARGE);
+void DisplayHandler::refreshWidgets() {
+  // ロック中に呼ぶ。状態から画面を組み立て直し、前回との差分を描き直し対象にする
+  if (currentMode == MODE_SHORTCUTS) return;
   
-  int y = 150;
-  canvas.setTextSize(FONT_SIZE_MEDIUM);
-  
-  drawCenteredText("EasyShortcutKey", 0, y, DISPLAY_WIDTH, FONT_SIZE_MEDIUM);
-  y += 50;
-  drawCenteredText("M5PaperS3 Edition", 0, y, DISPLAY_WIDTH, FONT_SIZE_MEDIUM);
-  y += 50;
-  drawCenteredText("v1.0", 0, y, DISPLAY_WIDTH, FONT_SIZE_MEDIUM);
-  
-  // Back button
-  drawRectButton(DISPLAY_WIDTH/2 - 50, DISPLAY_HEIGHT - 100, 100, 40, "Back", false);
+  WidgetTree next;
+  describeScreen(next);
+  if (!screenWidgets.update(next)) {
+    markDirty(REGION_FULL);
+  } else if (!screenWidgets.getDamage().empty()) {
+    markDirty(REGION_WIDGETS);
+  }
+  rebuildHitIndex();
+}
+
+static bool rectsOverlap(const DisplayRect& a, const DisplayRect& b) {
+  return a.x < b.x + b.width && b.x < a.x + a.width &&
+         a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+void DisplayHandler::updateWidgets() {
+  RenderTimer timer(stats, STAGE_WIDGETS);
+  for (DisplayRect area : screenWidgets.getDamage()) {
+    // 掛かっているウィジェットが丸ごと入るまで広げる（消していない所に文字を重ね描きしない）
+    bool grown = true;
+    while (grown) {
+      grown = false;
+      for (int id = 0; id < screenWidgets.size(); id++) {
+        const Widget& widget = screenWidgets.get(id);
+        const DisplayRect& r = widget.rect;
+        if (widget.type == WIDGET_LIST || !rectsOverlap(r, area)) continue;
+        int x0 = min(area.x, r.x);
+        int y0 = min(area.y, r.y);
+        int x1 = max(area.x + area.width, r.x + r.width);
+        int y1 = max(area.y + area.height, r.y + r.height);
+        if (x0 != area.x || y0 != area.y || x1 != area.x + area.width || y1 != area.y + area.height) {
+          area = { x0, y0, x1 - x0, y1 - y0 };
+          grown = true;
+        }
+      }
+    }
+    
+    for (int i = 0; i < STRIP_COUNT; i++) {
+      if (area.y >= strips[i].y + strips[i].height || area.y + area.height <= strips[i].y) continue;
+      selectStrip(i);
+      fillRect(area.x, area.y, area.width, area.height, COLOR_WHITE);
+      for (int id = 0; id < screenWidgets.size(); id++) {
+        if (rectsOverlap(screenWidgets.get(id).rect, area)) drawWidget(screenWidgets.get(id));
+      }
+    }
+    pushRegion(area, REFRESH_TEXT);
+  }
+  screenWidgets.clearDamage();
+}
+
+void DisplayHandler::drawWidgets() {
+  for (int id = 0; id < screenWidgets.size(); id++) {
+    drawWidget(screenWidgets.get(id));
+  }
+}
+
+void DisplayHandler::drawWidget(const Widget& widget) {
+  const DisplayRect& r = widget.rect;
+  switch (widget.type) {
+    case WIDGET_LABEL:
+      if (widget.centered) {
+        drawCenteredText(widget.text, r.x, r.y, r.width, widget.fontSize);
+      } else {
+        drawText(widget.text, r.x, r.y, widget.fontSize);
+      }
+      break;
+    case WIDGET_BUTTON:
+      drawRectButton(r.x, r.y, r.width, r.height, widget.text, false, widget.icon, widget.iconAfterText);
+      break;
+    case WIDGET_BATTERY_ICON:
+      drawBatteryIcon(r.x, r.y, widget.value);
+      break;
+    case WIDGET_LIST:
+      break;
+  }
 }
 
 // スリープ画面描画
 void DisplayHandler::drawSleepScreen() {
-  canvas.fillCanvas(COLOR_WHITE);
-  canvas.setTextColor(COLOR_BLACK, COLOR_WHITE);
+  drawTarget->fillCanvas(COLOR_WHITE);
   
   int y = DISPLAY_HEIGHT / 2 - 50;
   
@@ -478,41 +1726,236 @@ void DisplayHandler::drawSleepScreen() {
 
 // シャットダウン画面描画
 void DisplayHandler::drawShutdownScreen() {
-  canvas.fillCanvas(COLOR_BLACK);
-  canvas.setTextColor(COLOR_WHITE, COLOR_BLACK);
+  drawTarget->fillCanvas(COLOR_BLACK);
   
   int y = DISPLAY_HEIGHT / 2 - 50;
   
-  drawCenteredText("Shutting Down...", 0, y, DISPLAY_WIDTH, FONT_SIZE_LARGE);
+  drawCenteredText("Shutting Down...", 0, y, DISPLAY_WIDTH, FONT_SIZE_LARGE, COLOR_WHITE);
   y += 60;
-  drawCenteredText("Please wait", 0, y, DISPLAY_WIDTH, FONT_SIZE_MEDIUM);
+  drawCenteredText("Please wait", 0, y, DISPLAY_WIDTH, FONT_SIZE_MEDIUM, COLOR_WHITE);
+}
+
+void DisplayHandler::drawText(const String& text, int x, int y, int fontSize, int color) {
+  drawText(*drawTarget, text, x, y - drawOriginY, fontSize, color);
 }
 
-void DisplayHandler::drawCenteredText(const String& text, int x, int y, int width, int fontSize) {
-  canvas.setTextSize(fontSize);
+void DisplayHandler::drawText(M5EPD_Canvas& target, const String& text, int x, int y, int fontSize, int color) {
+  fonts.draw(target, text, x, y, fontSize, color);
+}
+
+void DisplayHandler::drawCenteredText(const String& text, int x, int y, int width, int fontSize, int color) {
+  drawCenteredText(*drawTarget, text, x, y - drawOriginY, width, fontSize, color);
+}
+
+void DisplayHandler::drawCenteredText(M5EPD_Canvas& target, const String& text, int x, int y, int width, int fontSize, int color) {
   int textWidth = getTextWidth(text, fontSize);
   int centeredX = x + (width - textWidth) / 2;
-  canvas.setCursor(centeredX, y);
-  canvas.print(text);
+  drawText(target, text, centeredX, y, fontSize, color);
 }
 
-void DisplayHandler::drawRectButton(int x, int y, int width, int height, const String& text, bool pressed) {
+void DisplayHandler::drawRectButton(int x, int y, int width, int height, const String& text, bool pressed,
+                                    IconId icon, bool iconAfterText) {
   int bgColor = pressed ? COLOR_GRAY_DARK : COLOR_WHITE;
-  canvas.fillRect(x, y, width, height, bgColor);
-  canvas.drawRect(x, y, width, height, COLOR_BLACK);
+  fillRect(x, y, width, height, bgColor);
+  drawRect(x, y, width, height, COLOR_BLACK);
+  
+  if (icon == ICON_NONE) {
+    drawCenteredText(text, x, y + height/2 - 8, width, FONT_SIZE_SMALL);
+    return;
+  }
+  
+  // アイコンと文字をひとまとまりにして中央に置く
+  int iconWidth = IconAtlas::width(icon);
+  int textWidth = getTextWidth(text, FONT_SIZE_SMALL);
+  int left = x + (width - iconWidth - ICON_TEXT_GAP - textWidth) / 2;
+  int iconX = iconAfterText ? left + textWidth + ICON_TEXT_GAP : left;
+  int textX = iconAfterText ? left : left + iconWidth + ICON_TEXT_GAP;
+  drawIcon(icon, iconX, y + (height - IconAtlas::height(icon)) / 2);
+  drawText(text, textX, y + height/2 - 8, FONT_SIZE_SMALL);
+}
+
+void DisplayHandler::drawIcon(IconId icon, int x, int y) {
+  IconAtlas::draw(*drawTarget, icon, x, y - drawOriginY);
+}
+
+void DisplayHandler::fillRect(int x, int y, int width, int height, int color) {
+  drawTarget->fillRect(x, y - drawOriginY, width, height, color);
+}
+
+void DisplayHandler::drawRect(int x, int y, int width, int height, int color) {
+  drawTarget->drawRect(x, y - drawOriginY, width, height, color);
+}
+
+void DisplayHandler::pushRegion(const DisplayRect& rect, RefreshKind kind) {
+  // 転送は flushPushes() でまとめて行う（キャンバスは描画タスクしか書き換えない）
+  pendingPushes.push_back({rect, kind});
+  
+  // ヘッダー・フッターは背景が灰色なので、2値の波形で送ったら回数によらず次のアイドル時に掃除する
+  // （ボタン枠は白地に黒なので部分更新の回数に任せる。反転フラッシュは直後の復元の転送で数える）
+  m5epd_update_mode_t mode = selectUpdateMode(kind);
+  if ((mode == UPDATE_MODE_DU || mode == UPDATE_MODE_A2) && kind != REFRESH_PRESS) {
+    markGhostDue(rect);
+  }
+}
+
+void DisplayHandler::markGhostDue(const DisplayRect& rect) {
+  uint8_t due = (uint8_t)constrain(config.ghostCleanupThreshold, 1, 255);
+  for (int i = 0; i < GHOST_REGION_SLOT_BASE; i++) {
+    if (rectsOverlap(rect, getGhostRegionRect(i))) ghostCounts[i] = max(ghostCounts[i], due);
+  }
+}
+
+void DisplayHandler::flushPushes() {
+  for (const PendingPush& push : pendingPushes) {
+    transferRegion(push.rect, push.kind);
+  }
+  pendingPushes.clear();
+}
+
+void DisplayHandler::transferRegion(const DisplayRect& rect, RefreshKind kind) {
+  if (rect.x == 0 && rect.y == 0 && rect.width == DISPLAY_WIDTH && rect.height == DISPLAY_HEIGHT &&
+      kind != REFRESH_CLEANUP) {
+    pushAllStrips(selectUpdateMode(kind));
+    return;
+  }
+  
+  // IT8951 の4bpp部分転送は横方向4px単位なので外側へ揃える
+  int x0 = max(rect.x, 0) & ~3;
+  int y0 = max(rect.y, 0);
+  int x1 = min((rect.x + rect.width + 3) & ~3, DISPLAY_WIDTH);
+  int y1 = min(rect.y + rect.height, DISPLAY_HEIGHT);
+  if (x1 <= x0 || y1 <= y0) return;
   
-  canvas.setTextSize(FONT_SIZE_SMALL);
-  drawCenteredText(text, x, y + height/2 - 8, width, FONT_SIZE_SMALL);
+  if (kind == REFRESH_CLEANUP) {
+    // パネル側の画像はキャンバスと同じなので波形をかけ直すだけ
+    updateArea({x0, y0, x1 - x0, y1 - y0}, kind);
+    return;
+  }
+  
+  // 矩形が掛かっている領域ごとに変化した所だけ GRAM へ書き、波形は全体の外接矩形に1回だけかける
+  // （パネルの更新は1回ずつ順番に走るので、小さな更新を何回も並べるより速い。
+  //   外接矩形の中でも GRAM が変わっていない画素は見た目が変わらない）
+  int ux0 = DISPLAY_WIDTH, uy0 = DISPLAY_HEIGHT, ux1 = 0, uy1 = 0;
+  for (CanvasStrip& strip : strips) {
+    int sy0 = max(y0, strip.y);
+    int sy1 = min(y1, strip.y + strip.height);
+    if (sy1 <= sy0) continue;
+    DisplayRect written = transferStrip(strip, x0, sy0 - strip.y, x1 - x0, sy1 - sy0);
+    if (written.width <= 0 || written.height <= 0) continue;
+    ux0 = min(ux0, written.x);
+    uy0 = min(uy0, written.y);
+    ux1 = max(ux1, written.x + written.width);
+    uy1 = max(uy1, written.y + written.height);
+  }
+  if (ux1 > ux0 && uy1 > uy0) updateArea({ux0, uy0, ux1 - ux0, uy1 - uy0}, kind);
+}
+
+DisplayRect DisplayHandler::transferStrip(CanvasStrip& strip, int x, int y, int w, int h) {
+  // 座標は領域内（キャンバス上）の座標。GRAM に書いた範囲の外接矩形を画面座標で返す
+  if (!strip.frameDiff.isAvailable()) {
+    writeGram(strip, x, y, w, h);
+    return {x, strip.y + y, w, h};
+  }
+  
+  // 前回転送した画像と比べて、変化したタイルだけを転送する
+  // （バッテリー残量の数字が変わっただけなら、ヘッダーの中のその数字の周りだけ）
+  const uint8_t* frame = (const uint8_t*)strip.canvas.frameBuffer();
+  DiffRect changed[FRAME_DIFF_MAX_RECTS];
+  int count = strip.frameDiff.diff(frame, { x, y, w, h }, changed, FRAME_DIFF_MAX_RECTS);
+  int x0 = DISPLAY_WIDTH, y0 = strip.height, x1 = 0, y1 = 0;
+  for (int i = 0; i < count; i++) {
+    writeGram(strip, changed[i].x, changed[i].y, changed[i].width, changed[i].height);
+    strip.frameDiff.commit(frame, changed[i]);
+    x0 = min(x0, changed[i].x);
+    y0 = min(y0, changed[i].y);
+    x1 = max(x1, changed[i].x + changed[i].width);
+    y1 = max(y1, changed[i].y + changed[i].height);
+  }
+  if (count == 0) return {0, 0, 0, 0};
+  return {x0, strip.y + y0, x1 - x0, y1 - y0};
+}
+
+void DisplayHandler::pushAllStrips(m5epd_update_mode_t mode) {
+  // 全領域を GRAM に書いてから1回で更新する（領域ごとに波形を走らせない）
+  for (CanvasStrip& strip : strips) {
+    const uint8_t* frame = (const uint8_t*)strip.canvas.frameBuffer();
+    RenderTimer timer(stats, STAGE_GRAM);
+    M5.EPD.WritePartGram4bpp(0, strip.y, DISPLAY_WIDTH, strip.height, frame);
+    strip.frameDiff.commitAll(frame);
+  }
+  stats.recordRefresh(REFRESH_FULL, mode, RENDER_STATS_AREA_FULL, DISPLAY_WIDTH * DISPLAY_HEIGHT);
+  RenderTimer timer(stats, STAGE_EPD);
+  M5.EPD.UpdateFull(mode);
+}
+
+int DisplayHandler::statsAreaOf(int y0, int y1) {
+  // 1つの領域に収まっていればその領域、またがっていれば全画面として数える
+  for (int i = 0; i < STRIP_COUNT; i++) {
+    if (y0 >= strips[i].y && y1 <= strips[i].y + strips[i].height) return i;
+  }
+  return RENDER_STATS_AREA_FULL;
+}
+
+void DisplayHandler::writeGram(CanvasStrip& strip, int x, int y, int w, int h) {
+  RenderTimer timer(stats, STAGE_GRAM);
+  size_t stride = DISPLAY_WIDTH / 2;
+  const uint8_t* src = (const uint8_t*)strip.canvas.frameBuffer() + y * stride;
+  const uint8_t* data = src;
+  
+  // 全幅ならキャンバス上で行が連続しているのでそのまま渡し、それ以外だけ詰め直す
+  if (x != 0 || w != DISPLAY_WIDTH) {
+    size_t rowBytes = w / 2;
+    pushBuffer.resize(rowBytes * h);
+    for (int row = 0; row < h; row++) {
+      memcpy(&pushBuffer[row * rowBytes], src + row * stride + x / 2, rowBytes);
+    }
+    data = pushBuffer.data();
+  }
+  
+  M5.EPD.WritePartGram4bpp(x, strip.y + y, w, h, data);
+}
+
+void DisplayHandler::updateArea(const DisplayRect& rect, RefreshKind kind) {
+  // 座標は画面座標（x と幅は4px単位）
+  m5epd_update_mode_t mode = selectUpdateMode(kind);
+  stats.recordRefresh(kind, mode, statsAreaOf(rect.y, rect.y + rect.height), rect.width * rect.height);
+  RenderTimer timer(stats, STAGE_EPD);
+  M5.EPD.UpdateArea(rect.x, rect.y, rect.width, rect.height, mode);
+}
+
+m5epd_update_mode_t DisplayHandler::selectUpdateMode(RefreshKind kind) {
+  bool fast = (config.updateMode == UPDATE_MODE_FAST);
+  
+  // DU / A2 は白黒2値なので、灰色（ヘッダー・フッターの背景、文字の縁）を含む領域は
+  // 高品質モードでは GL16（フラッシュなしの16階調）で送る
+  switch (kind) {
+    case REFRESH_FULL:
+      return fast ? UPDATE_MODE_A2 : UPDATE_MODE_GC16;
+    case REFRESH_CONTENT:
+      return fast ? UPDATE_MODE_A2 : UPDATE_MODE_GL16;
+    case REFRESH_CLEANUP:
+      return UPDATE_MODE_GC16;
+    case REFRESH_PRESS:
+      // 反転フラッシュは白黒だけなので最速の A2
+      return UPDATE_MODE_A2;
+    case REFRESH_HIGHLIGHT:
+      // 押下表示は白黒の反転なので高品質モードでも DU（区切り線などの崩れはボタン枠ごとの回数で掃除する）
+      return UPDATE_MODE_DU;
+    case REFRESH_TEXT:
+    default:
+      // 灰色の背景を含むので高速モードだけ DU（崩れた階調は pushRegion で掃除の対象にしておく）
+      return fast ? UPDATE_MODE_DU : UPDATE_MODE_GL16;
+  }
 }
 
 int DisplayHandler::getTextWidth(const String& text, int fontSize) {
-  // 簡易的な文字幅計算（実際のフォントに応じて調整が必要）
-  return text.length() * (fontSize * 0.6);
+  // グリフごとの送り幅の合計（UTF-8 をコードポイント単位で数える）
+  return fonts.measure(text, fontSize);
 }
 
 int DisplayHandler::getButtonsPerPage() {
   int buttonHeight = (config.layoutColumns == 2) ? BUTTON_HEIGHT_2COL : BUTTON_HEIGHT_3COL;
-  int availableHeight = CONTENT_HEIGHT - BUTTON_MARGIN * 2;
+  int availableHeight = BUTTON_AREA_HEIGHT - BUTTON_MARGIN * 2;
   int rows = availableHeight / (buttonHeight + BUTTON_MARGIN);
   return config.layoutColumns * rows;
 }
\ No newline at end of file
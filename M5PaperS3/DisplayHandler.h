@@ -2,44 +2,206 @@
 #define DISPLAYHANDLER_H
 
 #include "Config.h"
+#include "PageCache.h"
+#include "FrameDiff.h"
+#include "FontRenderer.h"
+#include "IconAtlas.h"
+#include "WidgetTree.h"
+#include "RetainedState.h"
+#include "RenderStats.h"
 #include <M5EPD.h>
 #include <vector>
 
+// 部分更新の対象領域（ビットフラグ）
+enum DirtyRegion : uint32_t {
+  REGION_NONE    = 0,
+  REGION_HEADER  = 1 << 0,   // ヘッダー全体
+  REGION_STATUS  = 1 << 1,   // 接続状態テキスト
+  REGION_BATTERY = 1 << 2,   // バッテリーアイコンと残量
+  REGION_FOOTER  = 1 << 3,
+  REGION_GRID    = 1 << 4,   // 現在ページの全ボタン枠
+  REGION_WIDGETS = 1 << 5,   // 設定などの画面で内容の変わったウィジェット
+  REGION_FULL    = 1u << 31  // 画面全体を描き直す
+};
+
+// 更新内容の種類（EPDの波形選択に使う）
+enum RefreshKind {
+  REFRESH_FULL,       // 画面全体
+  REFRESH_CONTENT,    // ページ切り替えなどボタン内容の変更
+  REFRESH_TEXT,       // ステータス・バッテリー・フッターの小さな変更
+  REFRESH_HIGHLIGHT,  // ボタン押下のハイライト
+  REFRESH_PRESS,      // タップ直後の反転フラッシュ（A2）
+  REFRESH_CLEANUP     // 残像クリーンアップ（GC16、画素の再転送なし）
+};
+
+// 描画タスクへのコマンド
+enum RenderCommandType {
+  RENDER_REFRESH,         // 状態変更を反映（溜まった分はまとめて1回描く）
+  RENDER_FULL,            // 全画面を描き直す
+  RENDER_FLASH,           // ボタンの反転フラッシュ（arg = ボタン番号）
+  RENDER_CLEAR,           // パネルを白でクリア
+  RENDER_SLEEP_SCREEN,
+  RENDER_SHUTDOWN_SCREEN,
+  RENDER_SLEEP_CLEANUP,   // スリープ前の残像クリーンアップ
+  RENDER_ADOPT,           // パネルに残っている画像をそのまま使う（キャンバスだけ描き直す）
+  RENDER_STATS            // 計測結果をシリアルへ出す（arg = 1 なら出した後でリセット）
+};
+
+struct RenderCommand {
+  RenderCommandType type;
+  int arg;
+  TaskHandle_t waiter;    // 完了通知先（非同期なら nullptr）
+};
+
+// 画面を縦に分けた描画領域
+// それぞれ自分のキャンバスと差分用の直前フレームを持ち、画面上の y 位置へ個別に転送する
+enum StripId {
+  STRIP_HEADER,   // ヘッダー / ステータスバー
+  STRIP_GRID,     // ボタン領域
+  STRIP_FOOTER,
+  STRIP_COUNT
+};
+
+// 残像カウント対象の領域（ヘッダー・フッター・各ボタン枠）
+#define GHOST_REGION_HEADER 0
+#define GHOST_REGION_FOOTER 1
+#define GHOST_REGION_SLOT_BASE 2
+#define GHOST_REGION_COUNT (GHOST_REGION_SLOT_BASE + 32)
+
 class DisplayHandler {
 private:
-  M5EPD_Canvas canvas;
-  std::vector<Button> buttons;
+  struct CanvasStrip {
+    M5EPD_Canvas canvas;
+    FrameDiff frameDiff;     // パネルに載っている画像との差分（変わった画素だけ転送する）
+    int y;                   // 画面上の位置
+    int height;
+  };
+  CanvasStrip strips[STRIP_COUNT];
+  M5EPD_Canvas* drawTarget;  // 座標指定なしの描画関数の描き先（selectStrip で切り替える）
+  int drawOriginY;           // drawTarget の画面上の y 位置
+  M5EPD_Canvas pageCanvas;   // ページキャッシュ用のオフスクリーン描画先（ボタン領域サイズ）
+  PageCache pageCache;
+  FontRenderer fonts;        // UTF-8 の計測・描画（グリフキャッシュ付き）
+  WidgetTree screenWidgets;  // ショートカット以外の画面の内容（描画と当たり判定の両方に使う）
+  std::vector<Button> buttons;       // 開いているグループのボタン
   PageInfo pageInfo;
   SystemConfig config;
   BatteryInfo batteryInfo;
   DeviceStatus currentStatus;
   DisplayMode currentMode;
-  TouchInfo lastTouch;
   
   unsigned long lastUpdateTime;
-  bool needsUpdate;
   bool isInitialized;
+  
+  // 部分更新の管理
+  uint32_t dirtyRegions;     // DirtyRegion のビット
+  uint32_t dirtySlots;       // 内容が変わったボタン枠（ページ内インデックスのビット）
+  uint32_t highlightSlots;   // 押下状態だけが変わったボタン枠
+  std::vector<uint8_t> pushBuffer;  // 部分転送用の4bpp作業バッファ（全幅の転送では使わない）
+  
+  // 描画済みでパネル転送待ちの矩形（状態ロックを外してから転送する）
+  struct PendingPush {
+    DisplayRect rect;
+    RefreshKind kind;
+  };
+  std::vector<PendingPush> pendingPushes;
+  
+  // ボタン文字列の配置（ボタン左上からの相対座標）
+  // レイアウト変更時に一度だけ組み立て、再描画ではグリフを描くだけにする
+  struct ButtonTextLayout {
+    String keyLabel;       // "Ctrl + C" などキー表示の文字列
+    int16_t keyX, keyY;
+    int16_t descX, descY;  // descY < 0 なら説明なし
+  };
+  std::vector<ButtonTextLayout> textLayouts;  // buttons と同じ並び（Button::id で引く）
+  int textLayoutColumns;                      // textLayouts を作ったときの列数（0 = 作り直し）
+  
+  // リスト表示（config.listView）
+  // 行の位置はグループごとの先頭位置から計算し、文字列は画面に見えている行の分だけ作る
+  // （メモリと描画量はショートカットの総数ではなく画面の大きさで決まる）
+  struct ListRow {
+    int top;               // リスト先頭からの位置（px）
+    int16_t height;
+    bool header;           // グループ見出し
+    int index;             // 見出しなら listGroups、行なら buttons の番号
+    String keyLabel;       // 行: キー表示
+    int16_t keyX;          // 行: キー表示の x（右寄せ）
+  };
+  std::vector<ShortcutGroup> shortcutGroups;  // DataManager から受け取ったグループ
+  std::vector<ShortcutGroup> listGroups;      // buttons 全体を覆うように整えたグループ
+  std::vector<int> groupTops;                 // 各グループ見出しの位置
+  int listHeight;
+  int listScrollY;                            // 表示している先頭の位置
+  int listDrawnScrollY;                       // キャンバスに描いてある位置（-1 = 描き直し）
+  std::vector<ListRow> visibleRows;           // 見えている行（部分的に見えている行を含む）
+  
+  // アプリ選択とグループタブ（目次だけを持ち、ボタンは開いたグループの分だけ受け取る）
+  struct GroupTab {
+    DisplayRect rect;
+    int group;             // 開くグループ（-1 = アプリ選択へ戻る）
+    String label;
+  };
+  std::vector<CatalogApp> catalog;
+  int currentApp;                             // 開いているアプリとグループ（-1 = なし）
+  int currentGroup;
+  int appPage;                                // アプリ選択画面のページ
+  std::vector<GroupTab> groupTabs;
+  
+  // タッチのヒットテスト用インデックス
+  // 現在の画面で押せる領域を hitWidgets に並べ、画面を HIT_CELL_SIZE のセルに区切って
+  // セルごとに掛かっている領域の番号を持つ（タッチ1回 = セル参照 + 最大2つの矩形判定）
+  struct HitWidget {
+    DisplayRect rect;
+    HitTarget target;
+    int index;
+  };
+  std::vector<HitWidget> hitWidgets;
+  uint8_t hitCells[HIT_GRID_ROWS][HIT_GRID_COLS][HIT_CELL_CANDIDATES];  // 0xFF = なし
+  
+  // 描画タスク
+  // loop() 側（フロントエンド）は状態を書き換えてコマンドを積むだけで、
+  // キャンバスへの描画とパネル転送はすべて描画タスクが行う
+  TaskHandle_t renderTaskHandle;
+  QueueHandle_t renderQueue;
+  SemaphoreHandle_t stateMutex;  // ボタン・ページ・ダーティフラグなどの状態を保護
+  bool overlayActive;            // スリープ/シャットダウン画面の表示中は通常の描画を止める
+  bool panelRetained;            // ディープスリープ復帰直後、パネルの画像を使うか決まるまで描画を止める
+  
+  // 押下フィードバック（反転中のボタンと復元時刻）
+  int pressedIndex;
+  unsigned long pressRestoreTime;
+  
+  // 残像スケジューラ（前回の GC16 以降の部分更新回数）
+  uint8_t ghostCounts[GHOST_REGION_COUNT];
+  
+  // 描画の段階ごとの所要時間と、波形・領域ごとの更新回数（描画タスクだけが書き込む）
+  RenderStats stats;
 
 public:
   DisplayHandler();
-  void begin();
+  void begin(bool keepPanel = false);      // keepPanel: ディープスリープ前の画像を消さずに残す
   void setButtons(const std::vector<Button>& buttonList);
+  void setGroups(const std::vector<ShortcutGroup>& groupList);   // setButtons より先に呼ぶ
+  void setCatalog(const std::vector<CatalogApp>& apps);
+  void setLocation(int app, int group);    // 開いているアプリとグループ（タブの表示）
   void setStatus(DeviceStatus status);
   void setBatteryInfo(const BatteryInfo& battery);
   void setConfig(const SystemConfig& cfg);
   
   // 表示制御
   void showShortcuts();
+  void showApps();
   void showSettings();
   void showBatteryInfo();
   void showAbout();
   void showSleepScreen();
   void showShutdownScreen();
-  void update();
-  void forceUpdate();
+  void update();                           // 描画要求（非同期）
+  void forceUpdate();                      // 全画面描き直し（完了まで待つ）
+  void cleanupGhosting(bool beforeSleep);  // 部分更新が溜まった領域を GC16 で描き直す（スリープ前は完了まで待つ）
   void clear();
   
-  // ページ制御
+  // ページ制御（リスト表示ではスクロール、アプリ選択では一覧のページ）
   void nextPage();
   void prevPage();
   void setPage(int page);
@@ -47,38 +209,122 @@ public:
   int getTotalPages();
   
   // タッチ処理
-  TouchInfo getTouch();
+  HitResult hitTest(int x, int y);
   Button* getTouchedButton(int x, int y);
+  Button* getButton(int index);
   bool isInButton(int x, int y, const Button& button);
+  void setButtonPressed(Button* button, bool pressed);
+  void flashButton(Button* button);   // ボタン枠だけ即座に反転表示し、後で自動的に戻す
   
   // 表示モード
   void setDisplayMode(DisplayMode mode);
   DisplayMode getDisplayMode();
   
+  // ディープスリープをまたいだ画面の保持
+  void captureRetainedState(RetainedUiState& state);     // スリープ直前の画面の状態と見えているボタン
+  bool restoreRetainedState(const RetainedUiState& state);  // 同じ内容ならパネルの画像をそのまま使う
+  
+  // 計測
+  void printRenderStats(bool reset);       // 描画の計測結果をシリアルへ（reset なら表示後にゼロへ戻す）
+  
 private:
   void initCanvas();
+  void selectStrip(int strip);
+  void drawAcrossStrips(void (DisplayHandler::*draw)());
+  
+  // 描画タスク
+  static void renderTask(void* arg);
+  void sendCommand(RenderCommandType type, int arg = 0, bool wait = false);
+  void handleCommand(const RenderCommand& cmd);
+  void render();
+  TickType_t nextRenderWait();
+  void lockState();
+  void unlockState();
+  
+  // 部分更新
+  void markDirty(uint32_t regions);
+  void markSlotDirty(int slot, bool highlightOnly);
+  bool isDirty();
+  void redrawFull();
+  void drawScreen();
+  void adoptPanel();
+  uint32_t computeLayoutHash();
+  void updatePartial();
+  void drawSlot(int slot);
+  DisplayRect getSlotRect(int slot);
+  int getSlotCount();
+  int slotOfButton(int index);
+  void pushRegion(const DisplayRect& rect, RefreshKind kind);
+  void flushPushes();
+  void transferRegion(const DisplayRect& rect, RefreshKind kind);
+  DisplayRect transferStrip(CanvasStrip& strip, int x, int y, int w, int h);
+  void pushAllStrips(m5epd_update_mode_t mode);
+  int statsAreaOf(int y0, int y1);
+  void writeGram(CanvasStrip& strip, int x, int y, int w, int h);
+  void updateArea(const DisplayRect& rect, RefreshKind kind);
+  m5epd_update_mode_t selectUpdateMode(RefreshKind kind);
+  void onPageChanged();
+  void prefetchPages();
+  void renderPageToCache(int page);
+  uint8_t* gridFrameBuffer();
+  void restorePressedButton();
+  bool isFeedbackDue();
+  void flashSlot(int index);
+  void runGhostCleanup(bool beforeSleep);
+  void recordPartial(int region);
+  void markGhostDue(const DisplayRect& rect);  // 重なるヘッダー・フッターを次のアイドル時に掃除する
+  void resetGhostCounts();
+  DisplayRect getGhostRegionRect(int region);
   void drawHeader();
   void drawFooter();
+  void layoutGroupTabs();
+  void drawGroupTabs();
   void drawButtons();
   void drawButton(const Button& button, bool pressed = false);
+  void drawButton(M5EPD_Canvas& target, const Button& button, bool pressed, int offsetY);
   void drawBatteryIcon(int x, int y, int percentage);
   void drawWiFiIcon(int x, int y, bool connected);
   void drawStatusText(const String& text, int x, int y);
   
   void calculateButtonLayout();
+  void rebuildListIndex();
+  void materializeListRows();
+  void appendListRow(std::vector<ListRow>& rows, size_t& reuse, bool header, int index, int top, int height);
+  void scrollList(int delta);
+  void scrollApps(int delta);
+  void drawListViewport();
+  void drawListRow(const ListRow& row);
+  void buildTextLayouts();
+  void rebuildHitIndex();
+  void addHitWidget(const DisplayRect& rect, HitTarget target, int index = -1);
+  DisplayRect getBackButtonRect();
   void updatePageInfo();
   String formatShortcutKeys(const Button& button);
   
-  // 設定画面描画
-  void drawSettingsScreen();
-  void drawBatteryInfoScreen();
-  void drawAboutScreen();
+  // 設定・バッテリー・About・アプリ選択画面（状態からウィジェットツリーを組み立てる）
+  void describeScreen(WidgetTree& tree);
+  void describeSettingsScreen(WidgetTree& tree);
+  void describeBatteryInfoScreen(WidgetTree& tree);
+  void describeAboutScreen(WidgetTree& tree);
+  void describeAppsScreen(WidgetTree& tree);
+  void refreshWidgets();
+  void updateWidgets();
+  void drawWidgets();
+  void drawWidget(const Widget& widget);
+  
   void drawSleepScreen();
   void drawShutdownScreen();
   
-  // ユーティリティ
-  void drawCenteredText(const String& text, int x, int y, int width, int fontSize);
-  void drawRectButton(int x, int y, int width, int height, const String& text, bool pressed);
+  // ユーティリティ（座標は画面座標。drawTarget に描く）
+  void fillRect(int x, int y, int width, int height, int color);
+  void drawRect(int x, int y, int width, int height, int color);
+  void drawText(const String& text, int x, int y, int fontSize, int color = COLOR_BLACK);
+  void drawText(M5EPD_Canvas& target, const String& text, int x, int y, int fontSize, int color = COLOR_BLACK);
+  void drawCenteredText(const String& text, int x, int y, int width, int fontSize, int color = COLOR_BLACK);
+  void drawCenteredText(M5EPD_Canvas& target, const String& text, int x, int y, int width, int fontSize, int color = COLOR_BLACK);
+  void drawRectButton(int x, int y, int width, int height, const String& text, bool pressed,
+                      IconId icon = ICON_NONE, bool iconAfterText = false);
+  void drawIcon(IconId icon, int x, int y);
   int getTextWidth(const String& text, int fontSize);
   int getButtonsPerPage();
 };
@@ -0,0 +1,248 @@
+#include "FontRenderer.h"
+#include <SD.h>
+
+// 作業用キャンバスの大きさ。ペン位置の上下左右に余白を取り、はみ出すグリフも拾う
+#define GLYPH_CANVAS_SIZE (GLYPH_MAX_BOX * 2)
+#define GLYPH_PEN_OFFSET (GLYPH_MAX_BOX / 2)
+
+FontRenderer::FontRenderer() {
+  lock = nullptr;
+  fontLoaded = false;
+  fontTried = false;
+  renderSizeCount = 0;
+}
+
+void FontRenderer::begin() {
+  lock = xSemaphoreCreateMutex();
+  glyphCanvas.createCanvas(GLYPH_CANVAS_SIZE, GLYPH_CANVAS_SIZE);
+
+  // サブセットフォントがあれば起動時の TTF 読み込みは省く
+  // （一覧に無い文字が来たときに getGlyph() から読み込む）
+  if (SubsetFont::isAvailable()) {
+    Serial.println("[Font] Using subset font (" + String(SubsetFont::getGlyphCount()) + " glyphs in flash)");
+    return;
+  }
+  loadFont();
+}
+
+bool FontRenderer::loadFont() {
+  fontTried = true;
+
+  // TFカードに TTF があれば使う（SD は DataManager が初期化済み）
+  if (SD.exists(FONT_FILE) && glyphCanvas.loadFont(FONT_FILE, SD) == ESP_OK) {
+    fontLoaded = true;
+    int sizes[] = { FONT_SIZE_SMALL, FONT_SIZE_MEDIUM, FONT_SIZE_LARGE, FONT_SIZE_HEADER };
+    for (int size : sizes) {
+      ensureRender(size);
+    }
+    Serial.println("[Font] Loaded " + String(FONT_FILE));
+  } else {
+    Serial.println("[Font] " + String(FONT_FILE) + " not found, using built-in font");
+  }
+
+  // 1枠 = 最大辺 GLYPH_MAX_BOX の4bppグリフ1つ分
+  if (fontLoaded) {
+    cache.begin(GLYPH_CACHE_ENTRIES, (GLYPH_MAX_BOX * GLYPH_MAX_BOX + 1) / 2);
+  }
+  return fontLoaded;
+}
+
+bool FontRenderer::useGlyphs() {
+  // グリフ単位で計測・描画できるか（できなければキャンバスの print に任せる）
+  return SubsetFont::isAvailable() || cache.isAvailable();
+}
+
+bool FontRenderer::isFontLoaded() {
+  return fontLoaded;
+}
+
+void FontRenderer::ensureRender(int size) {
+  for (int i = 0; i < renderSizeCount; i++) {
+    if (renderSizes[i] == size) return;
+  }
+  if (renderSizeCount >= (int)(sizeof(renderSizes) / sizeof(renderSizes[0]))) return;
+  glyphCanvas.createRender(size, FONT_RENDER_CACHE);
+  renderSizes[renderSizeCount++] = size;
+}
+
+int FontRenderer::measure(const String& text, int size) {
+  if (text.length() == 0 || !lock) return 0;
+  xSemaphoreTake(lock, portMAX_DELAY);
+
+  int width = 0;
+  if (useGlyphs()) {
+    const char* p = text.c_str();
+    while (*p) {
+      const Glyph* glyph = getGlyph(decodeUtf8(p), size);
+      if (glyph) width += glyph->advance;
+    }
+  } else {
+    // キャッシュが無ければフォント側の計測に任せる（内蔵フォントでも実際の描画幅になる）
+    glyphCanvas.setTextSize(size);
+    width = glyphCanvas.textWidth(text);
+  }
+
+  xSemaphoreGive(lock);
+  return width;
+}
+
+void FontRenderer::draw(M5EPD_Canvas& target, const String& text, int x, int y, int size, int color) {
+  if (text.length() == 0) return;
+
+  if (!lock || !useGlyphs()) {
+    target.setTextSize(size);
+    target.setTextColor(color);
+    target.setCursor(x, y);
+    target.print(text);
+    return;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  int penX = x;
+  const char* p = text.c_str();
+  while (*p) {
+    const Glyph* glyph = getGlyph(decodeUtf8(p), size);
+    if (!glyph) continue;
+    blit(target, *glyph, penX, y, color);
+    penX += glyph->advance;
+  }
+  xSemaphoreGive(lock);
+}
+
+const Glyph* FontRenderer::getGlyph(uint32_t codepoint, int size) {
+  if (codepoint < 0x20) return nullptr;
+
+  if (SubsetFont::find(codepoint, size, subsetGlyph)) return &subsetGlyph;
+  if (!fontTried) loadFont();
+
+  Glyph* glyph = cache.find(codepoint, size);
+  if (glyph) return glyph;
+
+  uint8_t* pixels;
+  glyph = cache.insert(codepoint, size, &pixels);
+  if (!glyph) return nullptr;
+  rasterize(codepoint, size, glyph, pixels);
+  return glyph;
+}
+
+bool FontRenderer::rasterize(uint32_t codepoint, int size, Glyph* glyph, uint8_t* pixels) {
+  char utf8[5];
+  utf8[encodeUtf8(codepoint, utf8)] = '\0';
+
+  ensureRender(size);
+  glyphCanvas.setTextSize(size);
+  glyphCanvas.fillCanvas(0);
+  glyphCanvas.setTextColor(15, 0);
+  glyphCanvas.drawString(utf8, GLYPH_PEN_OFFSET, GLYPH_PEN_OFFSET);
+  glyph->advance = (uint8_t)min(glyphCanvas.textWidth(utf8), 255);
+
+  // インクのある範囲だけを切り出す
+  int minX = GLYPH_CANVAS_SIZE, minY = GLYPH_CANVAS_SIZE, maxX = -1, maxY = -1;
+  for (int py = 0; py < GLYPH_CANVAS_SIZE; py++) {
+    for (int px = 0; px < GLYPH_CANVAS_SIZE; px++) {
+      if (glyphCanvas.readPixel(px, py) == 0) continue;
+      minX = min(minX, px);
+      maxX = max(maxX, px);
+      minY = min(minY, py);
+      maxY = max(maxY, py);
+    }
+  }
+  if (maxX < 0) return true;  // 空白
+
+  int w = min(maxX - minX + 1, GLYPH_MAX_BOX);
+  int h = min(maxY - minY + 1, GLYPH_MAX_BOX);
+  glyph->offsetX = (int8_t)(minX - GLYPH_PEN_OFFSET);
+  glyph->offsetY = (int8_t)(minY - GLYPH_PEN_OFFSET);
+  glyph->width = w;
+  glyph->height = h;
+
+  memset(pixels, 0, (w * h + 1) / 2);
+  for (int py = 0; py < h; py++) {
+    for (int px = 0; px < w; px++) {
+      uint8_t coverage = glyphCanvas.readPixel(minX + px, minY + py) & 0x0F;
+      int i = py * w + px;
+      pixels[i >> 1] |= (i & 1) ? coverage : (coverage << 4);
+    }
+  }
+  return true;
+}
+
+void FontRenderer::blit(M5EPD_Canvas& target, const Glyph& glyph, int x, int y, int color) {
+  int ox = x + glyph.offsetX;
+  int oy = y + glyph.offsetY;
+  // 描き先（画面を分けたキャンバス）の外に出る行は丸ごと飛ばす
+  if (oy >= target.height() || oy + glyph.height <= 0) return;
+  for (int py = 0; py < glyph.height; py++) {
+    for (int px = 0; px < glyph.width; px++) {
+      int i = py * glyph.width + px;
+      int coverage = (i & 1) ? (glyph.pixels[i >> 1] & 0x0F) : (glyph.pixels[i >> 1] >> 4);
+      if (coverage == 0) continue;
+      if (coverage == 15) {
+        target.drawPixel(ox + px, oy + py, color);
+        continue;
+      }
+      // アンチエイリアスの縁は下地の色と混ぜる
+      int bg = target.readPixel(ox + px, oy + py);
+      target.drawPixel(ox + px, oy + py, bg + (color - bg) * coverage / 15);
+    }
+  }
+}
+
+uint32_t FontRenderer::getCacheHits() {
+  return cache.getHits();
+}
+
+uint32_t FontRenderer::getCacheMisses() {
+  return cache.getMisses();
+}
+
+uint32_t FontRenderer::decodeUtf8(const char*& p) {
+  uint8_t c = (uint8_t)*p++;
+  if (c < 0x80) return c;
+
+  int extra;
+  uint32_t codepoint;
+  if ((c & 0xE0) == 0xC0) {
+    extra = 1;
+    codepoint = c & 0x1F;
+  } else if ((c & 0xF0) == 0xE0) {
+    extra = 2;
+    codepoint = c & 0x0F;
+  } else if ((c & 0xF8) == 0xF0) {
+    extra = 3;
+    codepoint = c & 0x07;
+  } else {
+    return 0xFFFD;
+  }
+
+  for (int i = 0; i < extra; i++) {
+    uint8_t next = (uint8_t)*p;
+    if ((next & 0xC0) != 0x80) return 0xFFFD;  // 途中で切れている（終端の '\0' も含む）
+    codepoint = (codepoint << 6) | (next & 0x3F);
+    p++;
+  }
+  return codepoint;
+}
+
+int FontRenderer::encodeUtf8(uint32_t codepoint, char* out) {
+  if (codepoint < 0x80) {
+    out[0] = (char)codepoint;
+    return 1;
+  }
+  if (codepoint < 0x800) {
+    out[0] = (char)(0xC0 | (codepoint >> 6));
+    out[1] = (char)(0x80 | (codepoint & 0x3F));
+    return 2;
+  }
+  if (codepoint < 0x10000) {
+    out[0] = (char)(0xE0 | (codepoint >> 12));
+    out[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+    out[2] = (char)(0x80 | (codepoint & 0x3F));
+    return 3;
+  }
+  out[0] = (char)(0xF0 | (codepoint >> 18));
+  out[1] = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+  out[2] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+  out[3] = (char)(0x80 | (codepoint & 0x3F));
+  return 4;
+}
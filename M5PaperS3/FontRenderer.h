@@ -0,0 +1,46 @@
+#ifndef FONTRENDERER_H
+#define FONTRENDERER_H
+
+#include "Config.h"
+#include "GlyphCache.h"
+#include "SubsetFont.h"
+#include <M5EPD.h>
+
+// 文字列の計測と描画
+// UTF-8 をコードポイント単位で扱い、グリフごとの実際の送り幅で幅を求める。
+// グリフは フラッシュ常駐のサブセットフォント → TTF（GlyphCache 経由）の順に探す
+class FontRenderer {
+private:
+  M5EPD_Canvas glyphCanvas;   // 1文字ずつラスタライズする作業用キャンバス
+  GlyphCache cache;
+  SemaphoreHandle_t lock;     // 描画タスクとフロントエンド（レイアウト計算）の両方から呼ばれる
+  bool fontLoaded;            // TTF を読み込めたか（false なら内蔵フォント）
+  bool fontTried;             // TTF の読み込みを試したか（サブセットにない文字が来たときに1回だけ）
+  Glyph subsetGlyph;          // サブセットフォントから引いたグリフ（次の引き直しまで有効）
+  int renderSizes[8];         // createRender 済みのサイズ
+  int renderSizeCount;
+
+  const Glyph* getGlyph(uint32_t codepoint, int size);
+  bool loadFont();
+  bool useGlyphs();
+  bool rasterize(uint32_t codepoint, int size, Glyph* glyph, uint8_t* pixels);
+  void ensureRender(int size);
+  void blit(M5EPD_Canvas& target, const Glyph& glyph, int x, int y, int color);
+
+public:
+  FontRenderer();
+  void begin();
+  bool isFontLoaded();
+
+  int measure(const String& text, int size);
+  void draw(M5EPD_Canvas& target, const String& text, int x, int y, int size, int color);
+
+  uint32_t getCacheHits();
+  uint32_t getCacheMisses();
+
+  // UTF-8 を1文字読み進めてコードポイントを返す（不正なバイト列は U+FFFD）
+  static uint32_t decodeUtf8(const char*& p);
+  static int encodeUtf8(uint32_t codepoint, char* out);
+};
+
+#endif // FONTRENDERER_H
@@ -0,0 +1,396 @@
+#include "FrameDiff.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+#include <esp_heap_caps.h>
+#include <sdkconfig.h>
+#endif
+
+#if defined(CONFIG_IDF_TARGET_ESP32S3) && !defined(FRAME_DIFF_SCALAR_ONLY)
+#define FRAME_DIFF_USE_PIE 1
+#else
+#define FRAME_DIFF_USE_PIE 0
+#endif
+
+#define CHUNK_BYTES 16
+
+static uint8_t* allocShadow(size_t bytes) {
+#if defined(ESP_PLATFORM)
+  // PIE の整列ロードに合わせて16バイト境界で確保（PSRAM優先）
+  uint8_t* p = (uint8_t*)heap_caps_aligned_alloc(CHUNK_BYTES, bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!p) p = (uint8_t*)heap_caps_aligned_alloc(CHUNK_BYTES, bytes, MALLOC_CAP_8BIT);
+  return p;
+#else
+  void* p = nullptr;
+  return posix_memalign(&p, CHUNK_BYTES, bytes) == 0 ? (uint8_t*)p : nullptr;
+#endif
+}
+
+static void freeShadow(uint8_t* p) {
+#if defined(ESP_PLATFORM)
+  heap_caps_free(p);
+#else
+  free(p);
+#endif
+}
+
+// 1チャンク（最大16バイト）の比較。フレーム末尾の端数もこちらで扱う
+static bool chunkDiffersScalar(const uint8_t* prev, const uint8_t* next, size_t len) {
+  if (len < CHUNK_BYTES) return memcmp(prev, next, len) != 0;
+  uint32_t a[4], b[4];
+  memcpy(a, prev, CHUNK_BYTES);
+  memcpy(b, next, CHUNK_BYTES);
+  return ((a[0] ^ b[0]) | (a[1] ^ b[1]) | (a[2] ^ b[2]) | (a[3] ^ b[3])) != 0;
+}
+
+static void diffChunksScalar(const uint8_t* prev, const uint8_t* next, size_t first, size_t last, uint32_t* bits) {
+  for (size_t i = first; i < last; i++) {
+    if (chunkDiffersScalar(prev + i * CHUNK_BYTES, next + i * CHUNK_BYTES, CHUNK_BYTES)) {
+      bits[i >> 5] |= 1u << (i & 31);
+    }
+  }
+}
+
+#if FRAME_DIFF_USE_PIE
+// prev（直前フレーム）は16バイト境界なので整列ロード、
+// next（キャンバス）は境界が揃っていないので USAR ロード + SRC.Q で16バイトを組み立てる。
+// 組み立てに次の16バイトブロックを読むため、呼び出し側は末尾の2チャンクをスカラー版に回すこと
+static void diffChunksPIE(const uint8_t* prev, const uint8_t* next, size_t first, size_t last, uint32_t* bits) {
+  const uint8_t* p = prev + first * CHUNK_BYTES;
+  const uint8_t* n = next + first * CHUNK_BYTES;
+  for (size_t i = first; i < last; i++) {
+    uint32_t w0, w1, w2, w3;
+    asm volatile(
+      "ee.vld.128.ip     q0, %[p], 16\n"
+      "ee.ld.128.usar.ip q1, %[n], 16\n"
+      "ee.vld.128.ip     q2, %[n], 0\n"
+      "ee.src.q          q1, q1, q2\n"
+      "ee.xorq           q0, q0, q1\n"
+      "ee.movi.32.a      q0, %[w0], 0\n"
+      "ee.movi.32.a      q0, %[w1], 1\n"
+      "ee.movi.32.a      q0, %[w2], 2\n"
+      "ee.movi.32.a      q0, %[w3], 3\n"
+      : [w0] "=&r"(w0), [w1] "=&r"(w1), [w2] "=&r"(w2), [w3] "=&r"(w3), [p] "+r"(p), [n] "+r"(n)
+      :
+      : "memory");
+    if (w0 | w1 | w2 | w3) {
+      bits[i >> 5] |= 1u << (i & 31);
+    }
+  }
+}
+#endif
+
+FrameDiff::FrameDiff() {
+  shadow = nullptr;
+  chunkBits = nullptr;
+  tileRows = nullptr;
+  width = 0;
+  height = 0;
+  stride = 0;
+  frameBytes = 0;
+  chunkCount = 0;
+  tileCols = 0;
+  tileRowCount = 0;
+  comparedBytes = 0;
+  changedTiles = 0;
+}
+
+FrameDiff::~FrameDiff() {
+  if (shadow) freeShadow(shadow);
+  free(chunkBits);
+  free(tileRows);
+}
+
+bool FrameDiff::begin(int frameWidth, int frameHeight) {
+  width = frameWidth;
+  height = frameHeight;
+  stride = (size_t)(frameWidth + 1) / 2;
+  frameBytes = stride * frameHeight;
+  chunkCount = (frameBytes + CHUNK_BYTES - 1) / CHUNK_BYTES;
+  tileCols = (frameWidth + FRAME_DIFF_TILE_WIDTH - 1) / FRAME_DIFF_TILE_WIDTH;
+  tileRowCount = (frameHeight + FRAME_DIFF_TILE_HEIGHT - 1) / FRAME_DIFF_TILE_HEIGHT;
+
+  // タイル列は32ビットのマスクで持つ
+  if (tileCols > 32) return false;
+
+  shadow = allocShadow(chunkCount * CHUNK_BYTES);
+  chunkBits = (uint32_t*)calloc((chunkCount + 31) / 32, sizeof(uint32_t));
+  tileRows = (uint32_t*)calloc(tileRowCount, sizeof(uint32_t));
+  if (!shadow || !chunkBits || !tileRows) {
+    if (shadow) freeShadow(shadow);
+    free(chunkBits);
+    free(tileRows);
+    shadow = nullptr;
+    chunkBits = nullptr;
+    tileRows = nullptr;
+    return false;
+  }
+
+  // 最初の全画面転送までは何も載っていない扱い
+  memset(shadow, 0, chunkCount * CHUNK_BYTES);
+  return true;
+}
+
+bool FrameDiff::isAvailable() const {
+  return shadow != nullptr;
+}
+
+void FrameDiff::markChunk(const uint8_t* frame, size_t chunk) {
+  // 変化したチャンクだけバイト単位で見直し、実際に変わった範囲にだけ印を付ける
+  // （チャンクは行の境界に揃っていないので、そのままだと隣のタイルまで巻き込む）
+  size_t offset = chunk * CHUNK_BYTES;
+  size_t remaining = frameBytes - offset < CHUNK_BYTES ? frameBytes - offset : CHUNK_BYTES;
+
+  // チャンクは行をまたぐことがある（1行 = stride バイト）ので行ごとに分け、
+  // それぞれ変わったバイトの範囲に詰める（まとめて詰めると行末と次の行頭の間のタイルまで含む）
+  int row = (int)(offset / stride);
+  size_t col = offset % stride;
+
+  while (remaining > 0 && row < height) {
+    size_t take = stride - col < remaining ? stride - col : remaining;
+    size_t segLo = 0;
+    size_t segHi = take;
+    while (segLo < take && shadow[offset + segLo] == frame[offset + segLo]) segLo++;
+    while (segHi > segLo && shadow[offset + segHi - 1] == frame[offset + segHi - 1]) segHi--;
+    offset += take;
+    remaining -= take;
+    if (segLo == segHi) {
+      row++;
+      col = 0;
+      continue;
+    }
+    int px0 = (int)(col + segLo) * 2;
+    int px1 = (int)(col + segHi) * 2;
+    if (px1 > width) px1 = width;
+
+    int c0 = px0 / FRAME_DIFF_TILE_WIDTH;
+    int c1 = (px1 - 1) / FRAME_DIFF_TILE_WIDTH;
+    for (int c = c0; c <= c1; c++) {
+      tileRows[row / FRAME_DIFF_TILE_HEIGHT] |= 1u << c;
+    }
+
+    row++;
+    col = 0;
+  }
+}
+
+int FrameDiff::mergeTiles(int rowStart, int rowEnd, uint32_t colMask, DiffRect* out, int maxRects) {
+  // 行ごとに連続したタイルを横に繋ぎ、前の行と同じ幅なら縦に伸ばす
+  // （out はこの間タイル単位で使い、最後に px へ直す）
+  int count = 0;
+  for (int row = rowStart; row < rowEnd; row++) {
+    uint32_t bits = tileRows[row] & colMask;
+    int c = 0;
+    while (c < 32 && (bits >> c)) {
+      if (!((bits >> c) & 1)) {
+        c++;
+        continue;
+      }
+      int c0 = c;
+      while (c < 32 && ((bits >> c) & 1)) c++;
+      int span = c - c0;
+      changedTiles += span;
+
+      bool extended = false;
+      for (int i = 0; i < count; i++) {
+        if (out[i].x == c0 && out[i].width == span && out[i].y + out[i].height == row) {
+          out[i].height++;
+          extended = true;
+          break;
+        }
+      }
+      if (extended) continue;
+
+      if (count < maxRects) {
+        out[count++] = { c0, row, span, 1 };
+        continue;
+      }
+
+      // 上限に達したら、包含したときの面積の増え方が最小の矩形へ併合する
+      int best = 0;
+      long bestGrowth = -1;
+      for (int i = 0; i < count; i++) {
+        int ux0 = out[i].x < c0 ? out[i].x : c0;
+        int ux1 = out[i].x + out[i].width > c ? out[i].x + out[i].width : c;
+        int uy0 = out[i].y;
+        int uy1 = out[i].y + out[i].height > row + 1 ? out[i].y + out[i].height : row + 1;
+        long growth = (long)(ux1 - ux0) * (uy1 - uy0) - (long)out[i].width * out[i].height;
+        if (bestGrowth < 0 || growth < bestGrowth) {
+          bestGrowth = growth;
+          best = i;
+        }
+      }
+      int ux0 = out[best].x < c0 ? out[best].x : c0;
+      int ux1 = out[best].x + out[best].width > c ? out[best].x + out[best].width : c;
+      int uy1 = out[best].y + out[best].height > row + 1 ? out[best].y + out[best].height : row + 1;
+      out[best].x = ux0;
+      out[best].width = ux1 - ux0;
+      out[best].height = uy1 - out[best].y;
+    }
+  }
+
+  for (int i = 0; i < count; i++) {
+    out[i].x *= FRAME_DIFF_TILE_WIDTH;
+    out[i].width *= FRAME_DIFF_TILE_WIDTH;
+    out[i].y *= FRAME_DIFF_TILE_HEIGHT;
+    out[i].height *= FRAME_DIFF_TILE_HEIGHT;
+  }
+  return count;
+}
+
+int FrameDiff::diff(const uint8_t* frame, const DiffRect& clip, DiffRect* out, int maxRects) {
+  if (!shadow || maxRects <= 0) return 0;
+
+  int x0 = clip.x < 0 ? 0 : clip.x;
+  int y0 = clip.y < 0 ? 0 : clip.y;
+  int x1 = clip.x + clip.width > width ? width : clip.x + clip.width;
+  int y1 = clip.y + clip.height > height ? height : clip.y + clip.height;
+  if (x1 <= x0 || y1 <= y0) return 0;
+
+  // clip の先頭画素から末尾画素までを含むチャンクだけ比較する
+  size_t startByte = (size_t)y0 * stride + x0 / 2;
+  size_t endByte = (size_t)(y1 - 1) * stride + (x1 + 1) / 2;
+  size_t first = startByte / CHUNK_BYTES;
+  size_t last = (endByte + CHUNK_BYTES - 1) / CHUNK_BYTES;
+  comparedBytes += (uint32_t)((last - first) * CHUNK_BYTES);
+
+  memset(chunkBits + first / 32, 0, ((last + 31) / 32 - first / 32) * sizeof(uint32_t));
+
+  // 末尾の端数チャンクはスカラー版で比較する。PIE 版はキャンバス側の次の16バイトブロックも読むので、
+  // 16バイトちょうどのチャンクのうち最後の1つもスカラー版に回す（フレーム末尾を越えて読まない）
+  size_t wholeChunks = frameBytes / CHUNK_BYTES;
+#if FRAME_DIFF_USE_PIE
+  size_t bulkLimit = wholeChunks > 0 ? wholeChunks - 1 : 0;
+#else
+  size_t bulkLimit = wholeChunks;
+#endif
+  size_t bulkEnd = last < bulkLimit ? last : bulkLimit;
+  if (bulkEnd < first) bulkEnd = first;
+#if FRAME_DIFF_USE_PIE
+  if (first < bulkEnd) diffChunksPIE(shadow, frame, first, bulkEnd, chunkBits);
+#else
+  if (first < bulkEnd) diffChunksScalar(shadow, frame, first, bulkEnd, chunkBits);
+#endif
+  for (size_t i = bulkEnd; i < last; i++) {
+    size_t offset = i * CHUNK_BYTES;
+    size_t len = frameBytes - offset < CHUNK_BYTES ? frameBytes - offset : CHUNK_BYTES;
+    if (chunkDiffersScalar(shadow + offset, frame + offset, len)) {
+      chunkBits[i >> 5] |= 1u << (i & 31);
+    }
+  }
+
+  int rowStart = y0 / FRAME_DIFF_TILE_HEIGHT;
+  int rowEnd = (y1 + FRAME_DIFF_TILE_HEIGHT - 1) / FRAME_DIFF_TILE_HEIGHT;
+  memset(tileRows + rowStart, 0, (rowEnd - rowStart) * sizeof(uint32_t));
+
+  for (size_t word = first / 32; word < (last + 31) / 32; word++) {
+    uint32_t bits = chunkBits[word];
+    while (bits) {
+      int bit = __builtin_ctz(bits);
+      bits &= bits - 1;
+      size_t chunk = word * 32 + bit;
+      if (chunk >= first && chunk < last) markChunk(frame, chunk);
+    }
+  }
+
+  int c0 = x0 / FRAME_DIFF_TILE_WIDTH;
+  int c1 = (x1 - 1) / FRAME_DIFF_TILE_WIDTH;
+  uint32_t colMask = (c1 - c0 + 1 >= 32) ? 0xFFFFFFFFu : (((1u << (c1 - c0 + 1)) - 1) << c0);
+
+  int count = mergeTiles(rowStart, rowEnd, colMask, out, maxRects);
+
+  // タイルの矩形を clip に収める（clip が4px単位なら結果も4px単位）
+  int kept = 0;
+  for (int i = 0; i < count; i++) {
+    int rx0 = out[i].x > x0 ? out[i].x : x0;
+    int ry0 = out[i].y > y0 ? out[i].y : y0;
+    int rx1 = out[i].x + out[i].width < x1 ? out[i].x + out[i].width : x1;
+    int ry1 = out[i].y + out[i].height < y1 ? out[i].y + out[i].height : y1;
+    if (rx1 <= rx0 || ry1 <= ry0) continue;
+    out[kept++] = { rx0, ry0, rx1 - rx0, ry1 - ry0 };
+  }
+  return kept;
+}
+
+void FrameDiff::commit(const uint8_t* frame, const DiffRect& rect) {
+  if (!shadow) return;
+
+  int x0 = rect.x < 0 ? 0 : rect.x;
+  int y0 = rect.y < 0 ? 0 : rect.y;
+  int x1 = rect.x + rect.width > width ? width : rect.x + rect.width;
+  int y1 = rect.y + rect.height > height ? height : rect.y + rect.height;
+  if (x1 <= x0 || y1 <= y0) return;
+
+  size_t b0 = x0 / 2;
+  size_t b1 = (x1 + 1) / 2;
+  for (int row = y0; row < y1; row++) {
+    memcpy(shadow + row * stride + b0, frame + row * stride + b0, b1 - b0);
+  }
+}
+
+void FrameDiff::commitAll(const uint8_t* frame) {
+  if (!shadow) return;
+  memcpy(shadow, frame, frameBytes);
+}
+
+uint32_t FrameDiff::getComparedBytes() const {
+  return comparedBytes;
+}
+
+uint32_t FrameDiff::getChangedTiles() const {
+  return changedTiles;
+}
+
+bool FrameDiff::selfCheck() {
+  // 端数のある大きさ（1行50バイト、計1000バイト = 62.5チャンク）のフレームを
+  // 16通りのずれ（キャンバスの先頭が16バイト境界に無い場合）で比べ、
+  // 返った矩形が変えたタイルとちょうど一致するかを見る（ESP32-S3 では PIE 版の確認になる）
+  const int w = 100;
+  const int h = 40;
+  const size_t bytes = (size_t)(w / 2) * h;
+  uint8_t* buffer = (uint8_t*)malloc(bytes + CHUNK_BYTES);
+  if (!buffer) return false;
+
+  // 変える画素（タイルの角・フレームの最後の画素など、互いに別のタイル）
+  static const int points[][2] = { { 0, 0 }, { 63, 17 }, { 99, 39 } };
+  static const DiffRect expected[] = { { 0, 0, 32, 16 }, { 32, 16, 32, 16 }, { 96, 32, 4, 8 } };
+  const int pointCount = sizeof(points) / sizeof(points[0]);
+
+  bool ok = true;
+  for (int misalign = 0; ok && misalign < CHUNK_BYTES; misalign++) {
+    FrameDiff fd;
+    if (!fd.begin(w, h)) {
+      ok = false;
+      break;
+    }
+    uint8_t* frame = buffer + misalign;
+    uint32_t seed = 12345 + misalign;
+    for (size_t i = 0; i < bytes; i++) {
+      seed = seed * 1103515245u + 12345u;
+      frame[i] = (uint8_t)(seed >> 16);
+    }
+    fd.commitAll(frame);
+
+    DiffRect out[FRAME_DIFF_MAX_RECTS];
+    if (fd.diff(frame, { 0, 0, w, h }, out, FRAME_DIFF_MAX_RECTS) != 0) ok = false;
+
+    for (int i = 0; i < pointCount; i++) {
+      int x = points[i][0];
+      int y = points[i][1];
+      frame[y * (w / 2) + x / 2] ^= (x & 1) ? 0x0F : 0xF0;
+    }
+    int count = fd.diff(frame, { 0, 0, w, h }, out, FRAME_DIFF_MAX_RECTS);
+    if (count != pointCount) ok = false;
+    for (int i = 0; ok && i < count; i++) {
+      bool found = false;
+      for (int j = 0; j < pointCount; j++) {
+        const DiffRect& e = expected[j];
+        if (out[i].x == e.x && out[i].y == e.y && out[i].width == e.width && out[i].height == e.height) found = true;
+      }
+      if (!found) ok = false;
+    }
+  }
+  free(buffer);
+  return ok;
+}
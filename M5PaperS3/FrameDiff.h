@@ -0,0 +1,67 @@
+#ifndef FRAMEDIFF_H
+#define FRAMEDIFF_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Arduino に依存しないのでホストの g++ でもそのままビルドできる
+//   g++ -std=c++11 -O2 -c FrameDiff.cpp
+// ESP32-S3 では PIE（128bit SIMD）で比較し、それ以外はスカラー版を使う
+
+// タイルの大きさ（px）。横は16バイト（SIMD 1回分）= 32px
+#define FRAME_DIFF_TILE_WIDTH 32
+#define FRAME_DIFF_TILE_HEIGHT 16
+
+// 1回の差分で返す矩形の上限（超えたら面積の増え方が小さい矩形へ併合する）
+#define FRAME_DIFF_MAX_RECTS 8
+
+struct DiffRect {
+  int x;
+  int y;
+  int width;
+  int height;
+};
+
+// 直前にパネルへ転送した4bppフレームを保持し、新しいフレームとのタイル差分を
+// まとめた更新矩形を返す（変化のない画素は転送しない）
+class FrameDiff {
+private:
+  uint8_t* shadow;        // パネルに載っている画像（16バイト境界に確保）
+  uint32_t* chunkBits;    // 16バイト単位の変化フラグ
+  uint32_t* tileRows;     // タイル行ごとの変化フラグ（bit = タイル列）
+  int width;
+  int height;
+  size_t stride;
+  size_t frameBytes;
+  size_t chunkCount;
+  int tileCols;
+  int tileRowCount;
+
+  uint32_t comparedBytes;
+  uint32_t changedTiles;
+
+  void markChunk(const uint8_t* frame, size_t chunk);
+  int mergeTiles(int rowStart, int rowEnd, uint32_t colMask, DiffRect* out, int maxRects);
+
+public:
+  FrameDiff();
+  ~FrameDiff();
+  bool begin(int frameWidth, int frameHeight);
+  bool isAvailable() const;
+
+  // clip 内で前回転送分から変化した領域を out に書き込み、矩形の数を返す
+  // clip の x / width は4px単位に揃っていること
+  int diff(const uint8_t* frame, const DiffRect& clip, DiffRect* out, int maxRects);
+
+  // 転送した範囲を「パネルに載っている画像」として記録する
+  void commit(const uint8_t* frame, const DiffRect& rect);
+  void commitAll(const uint8_t* frame);
+
+  uint32_t getComparedBytes() const;
+  uint32_t getChangedTiles() const;
+
+  // 既知のフレームで差分を取り、期待した矩形が返るかを確かめる（起動時とホストのテストで使う）
+  static bool selfCheck();
+};
+
+#endif // FRAMEDIFF_H
@@ -0,0 +1,169 @@
+#include "GlyphCache.h"
+
+GlyphCache::GlyphCache() {
+  slots = nullptr;
+  buckets = nullptr;
+  pixelPool = nullptr;
+  capacity = 0;
+  bucketCount = 0;
+  slotBytes = 0;
+  head = -1;
+  tail = -1;
+  available = false;
+  hits = 0;
+  misses = 0;
+  evictions = 0;
+}
+
+bool GlyphCache::begin(int entries, size_t bytesPerGlyph) {
+  if (!psramFound()) {
+    Serial.println("[GlyphCache] PSRAM not found, glyph cache disabled");
+    return false;
+  }
+
+  capacity = entries;
+  bucketCount = entries * 2;
+  slotBytes = bytesPerGlyph;
+
+  slots = (Slot*)malloc(sizeof(Slot) * capacity);
+  buckets = (int16_t*)malloc(sizeof(int16_t) * bucketCount);
+  pixelPool = (uint8_t*)ps_malloc(slotBytes * capacity);
+  if (!slots || !buckets || !pixelPool) {
+    Serial.println("[GlyphCache] Allocation failed, glyph cache disabled");
+    free(slots);
+    free(buckets);
+    free(pixelPool);
+    slots = nullptr;
+    buckets = nullptr;
+    pixelPool = nullptr;
+    return false;
+  }
+
+  for (int i = 0; i < capacity; i++) {
+    slots[i].buffer = pixelPool + slotBytes * i;
+    slots[i].glyph.pixels = slots[i].buffer;
+  }
+  clear();
+
+  available = true;
+  Serial.println("[GlyphCache] " + String(capacity) + " glyphs x " + String(slotBytes) + " bytes in PSRAM");
+  return true;
+}
+
+bool GlyphCache::isAvailable() {
+  return available;
+}
+
+void GlyphCache::clear() {
+  // 全枠を未使用にし、番号順に LRU リストへ並べる（末尾から使われる）
+  for (int i = 0; i < bucketCount; i++) {
+    buckets[i] = -1;
+  }
+  for (int i = 0; i < capacity; i++) {
+    slots[i].used = false;
+    slots[i].chain = -1;
+    slots[i].prev = i - 1;
+    slots[i].next = (i + 1 < capacity) ? i + 1 : -1;
+  }
+  head = capacity > 0 ? 0 : -1;
+  tail = capacity - 1;
+}
+
+int GlyphCache::bucketOf(uint32_t codepoint, uint8_t size) {
+  uint32_t key = (codepoint << 6) ^ size;
+  key *= 2654435761u;
+  return (int)(key % (uint32_t)bucketCount);
+}
+
+void GlyphCache::unlink(int index) {
+  Slot& slot = slots[index];
+  if (slot.prev >= 0) slots[slot.prev].next = slot.next;
+  else head = slot.next;
+  if (slot.next >= 0) slots[slot.next].prev = slot.prev;
+  else tail = slot.prev;
+  slot.prev = -1;
+  slot.next = -1;
+}
+
+void GlyphCache::pushFront(int index) {
+  slots[index].prev = -1;
+  slots[index].next = head;
+  if (head >= 0) slots[head].prev = index;
+  head = index;
+  if (tail < 0) tail = index;
+}
+
+void GlyphCache::removeFromBucket(int index) {
+  int bucket = bucketOf(slots[index].glyph.codepoint, slots[index].glyph.size);
+  int16_t* link = &buckets[bucket];
+  while (*link >= 0) {
+    if (*link == index) {
+      *link = slots[index].chain;
+      break;
+    }
+    link = &slots[*link].chain;
+  }
+  slots[index].chain = -1;
+}
+
+Glyph* GlyphCache::find(uint32_t codepoint, uint8_t size) {
+  if (!available) return nullptr;
+
+  for (int16_t i = buckets[bucketOf(codepoint, size)]; i >= 0; i = slots[i].chain) {
+    if (slots[i].glyph.codepoint == codepoint && slots[i].glyph.size == size) {
+      if (head != i) {
+        unlink(i);
+        pushFront(i);
+      }
+      hits++;
+      return &slots[i].glyph;
+    }
+  }
+  misses++;
+  return nullptr;
+}
+
+Glyph* GlyphCache::insert(uint32_t codepoint, uint8_t size, uint8_t** pixels) {
+  if (!available || tail < 0) return nullptr;
+
+  // 最も長く使われていない枠（末尾）を使い回す
+  int index = tail;
+  if (slots[index].used) {
+    removeFromBucket(index);
+    evictions++;
+  }
+  unlink(index);
+  pushFront(index);
+
+  Slot& slot = slots[index];
+  slot.used = true;
+  slot.glyph.codepoint = codepoint;
+  slot.glyph.size = size;
+  slot.glyph.advance = 0;
+  slot.glyph.offsetX = 0;
+  slot.glyph.offsetY = 0;
+  slot.glyph.width = 0;
+  slot.glyph.height = 0;
+
+  int bucket = bucketOf(codepoint, size);
+  slot.chain = buckets[bucket];
+  buckets[bucket] = index;
+  *pixels = slot.buffer;
+  return &slot.glyph;
+}
+
+size_t GlyphCache::getSlotBytes() {
+  return slotBytes;
+}
+
+uint32_t GlyphCache::getHits() {
+  return hits;
+}
+
+uint32_t GlyphCache::getMisses() {
+  return misses;
+}
+
+uint32_t GlyphCache::getEvictions() {
+  return evictions;
+}
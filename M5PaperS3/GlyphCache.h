@@ -0,0 +1,66 @@
+#ifndef GLYPHCACHE_H
+#define GLYPHCACHE_H
+
+#include "Config.h"
+
+// ラスタライズ済みのグリフ
+// 位置はペン位置（setCursor の座標）からのインク矩形のずれ
+struct Glyph {
+  uint32_t codepoint;
+  uint8_t size;
+  uint8_t advance;     // 次の文字までの送り幅
+  int8_t offsetX;
+  int8_t offsetY;
+  uint8_t width;       // インク矩形（空白なら 0）
+  uint8_t height;
+  const uint8_t* pixels;  // 4bpp のカバレッジ（0〜15、1バイトに2px、行の端数は詰める）
+};
+
+// (コードポイント, サイズ) をキーにした LRU キャッシュ
+// 管理情報は内部RAM、グリフの画素は PSRAM に固定長の枠で置く
+class GlyphCache {
+private:
+  struct Slot {
+    Glyph glyph;
+    uint8_t* buffer;     // glyph.pixels の書き込み先（PSRAM）
+    int16_t prev;        // LRU リスト（先頭が最近使ったもの）
+    int16_t next;
+    int16_t chain;       // 同じハッシュ値の次の枠
+    bool used;
+  };
+
+  Slot* slots;
+  int16_t* buckets;
+  uint8_t* pixelPool;
+  int capacity;
+  int bucketCount;
+  size_t slotBytes;
+  int16_t head;
+  int16_t tail;
+  bool available;
+
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t evictions;
+
+  int bucketOf(uint32_t codepoint, uint8_t size);
+  void unlink(int index);
+  void pushFront(int index);
+  void removeFromBucket(int index);
+
+public:
+  GlyphCache();
+  bool begin(int entries, size_t bytesPerGlyph);
+  bool isAvailable();
+
+  Glyph* find(uint32_t codepoint, uint8_t size);     // ヒットしたら LRU の先頭へ
+  Glyph* insert(uint32_t codepoint, uint8_t size, uint8_t** pixels);   // 最も古い枠を追い出して返す（画素は *pixels に書く）
+  void clear();
+
+  size_t getSlotBytes();
+  uint32_t getHits();
+  uint32_t getMisses();
+  uint32_t getEvictions();
+};
+
+#endif // GLYPHCACHE_H
@@ -0,0 +1,53 @@
+#include "IconAtlas.h"
+#include "IconAtlasData.h"
+
+int IconAtlas::width(IconId id) {
+  if (id < 0 || id >= ICON_COUNT) return 0;
+  return ICON_ATLAS[id].width;
+}
+
+int IconAtlas::height(IconId id) {
+  if (id < 0 || id >= ICON_COUNT) return 0;
+  return ICON_ATLAS[id].height;
+}
+
+void IconAtlas::draw(M5EPD_Canvas& target, IconId id, int x, int y) {
+  if (id < 0 || id >= ICON_COUNT) return;
+  const IconInfo& icon = ICON_ATLAS[id];
+  uint8_t* frame = (uint8_t*)target.frameBuffer();
+  if (!frame) return;
+
+  // 描き先（画面を分けたキャンバス）に入る範囲だけを写す
+  int x0 = max(0, -x);
+  int x1 = min((int)icon.width, target.width() - x);
+  int y0 = max(0, -y);
+  int y1 = min((int)icon.height, target.height() - y);
+  if (x0 >= x1 || y0 >= y1) return;
+
+  int stride = target.width() / 2;
+  int rowBytes = icon.width / 2;
+  const uint8_t* pixels = ICON_ATLAS_PIXELS + icon.offset;
+
+  if (icon.maskOffset < 0 && !(x & 1) && x0 == 0 && x1 == icon.width) {
+    // 不透明でバイト境界に揃っていれば行ごとにそのまま写す
+    for (int py = y0; py < y1; py++) {
+      memcpy(frame + (y + py) * stride + x / 2, pixels + py * rowBytes, rowBytes);
+    }
+    return;
+  }
+
+  const uint8_t* mask = icon.maskOffset >= 0 ? ICON_ATLAS_MASKS + icon.maskOffset : nullptr;
+  int maskBytes = (icon.width + 7) / 8;
+  for (int py = y0; py < y1; py++) {
+    const uint8_t* src = pixels + py * rowBytes;
+    const uint8_t* maskRow = mask ? mask + py * maskBytes : nullptr;
+    uint8_t* dst = frame + (y + py) * stride;
+    for (int px = x0; px < x1; px++) {
+      if (maskRow && !(maskRow[px >> 3] & (0x80 >> (px & 7)))) continue;
+      uint8_t value = (px & 1) ? (src[px >> 1] & 0x0F) : (src[px >> 1] >> 4);
+      int dx = x + px;
+      uint8_t& byte = dst[dx >> 1];
+      byte = (dx & 1) ? ((byte & 0xF0) | value) : ((byte & 0x0F) | (value << 4));
+    }
+  }
+}
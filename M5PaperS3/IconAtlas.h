@@ -0,0 +1,29 @@
+#ifndef ICONATLAS_H
+#define ICONATLAS_H
+
+#include "IconIds.h"
+#include <M5EPD.h>
+
+// フラッシュ常駐のアイコン（状態・バッテリー・接続・ページ送り）
+// 元の絵は M5PaperS3/icons/*.txt、データ（IconIds.h / IconAtlasData.h）は scripts/icon_atlas.py で生成する
+//
+// 画素はキャンバスと同じ 4bpp の並び（行はバイト単位に揃える）なので、
+// 透明な画素の無いアイコンを偶数の x に置くときは行ごとの memcpy で済む
+
+struct IconInfo {
+  uint8_t width;        // 偶数
+  uint8_t height;
+  uint16_t offset;      // ICON_ATLAS_PIXELS 内の位置（バイト）
+  int16_t maskOffset;   // ICON_ATLAS_MASKS 内の位置（1bit/px、-1 = 透明な画素なし）
+};
+
+class IconAtlas {
+public:
+  static int width(IconId id);
+  static int height(IconId id);
+
+  // 左上を (x, y) にしてキャンバスへ写す（キャンバスの外に出る分は切る）
+  static void draw(M5EPD_Canvas& target, IconId id, int x, int y);
+};
+
+#endif // ICONATLAS_H
@@ -0,0 +1,23 @@
+// Generated by scripts/icon_atlas.py from M5PaperS3/icons - do not edit
+#ifndef ICONIDS_H
+#define ICONIDS_H
+
+#include <stdint.h>
+
+enum IconId : int8_t {
+  ICON_NONE = -1,
+  ICON_BATTERY,
+  ICON_BATTERY_LOW,
+  ICON_DOWN,
+  ICON_ERROR,
+  ICON_HOURGLASS,
+  ICON_KEYBOARD,
+  ICON_NEXT,
+  ICON_PREV,
+  ICON_SETTINGS,
+  ICON_UP,
+  ICON_USB,
+  ICON_COUNT
+};
+
+#endif // ICONIDS_H
@@ -71,6 +71,8 @@ const KeyboardHandler::KeyMapping KeyboardHandler::keyMappings[] = {
 
 const int KeyboardHandler::keyMappingsCount = sizeof(keyMappings) / sizeof(KeyMapping);
 
+volatile bool KeyboardHandler::usbMounted = false;
+
 KeyboardHandler::KeyboardHandler() {
   currentMode = MODE_USB_HID;
   isInitialized = false;
@@ -228,6 +230,13 @@ bool KeyboardHandler::isBluetoothConnected() {
   return bluetoothAvailable && bleKeyboard.isConnected();
 }
 
+bool KeyboardHandler::isHostReady() {
+  if (currentMode == MODE_USB_HID) {
+    return usbAvailable && usbMounted;
+  }
+  return isBluetoothConnected();
+}
+
 String KeyboardHandler::getConnectionStatus() {
   if (currentMode == MODE_USB_HID) {
     return isUSBConnected() ? "USB Connected" : "USB Disconnected";
@@ -361,10 +370,29 @@ void KeyboardHandler::sendShortcutBluetooth(ShortcutCommand command) {
 void KeyboardHandler::initializeUSB() {
   Serial.println("[Keyboard] Initializing USB HID...");
   usbKeyboard.begin();
+  USB.onEvent(onUSBEvent);
   USB.begin();
   usbAvailable = true;
 }
 
+void KeyboardHandler::onUSBEvent(void* arg, esp_event_base_t base, int32_t id, void* data) {
+  if (base != ARDUINO_USB_EVENTS) return;
+  
+  // 列挙が終わる（STARTED）までに送ったキーはホストに届かない
+  switch (id) {
+    case ARDUINO_USB_STARTED_EVENT:
+    case ARDUINO_USB_RESUME_EVENT:
+      usbMounted = true;
+      break;
+    case ARDUINO_USB_STOPPED_EVENT:
+    case ARDUINO_USB_SUSPEND_EVENT:
+      usbMounted = false;
+      break;
+    default:
+      break;
+  }
+}
+
 void KeyboardHandler::initializeBluetooth() {
   Serial.println("[Keyboard] Initializing Bluetooth HID...");
   bleKeyboard.begin();
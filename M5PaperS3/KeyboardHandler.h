@@ -14,6 +14,7 @@ private:
   bool isInitialized;
   bool usbAvailable;
   bool bluetoothAvailable;
+  static volatile bool usbMounted;  // ホストが USB デバイスとして認識済み（列挙完了）
   
   // キー名前からUSB HIDコードへのマッピング
   struct KeyMapping {
@@ -40,6 +41,7 @@ public:
   bool isConnected();
   bool isUSBConnected();
   bool isBluetoothConnected();
+  bool isHostReady();   // ホストがキー入力を受け付けられる（USB は列挙完了、Bluetooth は接続済み）
   String getConnectionStatus();
   
 private:
@@ -53,6 +55,7 @@ private:
   void sendShortcutUSB(ShortcutCommand command);
   void sendShortcutBluetooth(ShortcutCommand command);
   void initializeUSB();
+  static void onUSBEvent(void* arg, esp_event_base_t base, int32_t id, void* data);
   void initializeBluetooth();
   void shutdownBluetooth();
 };
@@ -14,12 +14,16 @@
 #include "PowerManager.h"
 #include "DataManager.h"
 #include "KeyboardHandler.h"
+#include "TouchHandler.h"
+#include "RetainedState.h"
+#include <esp_sleep.h>
 
 // グローバルオブジェクト
 DisplayHandler display;
 PowerManager powerManager;
 DataManager dataManager;
 KeyboardHandler keyboardHandler;
+TouchHandler touchHandler;
 
 // システム状態
 DeviceStatus currentStatus = STATUS_STARTING;
@@ -30,14 +34,27 @@ bool systemInitialized = false;
 KeyboardMode keyboardMode = MODE_USB_HID;
 bool powerButtonPressed = false;
 
+// 眠っている画面をタップして起こしたときのショートカット（ホストがキーボードを認識したら送る）
+bool wakeShortcutPending = false;
+ShortcutCommand wakeShortcut;
+int wakeButtonIndex = -1;        // 押下表示するボタン（眠る前の画面を使えなかったら -1）
+unsigned long wakeShortcutDeadline = 0;
+
 // 関数プロトタイプ
 void onBatteryUpdate(BatteryInfo battery);
 void onLowBattery();
 void onSleep();
 void onWakeup();
-void handleTouchEvent();
+void handleTouchEvent(const TouchInfo& touch);
 void handleButtonPress(Button* button);
+bool loadShortcutGroup(int app, int group);
+void openShortcutGroup(int app, int group);
+bool restoreRetainedScreen(const RetainedUiState& retained);
+void captureWakeTap(const RetainedUiState& retained);
+void sendWakeShortcut();
+void closeShortcutGroup();
 void updateSystemStatus();
+void handleSerialCommand();
 void printSystemInfo();
 void enterSleepMode();
 void handlePowerButton();
@@ -45,26 +62,47 @@ void handleKeyboardModeSwitch();
 void displayKeyboardModeStatus();
 
 void setup() {
-  // シリアル通信初期化
+  // ディープスリープからの復帰なら、眠る前の画面がパネルに残っている
+  // RTC メモリの状態と同じ画面を組み立てられれば、消去と全画面の描き直しを省く
+  static RetainedUiState retained;
+  bool fastWake = esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_UNDEFINED &&
+                  RetainedState::take(retained);
+  
+  // シリアル通信初期化（復帰時はシリアルモニタの接続を待たない）
   Serial.begin(SERIAL_BAUD_RATE);
-  delay(2000);
+  if (!fastWake) delay(2000);
   
   Serial.println("=========================================");
   Serial.println("EasyShortcutKey M5PaperS3 Edition v1.0");
   Serial.println("=========================================");
   
-  // データマネージャ初期化（最初に実行）
+  // ディスプレイ初期化（M5.begin()。タッチパネルもここで使えるようになる）
+  Serial.println("[System] Initializing Display...");
+  display.begin(fastWake);
+  
+  // タッチで起きたなら、起こしたタップを眠る前の画面のボタンの押下として扱う
+  // 座標はコントローラから消えないうちに、データを読むより先に取る
+  if (fastWake && esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_EXT0) {
+    captureWakeTap(retained);
+  }
+  
+  // キーボードハンドラ初期化（USB の列挙を、この後のデータ読み込みと並行して進める）
+  Serial.println("[System] Initializing Keyboard Handler...");
+  keyboardHandler.begin();
+  keyboardHandler.setMode(keyboardMode);  // 初期モードはUSB HID
+  
+  // データマネージャ初期化
   Serial.println("[System] Initializing Data Manager...");
   dataManager.begin();
   systemConfig = dataManager.getConfig();
-  
-  // ディスプレイ初期化
-  Serial.println("[System] Initializing Display...");
-  display.begin();
   display.setConfig(systemConfig);
   display.setStatus(STATUS_STARTING);
   display.update();
   
+  // タッチ初期化（M5.begin() の後に割り込みを付け替える）
+  Serial.println("[System] Initializing Touch Handler...");
+  touchHandler.begin();
+  
   // 電力管理初期化
   Serial.println("[System] Initializing Power Manager...");
   powerManager.begin(&systemConfig);
@@ -76,21 +114,30 @@ void setup() {
   // 電源ボタン設定
   pinMode(POWER_BUTTON_PIN, INPUT_PULLUP);
   
-  // キーボードハンドラ初期化
-  Serial.println("[System] Initializing Keyboard Handler...");
-  keyboardHandler.begin();
-  keyboardHandler.setMode(keyboardMode);  // 初期モードはUSB HID
-  
-  // ショートカットデータをディスプレイに設定
-  std::vector<Button> shortcuts = dataManager.getShortcuts();
-  display.setButtons(shortcuts);
+  // ショートカット集の目次をディスプレイに設定（ボタンはグループを開いたときに作る）
+  display.setCatalog(dataManager.getCatalog());
+  
+  // 復帰時は眠る前の画面に戻す。できなければアプリが1つならその最初のグループを、
+  // 複数あればアプリ選択から始める
+  bool keptPanel = fastWake;
+  if (fastWake) fastWake = restoreRetainedScreen(retained);
+  if (!fastWake) {
+    wakeButtonIndex = -1;
+    // 残しておいた画像が使えなければ、通常の起動と同じく消去してから描く
+    if (keptPanel) display.clear();
+    if (dataManager.getCatalog().size() == 1) {
+      openShortcutGroup(0, 0);
+    } else {
+      closeShortcutGroup();
+    }
+  }
   
-  // 初期化完了
+  // 初期化完了（復帰時はステータスとバッテリー表示の変わった部分だけが更新される）
   currentStatus = STATUS_READY;
   display.setStatus(currentStatus);
   display.setBatteryInfo(powerManager.getBatteryInfo());
-  display.showShortcuts();
-  display.forceUpdate();
+  if (!fastWake) display.forceUpdate();
+  if (wakeShortcutPending) sendWakeShortcut();
   
   systemInitialized = true;
   lastUpdateTime = millis();
@@ -112,18 +159,26 @@ void loop() {
   // 電源ボタンチェック
   handlePowerButton();
   
+  // 起こしたタップのショートカット（USB の列挙が終わりしだい送る）
+  if (wakeShortcutPending) sendWakeShortcut();
+  
   // タッチイベント処理
-  handleTouchEvent();
+  // 座標の読み取りとジェスチャー認識はタッチタスクが行い、ここでは結果を待つだけ
+  // （触っていない間は待ちで眠り、電源ボタンと状態チェックのために定期的に起きる）
+  TouchInfo touch;
+  if (touchHandler.getEvent(touch, pdMS_TO_TICKS(TOUCH_LOOP_WAIT_MS))) {
+    handleTouchEvent(touch);
+  }
+  
+  // シリアルからの診断コマンド
+  handleSerialCommand();
   
-  // ディスプレイ更新（500ms間隔）
+  // 状態の定期チェック（500ms間隔）
+  // 画面の描画・転送は描画タスク（Core 0）が行うので、ここではブロックしない
   if (currentTime - lastUpdateTime >= 500) {
-    display.update();
     updateSystemStatus();
     lastUpdateTime = currentTime;
   }
-  
-  // 短い遅延
-  delay(10);
 }
 
 // バッテリー情報更新
@@ -156,7 +211,14 @@ void onSleep() {
   
   currentStatus = STATUS_SLEEPING;
   display.setStatus(currentStatus);
-  display.forceUpdate();
+  // ステータスを反映してから、部分更新の残像を GC16 で消しておく（スリープ中はそのまま残るため）
+  display.cleanupGhosting(true);
+  
+  // パネルに残る画面の状態と見えているボタンを RTC メモリへ
+  // （復帰時に描き直さずに使い、起こしたタップをボタンに割り当てる）
+  static RetainedUiState retained;
+  display.captureRetainedState(retained);
+  RetainedState::save(retained);
   
   // データを保存
   dataManager.saveConfig();
@@ -173,6 +235,9 @@ void onWakeup() {
     Serial.println("[System] Wakeup by timer");
   }
   
+  // ディープスリープからの起動中（PowerManager::begin から）なら画面は setup() で戻す
+  if (!systemInitialized) return;
+  
   // ステータス復帰
   currentStatus = STATUS_READY;
   display.setStatus(currentStatus);
@@ -180,71 +245,73 @@ void onWakeup() {
 }
 
 // タッチイベント処理
-void handleTouchEvent() {
-  TouchInfo touch = display.getTouch();
-  
+void handleTouchEvent(const TouchInfo& touch) {
   if (!touch.isValid) return;
   
   lastTouchTime = touch.timestamp;
   powerManager.resetActivityTimer();
   
-  // 現在の表示モードに応じて処理
-  DisplayMode mode = display.getDisplayMode();
+  switch (touch.event) {
+    case TOUCH_SWIPE_LEFT:
+    case TOUCH_SWIPE_UP:
+      // リスト表示ではスクロール、アプリ選択では一覧のページ送り
+      if (display.getDisplayMode() == MODE_SHORTCUTS || display.getDisplayMode() == MODE_APPS) display.nextPage();
+      return;
+    case TOUCH_SWIPE_RIGHT:
+    case TOUCH_SWIPE_DOWN:
+      if (display.getDisplayMode() == MODE_SHORTCUTS || display.getDisplayMode() == MODE_APPS) display.prevPage();
+      return;
+    case TOUCH_LONG_PRESS:
+      if (display.getDisplayMode() == MODE_SHORTCUTS || display.getDisplayMode() == MODE_APPS) display.setDisplayMode(MODE_SETTINGS);
+      return;
+    case TOUCH_TAP:
+    case TOUCH_DOUBLE_TAP:
+    default:
+      break;
+  }
   
-  switch (mode) {
-    case MODE_SHORTCUTS: {
-      // ショートカットボタンのタッチチェック
-      Button* touchedButton = display.getTouchedButton(touch.x, touch.y);
-      if (touchedButton) {
-        handleButtonPress(touchedButton);
-        break;
-      }
-      
-      // フッター領域のタッチチェック
-      if (touch.y > DISPLAY_HEIGHT - FOOTER_HEIGHT) {
-        if (touch.x < 100 && display.getCurrentPage() > 0) {
-          // Previous page
-          display.prevPage();
-        } else if (touch.x > DISPLAY_WIDTH - 100 && display.getCurrentPage() < display.getTotalPages() - 1) {
-          // Next page
-          display.nextPage();
-        } else if (touch.x > DISPLAY_WIDTH/2 - 50 && touch.x < DISPLAY_WIDTH/2 + 50) {
-          // Settings button
-          display.setDisplayMode(MODE_SETTINGS);
-        }
-      }
+  // 押された領域は表示中の画面に合わせて DisplayHandler が索引を持っている
+  HitResult hit = display.hitTest(touch.x, touch.y);
+  
+  switch (hit.target) {
+    case HIT_BUTTON:
+      handleButtonPress(display.getButton(hit.index));
       break;
-    }
-    
-    case MODE_SETTINGS: {
-      // Settings画面のボタン
-      if (touch.y > DISPLAY_HEIGHT - 100 && 
-          touch.x > DISPLAY_WIDTH/2 - 50 && touch.x < DISPLAY_WIDTH/2 + 50) {
-        display.setDisplayMode(MODE_SHORTCUTS);
-      } else if (touch.y > 100 && touch.y < 150) {
-        // キーボードモード切り替えボタン
-        handleKeyboardModeSwitch();
-      }
+    case HIT_PREV_PAGE:
+      display.prevPage();
       break;
-    }
-    
-    case MODE_BATTERY_INFO: {
-      // Battery Info画面の戻るボタン
-      if (touch.y > DISPLAY_HEIGHT - 100 && 
-          touch.x > DISPLAY_WIDTH/2 - 50 && touch.x < DISPLAY_WIDTH/2 + 50) {
-        display.setDisplayMode(MODE_SHORTCUTS);
-      }
+    case HIT_NEXT_PAGE:
+      display.nextPage();
       break;
-    }
-    
-    case MODE_ABOUT: {
-      // About画面の戻るボタン
-      if (touch.y > DISPLAY_HEIGHT - 100 && 
-          touch.x > DISPLAY_WIDTH/2 - 50 && touch.x < DISPLAY_WIDTH/2 + 50) {
-        display.setDisplayMode(MODE_SHORTCUTS);
-      }
+    case HIT_SETTINGS:
+      display.setDisplayMode(MODE_SETTINGS);
+      break;
+    case HIT_BACK:
+      // 開いているグループがなければアプリ選択へ
+      display.setDisplayMode(dataManager.getOpenGroup() >= 0 ? MODE_SHORTCUTS : MODE_APPS);
+      break;
+    case HIT_APP:
+      openShortcutGroup(hit.index, 0);
+      break;
+    case HIT_GROUP_TAB:
+      openShortcutGroup(dataManager.getOpenApp(), hit.index);
+      break;
+    case HIT_APPS:
+      closeShortcutGroup();
+      break;
+    case HIT_KEYBOARD_MODE:
+      handleKeyboardModeSwitch();
+      break;
+    case HIT_VIEW_MODE:
+      // グリッド / リスト表示を切り替えて保存
+      systemConfig.listView = !systemConfig.listView;
+      dataManager.setConfig(systemConfig);
+      dataManager.saveConfig();
+      display.setConfig(systemConfig);
+      break;
+    case HIT_NONE:
+    default:
       break;
-    }
   }
 }
 
@@ -254,10 +321,6 @@ void handleButtonPress(Button* button) {
   
   Serial.println("[System] Button pressed: " + button->text);
   
-  // ボタンの視覚的フィードバック
-  button->isPressed = true;
-  display.forceUpdate();
-  
   // ショートカットコマンドを作成
   ShortcutCommand command;
   command.keyCount = button->keyCount;
@@ -267,19 +330,85 @@ void handleButtonPress(Button* button) {
     command.keys[i] = button->keys[i];
   }
   
-  // キーボード入力を送信
-  currentStatus = STATUS_SENDING_KEYS;
-  display.setStatus(currentStatus);
-  
+  // キー送信を最優先（e-ink の更新時間をタップ→入力の遅延に含めない）
   keyboardHandler.sendShortcut(command);
   
-  // フィードバック終了
-  delay(100);
-  button->isPressed = false;
+  // 視覚的フィードバック：そのボタン枠だけ A2 で反転し、PRESS_FEEDBACK_MS 後に自動で戻す
+  // 送信は一瞬で終わるのでヘッダーのステータスは切り替えない（無駄な部分更新を避ける）
+  display.flashButton(button);
+}
+
+// グループを読み込んでディスプレイに渡す（ボタンはこのグループの分だけ作り、前のグループの分は解放される）
+bool loadShortcutGroup(int app, int group) {
+  if (!dataManager.openGroup(app, group)) {
+    Serial.println("[System] Failed to open group " + String(app) + "/" + String(group));
+    return false;
+  }
   
-  // ステータス復帰
-  currentStatus = STATUS_READY;
-  display.setStatus(currentStatus);
+  display.setLocation(app, group);
+  display.setGroups(dataManager.getGroups());
+  display.setButtons(dataManager.getShortcuts());
+  return true;
+}
+
+// グループを開いてショートカット画面へ
+void openShortcutGroup(int app, int group) {
+  if (!loadShortcutGroup(app, group)) return;
+  if (display.getDisplayMode() != MODE_SHORTCUTS) display.showShortcuts();
+}
+
+// 眠る前に開いていたグループを読み直し、パネルの画像がそのまま使えるか確かめる
+bool restoreRetainedScreen(const RetainedUiState& retained) {
+  unsigned long start = millis();
+  if (retained.group >= 0 && !loadShortcutGroup(retained.app, retained.group)) return false;
+  if (!display.restoreRetainedState(retained)) return false;
+  
+  Serial.println("[System] Fast wake: screen restored in " + String(millis() - start) + "ms (uptime " +
+                 String(millis()) + "ms)");
+  return true;
+}
+
+// アプリ選択へ戻る（開いていたグループのボタンを解放する）
+void closeShortcutGroup() {
+  display.showApps();
+  dataManager.closeGroup();
+  display.setLocation(-1, -1);
+  display.setGroups(std::vector<ShortcutGroup>());
+  display.setButtons(std::vector<Button>());
+}
+
+// 起こしたタップの位置を眠る前の画面のボタンに割り当てる（データは読まずに RTC メモリの配置で引く）
+void captureWakeTap(const RetainedUiState& retained) {
+  int16_t x, y;
+  if (!touchHandler.readWakeTouch(x, y)) return;
+  
+  int entry = RetainedState::findButton(retained, x, y);
+  if (entry < 0 || retained.buttons[entry].keyCount == 0) {
+    Serial.println("[System] Wake tap did not hit a shortcut");
+    return;
+  }
+  
+  wakeShortcut = RetainedState::toCommand(retained.buttons[entry]);
+  wakeButtonIndex = retained.buttons[entry].index;
+  wakeShortcutDeadline = millis() + WAKE_TAP_SEND_TIMEOUT_MS;
+  wakeShortcutPending = true;
+}
+
+void sendWakeShortcut() {
+  if (!keyboardHandler.isHostReady()) {
+    if ((long)(millis() - wakeShortcutDeadline) >= 0) {
+      wakeShortcutPending = false;
+      Serial.println("[System] Wake tap dropped: host not ready");
+    }
+    return;
+  }
+  
+  wakeShortcutPending = false;
+  keyboardHandler.sendShortcut(wakeShortcut);
+  Serial.println("[System] Wake tap sent (uptime " + String(millis()) + "ms)");
+  
+  // 眠る前の画面をそのまま使えていれば、押したボタンを反転表示する
+  if (wakeButtonIndex >= 0) display.flashButton(display.getButton(wakeButtonIndex));
 }
 
 // システム状態の定期更新
@@ -306,6 +435,30 @@ void updateSystemStatus() {
   }
 }
 
+// シリアルからの診断コマンド（1行ずつ。読むだけなので loop() は止めない）
+//   stats        描画の計測結果（段階ごとの時間・波形/領域ごとの更新回数）
+//   stats reset  表示してからゼロに戻す（設定を変えた前後を比べるとき）
+void handleSerialCommand() {
+  static String line;
+  while (Serial.available() > 0) {
+    char c = Serial.read();
+    if (c != '\n' && c != '\r') {
+      if (line.length() < 64) line += c;
+      continue;
+    }
+    
+    line.trim();
+    if (line == "stats") {
+      display.printRenderStats(false);
+    } else if (line == "stats reset") {
+      display.printRenderStats(true);
+    } else if (line.length() > 0) {
+      Serial.println("[System] Unknown command: " + line + " (stats | stats reset)");
+    }
+    line = "";
+  }
+}
+
 // システム情報表示
 void printSystemInfo() {
   Serial.println("\n--- System Information ---");
@@ -319,7 +472,8 @@ void printSystemInfo() {
   
   Serial.println("Free Heap: " + String(ESP.getFreeHeap()) + " bytes");
   Serial.println("Data Source: " + dataManager.getCurrentDataSource());
-  Serial.println("Shortcuts: " + String(dataManager.getShortcuts().size()));
+  Serial.println("Apps: " + String(dataManager.getCatalog().size()));
+  Serial.println("Shortcuts (open group): " + String(dataManager.getShortcuts().size()));
   Serial.println("Layout: " + String(systemConfig.layoutColumns) + " columns");
   Serial.println("----------------------------\n");
   
@@ -337,7 +491,6 @@ void enterSleepMode() {
   Serial.println("[System] Entering sleep mode...");
   
   display.showSleepScreen();
-  display.forceUpdate();
   
   powerManager.enterSleep();
 }
@@ -362,7 +515,6 @@ void handlePowerButton() {
     if (pressDuration >= 2000) {  // 2秒長押し = 電源OFF
       Serial.println("[System] Power button long press - shutting down...");
       display.showShutdownScreen();
-      display.forceUpdate();
       delay(2000);
       esp_deep_sleep_start();
     } else if (pressDuration >= 100) {  // 短押し = 画面ON/OFF
@@ -0,0 +1,99 @@
+#include "PageCache.h"
+
+PageCache::PageCache() {
+  pageBytes = 0;
+  available = false;
+  hits = 0;
+  misses = 0;
+  
+  for (int i = 0; i < PAGE_CACHE_PAGES; i++) {
+    entries[i].page = -1;
+    entries[i].pixels = nullptr;
+  }
+}
+
+bool PageCache::begin(size_t bytesPerPage) {
+  if (!psramFound()) {
+    Serial.println("[PageCache] PSRAM not found, page cache disabled");
+    return false;
+  }
+  
+  pageBytes = bytesPerPage;
+  for (int i = 0; i < PAGE_CACHE_PAGES; i++) {
+    entries[i].pixels = (uint8_t*)ps_malloc(pageBytes);
+    if (!entries[i].pixels) {
+      Serial.println("[PageCache] PSRAM allocation failed, page cache disabled");
+      for (int j = 0; j < i; j++) {
+        free(entries[j].pixels);
+        entries[j].pixels = nullptr;
+      }
+      return false;
+    }
+  }
+  
+  available = true;
+  Serial.println("[PageCache] " + String(PAGE_CACHE_PAGES) + " pages x " + String(pageBytes) + " bytes in PSRAM");
+  return true;
+}
+
+bool PageCache::isAvailable() {
+  return available;
+}
+
+void PageCache::invalidate() {
+  for (int i = 0; i < PAGE_CACHE_PAGES; i++) {
+    entries[i].page = -1;
+  }
+}
+
+bool PageCache::contains(int page) {
+  if (!available) return false;
+  for (int i = 0; i < PAGE_CACHE_PAGES; i++) {
+    if (entries[i].page == page) return true;
+  }
+  return false;
+}
+
+bool PageCache::load(int page, uint8_t* dst) {
+  if (!available) return false;
+  
+  for (int i = 0; i < PAGE_CACHE_PAGES; i++) {
+    if (entries[i].page == page) {
+      memcpy(dst, entries[i].pixels, pageBytes);
+      hits++;
+      return true;
+    }
+  }
+  misses++;
+  return false;
+}
+
+void PageCache::store(int page, int currentPage, const uint8_t* src) {
+  if (!available) return;
+  
+  // 同じページ → 空き → 現在ページから最も遠いページ の順に書き込み先を選ぶ
+  int target = -1;
+  int farthest = -1;
+  for (int i = 0; i < PAGE_CACHE_PAGES; i++) {
+    if (entries[i].page == page) {
+      target = i;
+      break;
+    }
+    int distance = (entries[i].page < 0) ? INT_MAX : abs(entries[i].page - currentPage);
+    if (distance > farthest) {
+      farthest = distance;
+      target = i;
+    }
+  }
+  
+  memcpy(entries[target].pixels, src, pageBytes);
+  entries[target].page = page;
+}
+
+uint32_t PageCache::getHits() {
+  return hits;
+}
+
+uint32_t PageCache::getMisses() {
+  return misses;
+}
@@ -0,0 +1,35 @@
+#ifndef PAGECACHE_H
+#define PAGECACHE_H
+
+#include "Config.h"
+
+// ボタン領域のページ画像（4bpp、キャンバスと同じ並び）をPSRAMに保持するキャッシュ
+// 現在ページと前後のページを置いておき、ページ切り替えをmemcpy + パネル転送だけにする
+class PageCache {
+private:
+  struct Entry {
+    int page;          // -1 = 空き
+    uint8_t* pixels;
+  };
+  Entry entries[PAGE_CACHE_PAGES];
+  size_t pageBytes;
+  bool available;
+  
+  uint32_t hits;
+  uint32_t misses;
+
+public:
+  PageCache();
+  bool begin(size_t bytesPerPage);
+  bool isAvailable();
+  
+  void invalidate();
+  bool contains(int page);
+  bool load(int page, uint8_t* dst);
+  void store(int page, int currentPage, const uint8_t* src);
+  
+  uint32_t getHits();
+  uint32_t getMisses();
+};
+
+#endif // PAGECACHE_H
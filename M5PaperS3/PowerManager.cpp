@@ -44,6 +44,7 @@ void PowerManager::begin(SystemConfig* cfg) {
   esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
   
   switch (wakeup_reason) {
+    case ESP_SLEEP_WAKEUP_EXT0:
     case ESP_SLEEP_WAKEUP_TOUCHPAD:
       wakeupByTouch = true;
       Serial.println("[Power] Wakeup by touch");
@@ -205,9 +206,14 @@ void PowerManager::setSleepTime(unsigned long sleepTimeMs) {
 
 void PowerManager::enableTouchWakeup(bool enabled) {
   if (enabled) {
-    // M5PaperS3のタッチパネルをウェイクアップソースに設定
-    esp_sleep_enable_touchpad_wakeup();
-    Serial.println("[Power] Touch wakeup enabled");
+    // タッチパネル（GT911）の INT が Low になったら起きる
+    // （ESP32 内蔵のタッチパッドではなく、外付けコントローラの割り込み線）
+    if (esp_sleep_is_valid_wakeup_gpio((gpio_num_t)TOUCH_INT_PIN)) {
+      esp_sleep_enable_ext0_wakeup((gpio_num_t)TOUCH_INT_PIN, 0);
+      Serial.println("[Power] Touch wakeup enabled (INT=" + String(TOUCH_INT_PIN) + ")");
+    } else {
+      Serial.println("[Power] Touch wakeup unavailable: GPIO" + String(TOUCH_INT_PIN) + " is not an RTC GPIO");
+    }
   } else {
     // タッチウェイクアップを無効にする場合の処理
     Serial.println("[Power] Touch wakeup disabled");
@@ -0,0 +1,130 @@
+#include "RenderStats.h"
+
+static const char* const STAGE_NAMES[STAGE_COUNT] = {
+  "header", "buttons", "slot", "footer", "widgets", "gram", "epd", "frame"
+};
+
+static const char* const KIND_NAMES[RENDER_STATS_KINDS] = {
+  "full", "content", "text", "highlight", "press", "cleanup"
+};
+
+static const char* const MODE_NAMES[RENDER_STATS_MODES] = {
+  "INIT", "DU", "GC16", "GL16", "GLR16", "GLD16", "DU4", "A2", "NONE"
+};
+
+static const char* const AREA_NAMES[RENDER_STATS_AREAS] = {
+  "header", "grid", "footer", "full"
+};
+
+RenderStats::RenderStats() {
+  reset();
+}
+
+void RenderStats::reset() {
+  memset(stages, 0, sizeof(stages));
+  memset(modeCounts, 0, sizeof(modeCounts));
+  memset(modePixels, 0, sizeof(modePixels));
+  memset(kindCounts, 0, sizeof(kindCounts));
+  memset(areaCounts, 0, sizeof(areaCounts));
+  since = millis();
+}
+
+int RenderStats::bucketOf(uint32_t us) {
+  // 250us 単位で2倍ずつ（0: <0.25ms, 1: <0.5ms, 2: <1ms, ...）
+  uint32_t units = us / 250;
+  if (units == 0) return 0;
+  int bucket = 32 - __builtin_clz(units);
+  return min(bucket, RENDER_STATS_BUCKETS - 1);
+}
+
+uint32_t RenderStats::bucketLimitUs(int bucket) {
+  return 250u << bucket;
+}
+
+void RenderStats::record(RenderStage stage, uint32_t startUs) {
+  uint32_t elapsed = micros() - startUs;
+  StageStats& s = stages[stage];
+  s.count++;
+  s.totalUs += elapsed;
+  if (elapsed > s.maxUs) s.maxUs = elapsed;
+
+  // 一定回数ごとに分布を半分にして、古い計測ほど効かなくする（設定や画面を変えた後の傾向が見える）
+  if (++s.windowCount >= RENDER_STATS_WINDOW) {
+    for (int i = 0; i < RENDER_STATS_BUCKETS; i++) s.buckets[i] /= 2;
+    s.windowCount /= 2;
+  }
+  s.buckets[bucketOf(elapsed)]++;
+}
+
+void RenderStats::recordRefresh(int kind, int mode, int area, uint32_t pixels) {
+  if (kind >= 0 && kind < RENDER_STATS_KINDS) kindCounts[kind]++;
+  if (area >= 0 && area < RENDER_STATS_AREAS) areaCounts[area]++;
+  if (mode >= 0 && mode < RENDER_STATS_MODES) {
+    modeCounts[mode]++;
+    modePixels[mode] += pixels;
+  }
+}
+
+uint32_t RenderStats::percentileUs(const StageStats& stage, int percent) {
+  // 分布から求めるので、値はその区間の上限（最後の区間は最大値）
+  uint32_t total = 0;
+  for (int i = 0; i < RENDER_STATS_BUCKETS; i++) total += stage.buckets[i];
+  if (total == 0) return 0;
+
+  uint32_t target = (total * percent + 99) / 100;
+  uint32_t seen = 0;
+  for (int i = 0; i < RENDER_STATS_BUCKETS - 1; i++) {
+    seen += stage.buckets[i];
+    if (seen >= target) return min(bucketLimitUs(i), stage.maxUs);
+  }
+  return stage.maxUs;
+}
+
+void RenderStats::print() {
+  Serial.println("\n--- Render Stats (" + String((millis() - since) / 1000) + "s) ---");
+  Serial.println("stage       count     avg     p50     p90     max  (ms, p50/p90 are bucket upper bounds)");
+  for (int i = 0; i < STAGE_COUNT; i++) {
+    const StageStats& s = stages[i];
+    if (s.count == 0) continue;
+    Serial.printf("%-8s %8u %7.2f %7.2f %7.2f %7.2f\n", STAGE_NAMES[i], (unsigned)s.count,
+                  s.totalUs / 1000.0 / s.count, percentileUs(s, 50) / 1000.0,
+                  percentileUs(s, 90) / 1000.0, s.maxUs / 1000.0);
+  }
+
+  // 直近の分布（空の区間は省く）
+  Serial.println("histogram (recent, upper bound in ms):");
+  for (int i = 0; i < STAGE_COUNT; i++) {
+    const StageStats& s = stages[i];
+    if (s.count == 0) continue;
+    String line = String(STAGE_NAMES[i]) + ":";
+    for (int b = 0; b < RENDER_STATS_BUCKETS; b++) {
+      if (s.buckets[b] == 0) continue;
+      float limit = bucketLimitUs(b) / 1000.0;
+      line += (b == RENDER_STATS_BUCKETS - 1) ? " >=" + String(bucketLimitUs(b - 1) / 1000.0, 0)
+                                               : " <" + String(limit, limit < 1 ? 2 : 0);
+      line += "=" + String(s.buckets[b]);
+    }
+    Serial.println(line);
+  }
+
+  Serial.print("refresh by mode:");
+  for (int i = 0; i < RENDER_STATS_MODES; i++) {
+    if (modeCounts[i] == 0) continue;
+    // 画素数は画面何枚分か（全画面 = 1.0）
+    float screens = modePixels[i] / (float)(DISPLAY_WIDTH * DISPLAY_HEIGHT);
+    Serial.print(" " + String(MODE_NAMES[i]) + "=" + String(modeCounts[i]) + " (" + String(screens, 1) + " screens)");
+  }
+  Serial.println();
+
+  Serial.print("refresh by kind:");
+  for (int i = 0; i < RENDER_STATS_KINDS; i++) {
+    if (kindCounts[i] > 0) Serial.print(" " + String(KIND_NAMES[i]) + "=" + String(kindCounts[i]));
+  }
+  Serial.println();
+
+  Serial.print("refresh by area:");
+  for (int i = 0; i < RENDER_STATS_AREAS; i++) {
+    if (areaCounts[i] > 0) Serial.print(" " + String(AREA_NAMES[i]) + "=" + String(areaCounts[i]));
+  }
+  Serial.println();
+}
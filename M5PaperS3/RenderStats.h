@@ -0,0 +1,77 @@
+#ifndef RENDERSTATS_H
+#define RENDERSTATS_H
+
+#include "Config.h"
+
+// 描画の段階（計測の単位）
+enum RenderStage {
+  STAGE_HEADER,     // drawHeader
+  STAGE_BUTTONS,    // ボタン領域全体（drawButtons / リストの表示範囲 / ページキャッシュからの復元）
+  STAGE_SLOT,       // ボタン枠1つ（drawSlot）
+  STAGE_FOOTER,     // drawFooter
+  STAGE_WIDGETS,    // 設定などの画面のウィジェット
+  STAGE_GRAM,       // キャンバスから IT8951 の GRAM への書き込み
+  STAGE_EPD,        // 波形の実行（UpdateArea / UpdateFull。前の更新の BUSY 待ちを含む）
+  STAGE_FRAME,      // 描画タスクの1サイクル（描画 + 転送）
+  STAGE_COUNT
+};
+
+// 転送先の領域（ヘッダー・ボタン領域・フッター・全画面）
+#define RENDER_STATS_AREAS 4
+#define RENDER_STATS_AREA_FULL 3
+
+// RefreshKind の数（DisplayHandler.cpp で一致を確認する）
+#define RENDER_STATS_KINDS 6
+
+// m5epd_update_mode_t の値の数（INIT〜NONE）
+#define RENDER_STATS_MODES 9
+
+// 1区間のヒストグラムの幅（2倍ずつ: <0.25ms, <0.5ms, ... , 1s以上）
+#define RENDER_STATS_BUCKETS 14
+
+// 描画経路の計測（段階ごとの所要時間のヒストグラム、波形・領域ごとの更新回数）
+// 書き込みは描画タスクだけが行い、表示とリセットも描画タスクへのコマンドで行う
+class RenderStats {
+private:
+  struct StageStats {
+    uint32_t count;          // 起動（リセット）からの回数
+    uint64_t totalUs;
+    uint32_t maxUs;
+    uint16_t buckets[RENDER_STATS_BUCKETS];  // 直近の分布（RENDER_STATS_WINDOW 回ごとに半分にする）
+    uint16_t windowCount;
+  };
+  StageStats stages[STAGE_COUNT];
+  uint32_t modeCounts[RENDER_STATS_MODES];
+  uint64_t modePixels[RENDER_STATS_MODES];
+  uint32_t kindCounts[RENDER_STATS_KINDS];
+  uint32_t areaCounts[RENDER_STATS_AREAS];
+  unsigned long since;
+
+  static int bucketOf(uint32_t us);
+  static uint32_t bucketLimitUs(int bucket);
+  uint32_t percentileUs(const StageStats& stage, int percent);
+
+public:
+  RenderStats();
+  void reset();
+
+  // 開始時刻は micros() で取り、終わったら record する
+  void record(RenderStage stage, uint32_t startUs);
+  void recordRefresh(int kind, int mode, int area, uint32_t pixels);
+
+  void print();
+};
+
+// スコープを抜けるまでの時間を記録する（途中で return する描画関数でも漏れなく測る）
+class RenderTimer {
+private:
+  RenderStats& stats;
+  RenderStage stage;
+  uint32_t start;
+
+public:
+  RenderTimer(RenderStats& target, RenderStage timedStage) : stats(target), stage(timedStage), start(micros()) {}
+  ~RenderTimer() { stats.record(stage, start); }
+};
+
+#endif // RENDERSTATS_H
@@ -0,0 +1,40 @@
+#include "RetainedState.h"
+#include <esp_attr.h>
+
+// RTC スローメモリはディープスリープ中も保持され、電源投入時は初期値（magic = 0）に戻る
+RTC_DATA_ATTR static RetainedUiState retained = {};
+
+bool RetainedState::take(RetainedUiState& out) {
+  if (retained.magic != RETAINED_STATE_MAGIC) return false;
+  out = retained;
+  retained.magic = 0;
+  return true;
+}
+
+void RetainedState::save(const RetainedUiState& state) {
+  retained = state;
+  Serial.println("[Retained] Saved mode " + String(state.mode) + ", page " + String(state.page) +
+                 ", " + String(state.buttonCount) + " buttons" +
+                 (state.magic == RETAINED_STATE_MAGIC ? "" : " (invalid)"));
+}
+
+int RetainedState::findButton(const RetainedUiState& state, int x, int y) {
+  for (int i = 0; i < state.buttonCount && i < RETAINED_MAX_BUTTONS; i++) {
+    const RetainedButton& button = state.buttons[i];
+    if (x >= button.x && x < button.x + button.width &&
+        y >= button.y && y < button.y + button.height) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+ShortcutCommand RetainedState::toCommand(const RetainedButton& button) {
+  ShortcutCommand command;
+  command.keyCount = min((int)button.keyCount, RETAINED_MAX_KEYS);
+  command.delay = KEY_SEND_DELAY;
+  for (int i = 0; i < command.keyCount; i++) {
+    command.keys[i] = String(button.keys[i]);
+  }
+  return command;
+}
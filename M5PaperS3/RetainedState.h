@@ -0,0 +1,49 @@
+#ifndef RETAINEDSTATE_H
+#define RETAINEDSTATE_H
+
+#include "Config.h"
+
+#define RETAINED_STATE_MAGIC 0x45534B32  // "ESK2"
+#define RETAINED_MAX_BUTTONS 32          // 保存するボタン（画面に見えているもの）の上限
+#define RETAINED_MAX_KEYS 5              // これより多いキーのショートカットは起こしたタップでは送らない
+#define RETAINED_KEY_NAME 10             // キー名の長さ（終端を含む。"backspace" まで入る）
+
+// 画面に見えていたボタンの位置と送るキー（起こしたタップをデータを読まずにボタンへ割り当てる）
+struct RetainedButton {
+  int16_t x, y, width, height;
+  int16_t index;                   // DisplayHandler のボタン番号（押下表示用）
+  uint8_t keyCount;                // 0 = 送れない（キーが多すぎる・長すぎる）
+  char keys[RETAINED_MAX_KEYS][RETAINED_KEY_NAME];
+};
+
+// ディープスリープ中も RTC メモリに残す画面の状態
+// e-ink は電源を切っても画像が残るので、復帰時はこの状態の画面がそのまま表示されているとみなし、
+// パネルの消去と全画面の描き直しを省く
+struct RetainedUiState {
+  uint32_t magic;          // RETAINED_STATE_MAGIC 以外なら無効
+  uint32_t layoutHash;     // 画面の内容を決めるデータと設定の要約（復帰後に作り直して比べる）
+  uint8_t mode;            // DisplayMode
+  int16_t app;             // 開いていたアプリとグループ（-1 = なし）
+  int16_t group;
+  int16_t page;            // グリッドのページ / アプリ選択のページ
+  int16_t listScrollY;
+  uint8_t status;          // パネルに表示されているステータス（DeviceStatus）
+  int8_t batteryPercent;   // パネルに表示されているバッテリー情報
+  bool batteryCharging;
+  float batteryVoltage;
+  uint8_t buttonCount;     // ショートカット画面のときだけ
+  RetainedButton buttons[RETAINED_MAX_BUTTONS];
+};
+
+class RetainedState {
+public:
+  // 読み出すと同時に消す（シャットダウン画面のまま眠った後などに古い状態を使わない）
+  static bool take(RetainedUiState& out);
+  static void save(const RetainedUiState& state);
+  
+  // 画面座標にあったボタン（state.buttons の番号、なければ -1）
+  static int findButton(const RetainedUiState& state, int x, int y);
+  static ShortcutCommand toCommand(const RetainedButton& button);
+};
+
+#endif // RETAINEDSTATE_H
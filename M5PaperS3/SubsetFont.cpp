@@ -0,0 +1,53 @@
+#include "SubsetFont.h"
+
+// FONT_SUBSET_DISABLED は生成済みのデータがあっても使わない（render_sim の基準画像は箱の文字で作ってある）
+#if __has_include("FontSubsetData.h") && !defined(FONT_SUBSET_DISABLED)
+#include "FontSubsetData.h"
+#define HAS_FONT_SUBSET 1
+#else
+#define HAS_FONT_SUBSET 0
+#endif
+
+bool SubsetFont::isAvailable() {
+  return HAS_FONT_SUBSET;
+}
+
+int SubsetFont::getGlyphCount() {
+#if HAS_FONT_SUBSET
+  return FONT_SUBSET_GLYPH_COUNT;
+#else
+  return 0;
+#endif
+}
+
+bool SubsetFont::find(uint32_t codepoint, int size, Glyph& out) {
+#if HAS_FONT_SUBSET
+  if (codepoint > 0xFFFF) return false;
+
+  uint16_t block = FONT_SUBSET_BLOCKS[codepoint >> 8];
+  if (block == SUBSET_FONT_NO_BLOCK) return false;
+  uint16_t index = FONT_SUBSET_INDEX[block * 256 + (codepoint & 0xFF)];
+  if (index == 0) return false;
+
+  for (int i = 0; i < FONT_SUBSET_SIZE_COUNT; i++) {
+    const SubsetFontSize& font = FONT_SUBSET_SIZES[i];
+    if (font.size != size) continue;
+
+    const SubsetGlyph& glyph = font.glyphs[index - 1];
+    out.codepoint = codepoint;
+    out.size = size;
+    out.advance = glyph.advance;
+    out.offsetX = glyph.offsetX;
+    out.offsetY = glyph.offsetY;
+    out.width = glyph.width;
+    out.height = glyph.height;
+    out.pixels = font.bitmap + glyph.offset;
+    return true;
+  }
+#else
+  (void)codepoint;
+  (void)size;
+  (void)out;
+#endif
+  return false;
+}
@@ -0,0 +1,38 @@
+#ifndef SUBSETFONT_H
+#define SUBSETFONT_H
+
+#include "Config.h"
+#include "GlyphCache.h"
+
+// ショートカット一覧で使う文字だけを事前にラスタライズしたフラッシュ常駐フォント
+// データ（FontSubsetData.h）は scripts/font_subset.cpp で生成する。無ければ無効
+//
+// 引き方: コードポイントの上位8bit → ブロック番号 → 下位8bit → グリフ番号（配列を2回引くだけ）
+
+#define SUBSET_FONT_NO_BLOCK 0xFFFF
+
+struct SubsetGlyph {
+  uint32_t offset;     // ビットマップ配列内の位置（バイト）
+  uint8_t advance;
+  int8_t offsetX;      // ペン位置（左上）からのインク矩形のずれ
+  int8_t offsetY;
+  uint8_t width;
+  uint8_t height;
+};
+
+struct SubsetFontSize {
+  uint8_t size;
+  const SubsetGlyph* glyphs;   // グリフ番号順
+  const uint8_t* bitmap;       // 4bpp カバレッジ（GlyphCache と同じ並び）
+};
+
+class SubsetFont {
+public:
+  static bool isAvailable();
+  static int getGlyphCount();
+
+  // 見つかれば out に書き込む（画素はフラッシュ上を直接指す）
+  static bool find(uint32_t codepoint, int size, Glyph& out);
+};
+
+#endif // SUBSETFONT_H
@@ -0,0 +1,231 @@
+#include "TouchHandler.h"
+
+TouchHandler* TouchHandler::instance = nullptr;
+
+TouchHandler::TouchHandler() {
+  taskHandle = nullptr;
+  eventQueue = nullptr;
+  irqTime = 0;
+  ringHead = 0;
+  ringCount = 0;
+  fingerDown = false;
+  longPressSent = false;
+  hasLastTap = false;
+  skipStroke = false;
+  samples = 0;
+  droppedEvents = 0;
+}
+
+void TouchHandler::begin() {
+  // M5.begin() で GT911 の初期化が済んでいること
+  instance = this;
+  eventQueue = xQueueCreate(TOUCH_QUEUE_LENGTH, sizeof(TouchInfo));
+  xTaskCreatePinnedToCore(touchTask, "touch", TOUCH_TASK_STACK, this,
+                          TOUCH_TASK_PRIORITY, &taskHandle, TOUCH_TASK_CORE);
+
+  // GT911 は座標が更新されるたびに INT を Low パルスにする
+  pinMode(TOUCH_INT_PIN, INPUT);
+  attachInterrupt(digitalPinToInterrupt(TOUCH_INT_PIN), onInterrupt, FALLING);
+
+  Serial.println("[Touch] Interrupt-driven touch started (INT=" + String(TOUCH_INT_PIN) + ")");
+}
+
+bool TouchHandler::readWakeTouch(int16_t& x, int16_t& y) {
+  // 指が触れたままか、コントローラに最初の座標がまだ残っていれば読める
+  M5.TP.update();
+  if (M5.TP.isFingerUp() || M5.TP.getFingerNum() == 0) {
+    Serial.println("[Touch] Wake touch already released");
+    return false;
+  }
+  x = M5.TP.readFingerX(0);
+  y = M5.TP.readFingerY(0);
+
+  // 同じストロークを後からもう一度タップとして通知しない
+  skipStroke = true;
+  Serial.println("[Touch] Wake touch at (" + String(x) + ", " + String(y) + ")");
+  return true;
+}
+
+void IRAM_ATTR TouchHandler::onInterrupt() {
+  // 割り込みでは I2C に触らず、時刻を残してタスクを起こすだけ
+  if (!instance || !instance->taskHandle) return;
+  instance->irqTime = millis();
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(instance->taskHandle, &woken);
+  if (woken) portYIELD_FROM_ISR();
+}
+
+void TouchHandler::touchTask(void* arg) {
+  static_cast<TouchHandler*>(arg)->run();
+}
+
+void TouchHandler::run() {
+  while (true) {
+    bool notified = ulTaskNotifyTake(pdTRUE, nextWait()) > 0;
+    unsigned long now = millis();
+
+    if (notified) {
+      readController(irqTime);
+    } else if (fingerDown) {
+      // 待ち時間切れ：長押しの判定か、離した INT の取りこぼし
+      checkLongPress(now);
+      if (now - lastSample().timestamp >= TOUCH_RELEASE_TIMEOUT_MS) {
+        readController(now);
+      }
+    }
+  }
+}
+
+TickType_t TouchHandler::nextWait() {
+  if (!fingerDown) return portMAX_DELAY;
+
+  unsigned long now = millis();
+  unsigned long deadline = lastSample().timestamp + TOUCH_RELEASE_TIMEOUT_MS;
+  if (!longPressSent) {
+    unsigned long pressDeadline = firstSample().timestamp + LONG_PRESS_DURATION;
+    if (pressDeadline < deadline) deadline = pressDeadline;
+  }
+  if (deadline <= now) return 1;
+  return pdMS_TO_TICKS(deadline - now);
+}
+
+void TouchHandler::readController(unsigned long timestamp) {
+  M5.TP.update();
+
+  TouchSample sample;
+  sample.timestamp = timestamp;
+  sample.down = !M5.TP.isFingerUp() && M5.TP.getFingerNum() > 0;
+  if (sample.down) {
+    if (skipStroke) return;  // 起こしたタッチの続き（離れたら通常の処理に戻る）
+    sample.x = M5.TP.readFingerX(0);
+    sample.y = M5.TP.readFingerY(0);
+  } else if (fingerDown) {
+    // 離した瞬間は座標が来ないので最後の位置を使う
+    sample.x = lastSample().x;
+    sample.y = lastSample().y;
+  } else {
+    skipStroke = false;
+    return;
+  }
+  samples++;
+
+  if (sample.down && !fingerDown) {
+    onFingerDown(sample);
+  } else if (sample.down) {
+    pushSample(sample);
+    checkLongPress(timestamp);
+  } else {
+    pushSample(sample);
+    onFingerUp(sample);
+  }
+}
+
+void TouchHandler::pushSample(const TouchSample& sample) {
+  // 溢れたら古いサンプルから上書きする（始点は strokeStart に別に持つ）
+  ring[(ringHead + ringCount) % TOUCH_RING_SIZE] = sample;
+  if (ringCount < TOUCH_RING_SIZE) {
+    ringCount++;
+  } else {
+    ringHead = (ringHead + 1) % TOUCH_RING_SIZE;
+  }
+}
+
+const TouchSample& TouchHandler::firstSample() {
+  return strokeStart;
+}
+
+const TouchSample& TouchHandler::lastSample() {
+  return ring[(ringHead + ringCount - 1) % TOUCH_RING_SIZE];
+}
+
+void TouchHandler::onFingerDown(const TouchSample& sample) {
+  ringHead = 0;
+  ringCount = 0;
+  strokeStart = sample;
+  pushSample(sample);
+  fingerDown = true;
+  longPressSent = false;
+}
+
+void TouchHandler::onFingerUp(const TouchSample& sample) {
+  fingerDown = false;
+  if (longPressSent) return;  // 長押しは押している間に通知済み
+
+  const TouchSample& start = firstSample();
+  int dx = sample.x - start.x;
+  int dy = sample.y - start.y;
+  int adx = abs(dx);
+  int ady = abs(dy);
+
+  if (adx >= SWIPE_MIN_DISTANCE || ady >= SWIPE_MIN_DISTANCE) {
+    TouchEvent event;
+    if (adx >= ady) event = dx < 0 ? TOUCH_SWIPE_LEFT : TOUCH_SWIPE_RIGHT;
+    else event = dy < 0 ? TOUCH_SWIPE_UP : TOUCH_SWIPE_DOWN;
+    emit(event, start.x, start.y, sample.timestamp);
+    hasLastTap = false;
+    return;
+  }
+  if (adx > TAP_MAX_MOVE || ady > TAP_MAX_MOVE) {
+    // タップでもスワイプでもない中途半端な動きは捨てる
+    hasLastTap = false;
+    return;
+  }
+
+  // タップはすぐ通知し、直前のタップと近ければダブルタップとして通知する
+  // （シングルタップを保留しないのでボタンの反応は遅れない）
+  if (hasLastTap &&
+      start.timestamp - lastTap.timestamp <= DOUBLE_TAP_INTERVAL &&
+      abs(start.x - lastTap.x) <= TAP_MAX_MOVE * 2 &&
+      abs(start.y - lastTap.y) <= TAP_MAX_MOVE * 2) {
+    emit(TOUCH_DOUBLE_TAP, start.x, start.y, sample.timestamp);
+    hasLastTap = false;
+  } else {
+    emit(TOUCH_TAP, start.x, start.y, sample.timestamp);
+    lastTap = sample;
+    lastTap.x = start.x;
+    lastTap.y = start.y;
+    hasLastTap = true;
+  }
+}
+
+void TouchHandler::checkLongPress(unsigned long now) {
+  if (!fingerDown || longPressSent) return;
+
+  const TouchSample& start = firstSample();
+  const TouchSample& last = lastSample();
+  if (abs(last.x - start.x) > TAP_MAX_MOVE || abs(last.y - start.y) > TAP_MAX_MOVE) return;
+  if (now - start.timestamp < LONG_PRESS_DURATION) return;
+
+  emit(TOUCH_LONG_PRESS, start.x, start.y, now);
+  longPressSent = true;
+  hasLastTap = false;
+}
+
+void TouchHandler::emit(TouchEvent event, int x, int y, unsigned long timestamp) {
+  TouchInfo touch;
+  touch.x = x;
+  touch.y = y;
+  touch.event = event;
+  touch.timestamp = timestamp;
+  touch.isValid = true;
+
+  // loop() が詰まっていてもタッチタスクは止めない
+  if (xQueueSend(eventQueue, &touch, 0) != pdTRUE) {
+    droppedEvents++;
+    return;
+  }
+  Serial.println("[Touch] Event " + String(event) + " at (" + String(x) + ", " + String(y) + ")");
+}
+
+bool TouchHandler::getEvent(TouchInfo& out, TickType_t wait) {
+  if (!eventQueue) return false;
+  return xQueueReceive(eventQueue, &out, wait) == pdTRUE;
+}
+
+uint32_t TouchHandler::getSampleCount() {
+  return samples;
+}
+
+uint32_t TouchHandler::getDroppedEvents() {
+  return droppedEvents;
+}
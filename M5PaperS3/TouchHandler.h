@@ -0,0 +1,67 @@
+#ifndef TOUCHHANDLER_H
+#define TOUCHHANDLER_H
+
+#include "Config.h"
+#include <M5EPD.h>
+
+// タッチパネルの生サンプル
+struct TouchSample {
+  int16_t x, y;
+  bool down;                // false = 指が離れた
+  unsigned long timestamp;  // INT を受けた時刻（ms）
+};
+
+// GT911 の INT 割り込みで動くタッチ処理
+// 割り込み → タッチタスクが座標を読んでリングバッファへ → ジェスチャー認識 → イベントキュー
+// 触っていない間はタスクも loop() もキュー待ちで眠っている
+class TouchHandler {
+private:
+  TaskHandle_t taskHandle;
+  QueueHandle_t eventQueue;
+  volatile unsigned long irqTime;
+
+  // 現在のストローク（指が触れてから離れるまで）の生サンプル
+  TouchSample ring[TOUCH_RING_SIZE];
+  TouchSample strokeStart;
+  int ringHead;
+  int ringCount;
+
+  // ジェスチャー認識の状態
+  bool fingerDown;
+  bool longPressSent;
+  TouchSample lastTap;
+  bool hasLastTap;
+  bool skipStroke;          // ディープスリープを解いたストローク（押下として処理済み）を離すまで無視する
+
+  uint32_t samples;
+  uint32_t droppedEvents;
+
+  static TouchHandler* instance;
+  static void IRAM_ATTR onInterrupt();
+  static void touchTask(void* arg);
+  void run();
+  TickType_t nextWait();
+  void readController(unsigned long timestamp);
+  void pushSample(const TouchSample& sample);
+  const TouchSample& firstSample();
+  const TouchSample& lastSample();
+  void onFingerDown(const TouchSample& sample);
+  void onFingerUp(const TouchSample& sample);
+  void checkLongPress(unsigned long now);
+  void emit(TouchEvent event, int x, int y, unsigned long timestamp);
+
+public:
+  TouchHandler();
+  void begin();
+
+  // ディープスリープ復帰直後に、起こしたタッチの座標を読む（begin() より前、M5.begin() の後に呼ぶ）
+  bool readWakeTouch(int16_t& x, int16_t& y);
+
+  // 認識済みのジェスチャーを1つ取り出す（wait まで待つ）
+  bool getEvent(TouchInfo& out, TickType_t wait);
+
+  uint32_t getSampleCount();
+  uint32_t getDroppedEvents();
+};
+
+#endif // TOUCHHANDLER_H
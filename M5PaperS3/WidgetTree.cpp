@@ -0,0 +1,134 @@
+#include "WidgetTree.h"
+
+void WidgetTree::clear() {
+  widgets.clear();
+  damage.clear();
+}
+
+int WidgetTree::add(WidgetType type, int parent, const DisplayRect& spec) {
+  Widget widget;
+  widget.type = type;
+  widget.parent = parent;
+  widget.spec = spec;
+  widget.rect = spec;
+  widget.pitch = 0;
+  widget.fontSize = FONT_SIZE_MEDIUM;
+  widget.centered = false;
+  widget.value = 0;
+  widget.target = HIT_NONE;
+  widget.index = -1;
+  widget.icon = ICON_NONE;
+  widget.iconAfterText = false;
+  widgets.push_back(widget);
+  return widgets.size() - 1;
+}
+
+int WidgetTree::addList(const DisplayRect& rect, int pitch) {
+  int id = add(WIDGET_LIST, -1, rect);
+  widgets[id].pitch = pitch;
+  return id;
+}
+
+int WidgetTree::addLabel(int parent, const DisplayRect& spec, const String& text, int fontSize, bool centered) {
+  int id = add(WIDGET_LABEL, parent, spec);
+  widgets[id].text = text;
+  widgets[id].fontSize = fontSize;
+  widgets[id].centered = centered;
+  return id;
+}
+
+int WidgetTree::addButton(int parent, const DisplayRect& spec, const String& text, HitTarget target, int index,
+                          IconId icon, bool iconAfterText) {
+  int id = add(WIDGET_BUTTON, parent, spec);
+  widgets[id].text = text;
+  widgets[id].icon = icon;
+  widgets[id].iconAfterText = iconAfterText;
+  widgets[id].fontSize = FONT_SIZE_SMALL;
+  widgets[id].target = target;
+  widgets[id].index = index;
+  return id;
+}
+
+int WidgetTree::addBatteryIcon(int parent, const DisplayRect& spec, int percentage) {
+  int id = add(WIDGET_BATTERY_ICON, parent, spec);
+  widgets[id].value = percentage;
+  return id;
+}
+
+void WidgetTree::layout() {
+  // リストごとの次の行の位置
+  std::vector<int> cursor(widgets.size(), 0);
+
+  for (size_t i = 0; i < widgets.size(); i++) {
+    Widget& widget = widgets[i];
+    if (widget.parent < 0) {
+      widget.rect = widget.spec;
+    } else {
+      Widget& list = widgets[widget.parent];
+      int rowY = list.rect.y + cursor[widget.parent];
+      widget.rect.x = list.rect.x + widget.spec.x;
+      widget.rect.y = rowY + widget.spec.y;
+      widget.rect.width = widget.spec.width > 0 ? widget.spec.width : list.rect.width - widget.spec.x;
+      widget.rect.height = widget.spec.height > 0 ? widget.spec.height : list.pitch;
+      cursor[widget.parent] += max(list.pitch, widget.spec.y + widget.rect.height);
+
+      // リストの高さは子の行の合計
+      list.rect.height = max(list.rect.height, cursor[widget.parent]);
+    }
+    if (widget.type == WIDGET_LIST) widget.rect.height = 0;
+  }
+}
+
+bool WidgetTree::sameContent(const Widget& a, const Widget& b) {
+  return a.rect.x == b.rect.x && a.rect.y == b.rect.y &&
+         a.rect.width == b.rect.width && a.rect.height == b.rect.height &&
+         a.text == b.text && a.value == b.value && a.fontSize == b.fontSize &&
+         a.centered == b.centered && a.target == b.target && a.index == b.index &&
+         a.icon == b.icon && a.iconAfterText == b.iconAfterText;
+}
+
+bool WidgetTree::update(const WidgetTree& next) {
+  bool sameShape = widgets.size() == next.widgets.size();
+  for (size_t i = 0; sameShape && i < widgets.size(); i++) {
+    sameShape = widgets[i].type == next.widgets[i].type && widgets[i].parent == next.widgets[i].parent;
+  }
+
+  if (sameShape) {
+    for (size_t i = 0; i < widgets.size(); i++) {
+      const Widget& before = widgets[i];
+      const Widget& after = next.widgets[i];
+      // リスト自体は描かない（子の変化は子の矩形で拾う）
+      if (after.type == WIDGET_LIST || sameContent(before, after)) continue;
+      addDamage(before.rect);
+      addDamage(after.rect);
+    }
+  }
+
+  widgets = next.widgets;
+  return sameShape;
+}
+
+void WidgetTree::addDamage(const DisplayRect& rect) {
+  if (rect.width <= 0 || rect.height <= 0) return;
+  // 同じ矩形（位置の変わらないラベルの書き換え）は1つにまとめる
+  for (const DisplayRect& r : damage) {
+    if (r.x == rect.x && r.y == rect.y && r.width == rect.width && r.height == rect.height) return;
+  }
+  damage.push_back(rect);
+}
+
+int WidgetTree::size() const {
+  return widgets.size();
+}
+
+const Widget& WidgetTree::get(int id) const {
+  return widgets[id];
+}
+
+const std::vector<DisplayRect>& WidgetTree::getDamage() const {
+  return damage;
+}
+
+void WidgetTree::clearDamage() {
+  damage.clear();
+}
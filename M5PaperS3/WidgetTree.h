@@ -0,0 +1,65 @@
+#ifndef WIDGETTREE_H
+#define WIDGETTREE_H
+
+#include "Config.h"
+#include "IconIds.h"
+#include <vector>
+
+enum WidgetType {
+  WIDGET_LIST,          // 子を縦に並べる入れ物（描画なし）
+  WIDGET_LABEL,
+  WIDGET_BUTTON,
+  WIDGET_BATTERY_ICON
+};
+
+struct Widget {
+  WidgetType type;
+  int parent;           // 親のリスト（-1 = 画面直下）
+  DisplayRect spec;     // 画面直下なら画面座標、リストの子なら行内の位置（width/height 0 = リストの幅/行の高さ）
+  DisplayRect rect;     // レイアウト結果（画面座標）
+  int pitch;            // リスト: 行の間隔
+  int fontSize;
+  bool centered;
+  String text;
+  int value;            // バッテリーアイコン: 残量
+  HitTarget target;     // ボタン: 押したときの操作
+  int index;            // ボタン: 操作の対象（アプリ選択ならアプリの番号）
+  IconId icon;          // ボタン: 文字の横に置くアイコン（ICON_NONE = なし）
+  bool iconAfterText;   // ボタン: アイコンを文字の後ろに置く（「Next ▶」など）
+};
+
+// 設定・バッテリー・About・アプリ選択画面の保持型ウィジェットツリー
+// 画面は状態から毎回同じ手順で組み立て、前回のツリーと比べて変わったウィジェットの矩形だけを
+// 描き直し対象（damage）にする。タッチの当たり判定も同じツリーから作るので、描画と入力がずれない
+class WidgetTree {
+private:
+  std::vector<Widget> widgets;
+  std::vector<DisplayRect> damage;
+
+  int add(WidgetType type, int parent, const DisplayRect& spec);
+  void addDamage(const DisplayRect& rect);
+  static bool sameContent(const Widget& a, const Widget& b);
+
+public:
+  void clear();
+
+  int addList(const DisplayRect& rect, int pitch);
+  int addLabel(int parent, const DisplayRect& spec, const String& text, int fontSize, bool centered = false);
+  int addButton(int parent, const DisplayRect& spec, const String& text, HitTarget target, int index = -1,
+                IconId icon = ICON_NONE, bool iconAfterText = false);
+  int addBatteryIcon(int parent, const DisplayRect& spec, int percentage);
+
+  // リストの子の位置を決める（親は子より先に追加されているので前から1回なめるだけ）
+  void layout();
+
+  // 組み立て直したツリーに差し替え、内容か位置が変わったウィジェットの矩形を damage に積む
+  // 構造（数・種類・親子）が変わったら false を返す（画面全体を描き直す）
+  bool update(const WidgetTree& next);
+
+  int size() const;
+  const Widget& get(int id) const;
+  const std::vector<DisplayRect>& getDamage() const;
+  void clearDamage();
+};
+
+#endif // WIDGETTREE_H
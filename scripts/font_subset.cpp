@@ -0,0 +1,395 @@
+// font_subset.cpp
+//
+// Builds the M5PaperS3 flash-resident subset font (M5PaperS3/FontSubsetData.h)
+// from a TTF/OTF. Only the codepoints that appear in the shortcut catalogs are
+// rasterised, at every FONT_SIZE_* in M5PaperS3/Config.h, so the device can skip
+// loading a full CJK font at boot and look glyphs up with two array reads.
+//
+// Build:
+//   g++ -std=c++17 -O2 scripts/font_subset.cpp $(pkg-config --cflags --libs freetype2) -o font_subset
+//
+// Usage (from the repository root):
+//   ./font_subset --font NotoSansJP-Regular.ttf
+//   ./font_subset --font NotoSansJP-Regular.ttf --out /tmp/FontSubsetData.h extra.json
+//
+// Exit codes:
+//   0: OK
+//   1: Some codepoints are missing from the font (output is still written)
+//   2: Invalid inputs or unexpected error
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// String values of these keys are rendered on the Paper
+static const char* TEXT_KEYS[] = { "action", "description", "groupName", "appName" };
+
+struct Options {
+  std::string font;
+  std::string root = ".";
+  std::string config = "M5PaperS3/Config.h";
+  std::string out = "M5PaperS3/FontSubsetData.h";
+  std::vector<std::string> extraJson;
+};
+
+struct GlyphOut {
+  uint32_t offset = 0;
+  int advance = 0;
+  int offsetX = 0;
+  int offsetY = 0;
+  int width = 0;
+  int height = 0;
+};
+
+static bool readFile(const std::string& path, std::string& out) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) return false;
+  std::stringstream ss;
+  ss << in.rdbuf();
+  out = ss.str();
+  return true;
+}
+
+static void appendUtf8(std::string& out, uint32_t cp) {
+  if (cp < 0x80) {
+    out += (char)cp;
+  } else if (cp < 0x800) {
+    out += (char)(0xC0 | (cp >> 6));
+    out += (char)(0x80 | (cp & 0x3F));
+  } else if (cp < 0x10000) {
+    out += (char)(0xE0 | (cp >> 12));
+    out += (char)(0x80 | ((cp >> 6) & 0x3F));
+    out += (char)(0x80 | (cp & 0x3F));
+  } else {
+    out += (char)(0xF0 | (cp >> 18));
+    out += (char)(0x80 | ((cp >> 12) & 0x3F));
+    out += (char)(0x80 | ((cp >> 6) & 0x3F));
+    out += (char)(0x80 | (cp & 0x3F));
+  }
+}
+
+static void decodeUtf8(const std::string& s, std::set<uint32_t>& out) {
+  for (size_t i = 0; i < s.size();) {
+    uint8_t c = (uint8_t)s[i];
+    uint32_t cp;
+    int extra;
+    if (c < 0x80) { cp = c; extra = 0; }
+    else if ((c & 0xE0) == 0xC0) { cp = c & 0x1F; extra = 1; }
+    else if ((c & 0xF0) == 0xE0) { cp = c & 0x0F; extra = 2; }
+    else if ((c & 0xF8) == 0xF0) { cp = c & 0x07; extra = 3; }
+    else { i++; continue; }
+    if (i + extra >= s.size()) break;
+    for (int k = 1; k <= extra; k++) cp = (cp << 6) | ((uint8_t)s[i + k] & 0x3F);
+    i += extra + 1;
+    if (cp >= 0x20) out.insert(cp);
+  }
+}
+
+// Minimal JSON scanner: we only need "key": "string" pairs, wherever they are
+static bool parseJsonString(const std::string& s, size_t& i, std::string& out) {
+  out.clear();
+  i++;  // opening quote
+  while (i < s.size()) {
+    char c = s[i++];
+    if (c == '"') return true;
+    if (c != '\\') {
+      out += c;
+      continue;
+    }
+    if (i >= s.size()) return false;
+    char e = s[i++];
+    switch (e) {
+      case 'n': out += '\n'; break;
+      case 't': out += '\t'; break;
+      case 'r': out += '\r'; break;
+      case 'b': out += '\b'; break;
+      case 'f': out += '\f'; break;
+      case 'u': {
+        if (i + 4 > s.size()) return false;
+        uint32_t cp = std::stoul(s.substr(i, 4), nullptr, 16);
+        i += 4;
+        if (cp >= 0xD800 && cp < 0xDC00 && i + 6 <= s.size() && s[i] == '\\' && s[i + 1] == 'u') {
+          uint32_t low = std::stoul(s.substr(i + 2, 4), nullptr, 16);
+          cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+          i += 6;
+        }
+        appendUtf8(out, cp);
+        break;
+      }
+      default: out += e; break;
+    }
+  }
+  return false;
+}
+
+static bool collectStrings(const std::string& path, std::set<uint32_t>& codepoints, int& strings) {
+  std::string json;
+  if (!readFile(path, json)) return false;
+
+  std::string token, key;
+  bool expectValue = false;
+  for (size_t i = 0; i < json.size();) {
+    char c = json[i];
+    if (c == '"') {
+      if (!parseJsonString(json, i, token)) return false;
+      if (expectValue) {
+        for (const char* k : TEXT_KEYS) {
+          if (key == k) {
+            decodeUtf8(token, codepoints);
+            strings++;
+          }
+        }
+        expectValue = false;
+      } else {
+        // A string followed by ':' is a key
+        size_t j = i;
+        while (j < json.size() && isspace((unsigned char)json[j])) j++;
+        if (j < json.size() && json[j] == ':') {
+          key = token;
+          expectValue = true;
+          i = j + 1;
+        }
+      }
+      continue;
+    }
+    if (c == ',' || c == '{' || c == '[' || c == '}' || c == ']') expectValue = false;
+    i++;
+  }
+  return true;
+}
+
+static std::vector<std::pair<std::string, int>> readFontSizes(const std::string& path) {
+  std::vector<std::pair<std::string, int>> sizes;
+  std::string header;
+  if (!readFile(path, header)) return sizes;
+  std::regex re(R"(#define\s+(FONT_SIZE_\w+)\s+(\d+))");
+  for (std::sregex_iterator it(header.begin(), header.end(), re), end; it != end; ++it) {
+    sizes.push_back({ (*it)[1].str(), std::stoi((*it)[2].str()) });
+  }
+  return sizes;
+}
+
+static void writeBytes(std::ostream& out, const std::vector<uint8_t>& bytes) {
+  for (size_t i = 0; i < bytes.size(); i++) {
+    if (i % 16 == 0) out << "  ";
+    char buf[8];
+    snprintf(buf, sizeof(buf), "0x%02X,", bytes[i]);
+    out << buf << ((i % 16 == 15 || i + 1 == bytes.size()) ? "\n" : " ");
+  }
+}
+
+static void usage() {
+  fprintf(stderr,
+    "usage: font_subset --font FILE [--root DIR] [--config Config.h] [--out FontSubsetData.h] [extra.json ...]\n");
+}
+
+int main(int argc, char** argv) {
+  Options opt;
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    auto next = [&](std::string& dst) {
+      if (i + 1 >= argc) return false;
+      dst = argv[++i];
+      return true;
+    };
+    bool ok = true;
+    if (a == "--font") ok = next(opt.font);
+    else if (a == "--root") ok = next(opt.root);
+    else if (a == "--config") ok = next(opt.config);
+    else if (a == "--out") ok = next(opt.out);
+    else if (a == "-h" || a == "--help") { usage(); return 0; }
+    else if (!a.empty() && a[0] == '-') ok = false;
+    else opt.extraJson.push_back(a);
+    if (!ok) { usage(); return 2; }
+  }
+  if (opt.font.empty()) { usage(); return 2; }
+
+  fs::path root(opt.root);
+
+  // Catalogs: config/shortcutJsons*/*.json and the Paper's built-in data
+  std::vector<std::string> inputs;
+  try {
+    for (const auto& dir : fs::directory_iterator(root / "config")) {
+      if (!dir.is_directory() || dir.path().filename().string().rfind("shortcutJsons", 0) != 0) continue;
+      for (const auto& f : fs::directory_iterator(dir.path())) {
+        if (f.path().extension() == ".json") inputs.push_back(f.path().string());
+      }
+    }
+  } catch (const std::exception& e) {
+    fprintf(stderr, "error: %s\n", e.what());
+    return 2;
+  }
+  inputs.push_back((root / "M5PaperS3/data/shortcuts.json").string());
+  for (const auto& extra : opt.extraJson) inputs.push_back(extra);
+  std::sort(inputs.begin(), inputs.end());
+
+  // Printable ASCII is always present (key names, settings and status labels)
+  std::set<uint32_t> codepoints;
+  for (uint32_t cp = 0x20; cp < 0x7F; cp++) codepoints.insert(cp);
+
+  int strings = 0;
+  for (const auto& path : inputs) {
+    if (!collectStrings(path, codepoints, strings)) {
+      fprintf(stderr, "error: cannot parse %s\n", path.c_str());
+      return 2;
+    }
+  }
+
+  auto sizes = readFontSizes((root / opt.config).string());
+  if (sizes.empty()) {
+    fprintf(stderr, "error: no FONT_SIZE_* in %s\n", opt.config.c_str());
+    return 2;
+  }
+
+  FT_Library ft;
+  FT_Face face;
+  if (FT_Init_FreeType(&ft) || FT_New_Face(ft, opt.font.c_str(), 0, &face)) {
+    fprintf(stderr, "error: cannot open font %s\n", opt.font.c_str());
+    return 2;
+  }
+
+  // Glyph numbers are shared by all sizes; the device only handles the BMP
+  std::vector<uint32_t> glyphs;
+  std::vector<uint32_t> missing;
+  for (uint32_t cp : codepoints) {
+    if (cp > 0xFFFF || FT_Get_Char_Index(face, cp) == 0) missing.push_back(cp);
+    else glyphs.push_back(cp);
+  }
+  if (glyphs.size() >= 0xFFFF) {
+    fprintf(stderr, "error: too many glyphs (%zu)\n", glyphs.size());
+    return 2;
+  }
+
+  // Two-level index: high byte -> block, low byte -> glyph number + 1
+  std::vector<uint16_t> blocks(256, 0xFFFF);
+  std::vector<uint16_t> index;
+  for (size_t g = 0; g < glyphs.size(); g++) {
+    uint32_t hi = glyphs[g] >> 8;
+    if (blocks[hi] == 0xFFFF) {
+      blocks[hi] = (uint16_t)(index.size() / 256);
+      index.resize(index.size() + 256, 0);
+    }
+    index[blocks[hi] * 256 + (glyphs[g] & 0xFF)] = (uint16_t)(g + 1);
+  }
+
+  std::vector<std::vector<GlyphOut>> metrics(sizes.size());
+  std::vector<std::vector<uint8_t>> bitmaps(sizes.size());
+  for (size_t s = 0; s < sizes.size(); s++) {
+    FT_Set_Pixel_Sizes(face, 0, sizes[s].second);
+    int ascender = (int)(face->size->metrics.ascender >> 6);
+
+    for (uint32_t cp : glyphs) {
+      GlyphOut g;
+      g.offset = (uint32_t)bitmaps[s].size();
+      if (FT_Load_Char(face, cp, FT_LOAD_RENDER | FT_LOAD_TARGET_NORMAL) == 0) {
+        FT_GlyphSlot slot = face->glyph;
+        const FT_Bitmap& bm = slot->bitmap;
+        g.advance = std::min(255, (int)((slot->advance.x + 32) >> 6));
+        g.offsetX = std::clamp(slot->bitmap_left, -128, 127);
+        g.offsetY = std::clamp(ascender - slot->bitmap_top, -128, 127);
+        g.width = std::min(255, (int)bm.width);
+        g.height = std::min(255, (int)bm.rows);
+
+        // 8-bit coverage -> 4bpp, two pixels per byte, high nibble first
+        std::vector<uint8_t> packed((g.width * g.height + 1) / 2, 0);
+        for (int y = 0; y < g.height; y++) {
+          for (int x = 0; x < g.width; x++) {
+            uint8_t v = bm.buffer[y * bm.pitch + x];
+            uint8_t coverage = (uint8_t)((v * 15 + 127) / 255);
+            int i = y * g.width + x;
+            packed[i >> 1] |= (i & 1) ? coverage : (uint8_t)(coverage << 4);
+          }
+        }
+        bitmaps[s].insert(bitmaps[s].end(), packed.begin(), packed.end());
+      }
+      metrics[s].push_back(g);
+    }
+  }
+
+  std::ofstream out(opt.out);
+  if (!out) {
+    fprintf(stderr, "error: cannot write %s\n", opt.out.c_str());
+    return 2;
+  }
+
+  out << "// Generated by scripts/font_subset.cpp - do not edit\n";
+  out << "// font: " << fs::path(opt.font).filename().string() << ", " << glyphs.size() << " glyphs, "
+      << strings << " strings from " << inputs.size() << " files\n";
+  out << "#ifndef FONTSUBSETDATA_H\n#define FONTSUBSETDATA_H\n\n#include \"SubsetFont.h\"\n\n";
+  out << "#define FONT_SUBSET_GLYPH_COUNT " << glyphs.size() << "\n";
+  out << "#define FONT_SUBSET_SIZE_COUNT " << sizes.size() << "\n\n";
+
+  out << "static const uint16_t FONT_SUBSET_BLOCKS[256] = {\n";
+  for (int i = 0; i < 256; i++) {
+    if (i % 16 == 0) out << "  ";
+    char buf[12];
+    snprintf(buf, sizeof(buf), "0x%04X,", blocks[i]);
+    out << buf << (i % 16 == 15 ? "\n" : " ");
+  }
+  out << "};\n\n";
+
+  out << "static const uint16_t FONT_SUBSET_INDEX[" << index.size() << "] = {\n";
+  for (size_t i = 0; i < index.size(); i++) {
+    if (i % 16 == 0) out << "  ";
+    out << index[i] << "," << ((i % 16 == 15) ? "\n" : " ");
+  }
+  out << "};\n\n";
+
+  for (size_t s = 0; s < sizes.size(); s++) {
+    int px = sizes[s].second;
+    out << "// " << sizes[s].first << "\n";
+    out << "static const SubsetGlyph FONT_SUBSET_GLYPHS_" << px << "[" << glyphs.size() << "] = {\n";
+    for (size_t g = 0; g < glyphs.size(); g++) {
+      const GlyphOut& m = metrics[s][g];
+      std::string ch;
+      appendUtf8(ch, glyphs[g]);
+      if (ch == "\\") ch = "backslash";
+      char buf[96];
+      snprintf(buf, sizeof(buf), "  { %u, %d, %d, %d, %d, %d },  // U+%04X %s\n",
+               m.offset, m.advance, m.offsetX, m.offsetY, m.width, m.height, glyphs[g], ch.c_str());
+      out << buf;
+    }
+    out << "};\n\n";
+    out << "static const uint8_t FONT_SUBSET_BITMAP_" << px << "[" << std::max<size_t>(bitmaps[s].size(), 1) << "] = {\n";
+    writeBytes(out, bitmaps[s].empty() ? std::vector<uint8_t>{ 0 } : bitmaps[s]);
+    out << "};\n\n";
+  }
+
+  out << "static const SubsetFontSize FONT_SUBSET_SIZES[FONT_SUBSET_SIZE_COUNT] = {\n";
+  for (const auto& size : sizes) {
+    out << "  { " << size.second << ", FONT_SUBSET_GLYPHS_" << size.second << ", FONT_SUBSET_BITMAP_" << size.second << " },\n";
+  }
+  out << "};\n\n#endif // FONTSUBSETDATA_H\n";
+  out.close();
+
+  size_t flashBytes = blocks.size() * 2 + index.size() * 2;
+  for (size_t s = 0; s < sizes.size(); s++) flashBytes += glyphs.size() * 12 + bitmaps[s].size();
+  printf("%zu glyphs x %zu sizes from %d strings, ~%zu KB flash -> %s\n",
+         glyphs.size(), sizes.size(), strings, flashBytes / 1024, opt.out.c_str());
+
+  if (!missing.empty()) {
+    std::string list;
+    for (size_t i = 0; i < missing.size() && i < 20; i++) {
+      char buf[12];
+      snprintf(buf, sizeof(buf), " U+%04X", missing[i]);
+      list += buf;
+    }
+    fprintf(stderr, "warning: %zu codepoints not in font:%s%s\n", missing.size(), list.c_str(),
+            missing.size() > 20 ? " ..." : "");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,371 @@
+// frame_diff_test.cpp
+//
+// Host checks for M5PaperS3/FrameDiff: known frames with the rects diff() must
+// return (tile merge, the over-limit merge, clip edges, chunks that cross a row,
+// the unaligned frame tail), commit() behaviour, and a brute-force reference
+// comparison on random frames. FrameDiff::selfCheck() is run too; on the device
+// the same check exercises the PIE path at boot (the host always builds the
+// scalar path, so PIE vs scalar agreement is only checked on the ESP32-S3).
+//
+// Build (AddressSanitizer catches reads past the end of the frame):
+//   g++ -std=c++17 -O1 -g -fsanitize=address,undefined -IM5PaperS3 scripts/frame_diff_test.cpp M5PaperS3/FrameDiff.cpp -o frame_diff_test
+//
+// Usage:
+//   ./frame_diff_test
+//
+// Exit codes:
+//   0: OK
+//   1: A check failed
+
+#include "FrameDiff.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                    \
+  do {                                                      \
+    if (!(cond)) {                                          \
+      failures++;                                           \
+      std::fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+      std::fprintf(stderr, __VA_ARGS__);                    \
+      std::fprintf(stderr, "\n");                           \
+    }                                                       \
+  } while (0)
+
+// A 4bpp frame laid out like an M5EPD canvas (stride = width / 2, high nibble =
+// left pixel). The pixels sit in their own heap block, optionally shifted off
+// the 16-byte boundary, so AddressSanitizer flags any read past the last byte.
+struct Frame {
+  int width;
+  int height;
+  std::vector<uint8_t> storage;
+  uint8_t* data;
+
+  Frame(int w, int h, int misalign = 0) : width(w), height(h), storage((size_t)(w / 2) * h + misalign) {
+    data = storage.data() + misalign;
+    std::memset(data, 0xFF, bytes());
+  }
+
+  size_t bytes() const { return (size_t)(width / 2) * height; }
+
+  uint8_t get(int x, int y) const {
+    uint8_t b = data[y * (width / 2) + x / 2];
+    return (x & 1) ? (b & 0x0F) : (b >> 4);
+  }
+
+  void set(int x, int y, uint8_t v) {
+    uint8_t& b = data[y * (width / 2) + x / 2];
+    b = (x & 1) ? (uint8_t)((b & 0xF0) | (v & 0x0F)) : (uint8_t)((b & 0x0F) | (v << 4));
+  }
+
+  void flip(int x, int y) { set(x, y, get(x, y) ^ 0x0F); }
+};
+
+static bool sameRect(const DiffRect& a, const DiffRect& b) {
+  return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+static bool contains(const DiffRect& r, int x, int y) {
+  return x >= r.x && x < r.x + r.width && y >= r.y && y < r.y + r.height;
+}
+
+static bool covered(const DiffRect* rects, int count, int x, int y) {
+  for (int i = 0; i < count; i++) {
+    if (contains(rects[i], x, y)) return true;
+  }
+  return false;
+}
+
+// Checks that diff() returns exactly the expected rects (in any order).
+static void expectRects(const char* name, const DiffRect* got, int count, std::initializer_list<DiffRect> expected) {
+  CHECK(count == (int)expected.size(), "%s: %d rects, expected %zu", name, count, expected.size());
+  for (const DiffRect& e : expected) {
+    bool found = false;
+    for (int i = 0; i < count; i++) {
+      if (sameRect(got[i], e)) found = true;
+    }
+    CHECK(found, "%s: missing rect %d,%d %dx%d", name, e.x, e.y, e.width, e.height);
+  }
+}
+
+static void testUnchanged() {
+  Frame frame(540, 60);
+  FrameDiff fd;
+  CHECK(fd.begin(frame.width, frame.height), "begin");
+  fd.commitAll(frame.data);
+
+  DiffRect out[FRAME_DIFF_MAX_RECTS];
+  int count = fd.diff(frame.data, { 0, 0, 540, 60 }, out, FRAME_DIFF_MAX_RECTS);
+  expectRects("unchanged", out, count, {});
+}
+
+static void testSinglePixels() {
+  Frame frame(540, 60);
+  FrameDiff fd;
+  fd.begin(frame.width, frame.height);
+  fd.commitAll(frame.data);
+  DiffRect out[FRAME_DIFF_MAX_RECTS];
+
+  frame.flip(0, 0);
+  int count = fd.diff(frame.data, { 0, 0, 540, 60 }, out, FRAME_DIFF_MAX_RECTS);
+  expectRects("first pixel", out, count, { { 0, 0, 32, 16 } });
+  fd.commitAll(frame.data);
+
+  // The right edge of the last tile is clipped to the frame (540 = 16 * 32 + 28)
+  frame.flip(539, 59);
+  count = fd.diff(frame.data, { 0, 0, 540, 60 }, out, FRAME_DIFF_MAX_RECTS);
+  expectRects("last pixel", out, count, { { 512, 48, 28, 12 } });
+}
+
+static void testRowCrossingChunk() {
+  // Bytes 269 and 270 (end of row 0, start of row 1) share the 16-byte chunk
+  // 256..271; only the two tiles that really changed may be marked
+  Frame frame(540, 60);
+  FrameDiff fd;
+  fd.begin(frame.width, frame.height);
+  fd.commitAll(frame.data);
+
+  frame.flip(539, 0);
+  frame.flip(0, 1);
+  DiffRect out[FRAME_DIFF_MAX_RECTS];
+  int count = fd.diff(frame.data, { 0, 0, 540, 60 }, out, FRAME_DIFF_MAX_RECTS);
+  expectRects("row crossing", out, count, { { 0, 0, 32, 16 }, { 512, 0, 28, 16 } });
+}
+
+static void testMergeTiles() {
+  Frame frame(540, 60);
+  FrameDiff fd;
+  fd.begin(frame.width, frame.height);
+  fd.commitAll(frame.data);
+  DiffRect out[FRAME_DIFF_MAX_RECTS];
+
+  // Adjacent tiles in a row join into one span
+  frame.flip(5, 3);
+  frame.flip(40, 3);
+  frame.flip(95, 15);
+  int count = fd.diff(frame.data, { 0, 0, 540, 60 }, out, FRAME_DIFF_MAX_RECTS);
+  expectRects("horizontal", out, count, { { 0, 0, 96, 16 } });
+  fd.commitAll(frame.data);
+
+  // The same span on consecutive tile rows grows downward
+  frame.flip(40, 0);
+  frame.flip(41, 20);
+  frame.flip(50, 35);
+  frame.flip(63, 59);
+  count = fd.diff(frame.data, { 0, 0, 540, 60 }, out, FRAME_DIFF_MAX_RECTS);
+  expectRects("vertical", out, count, { { 32, 0, 32, 60 } });
+  fd.commitAll(frame.data);
+
+  // Different widths stay separate
+  frame.flip(40, 0);
+  frame.flip(40, 16);
+  frame.flip(72, 16);
+  count = fd.diff(frame.data, { 0, 0, 540, 60 }, out, FRAME_DIFF_MAX_RECTS);
+  expectRects("widths", out, count, { { 32, 0, 32, 16 }, { 32, 16, 64, 16 } });
+}
+
+static void testOverLimit() {
+  // Nine separate spans with room for eight: every change must still be covered
+  // by the merged rects, and the rects stay inside the frame
+  Frame frame(540, 60);
+  FrameDiff fd;
+  fd.begin(frame.width, frame.height);
+  fd.commitAll(frame.data);
+
+  std::vector<std::pair<int, int>> changed;
+  for (int c = 0; c < 17; c += 2) changed.push_back({ c * 32 + 7, 2 });
+  for (auto& p : changed) frame.flip(p.first, p.second);
+
+  DiffRect out[FRAME_DIFF_MAX_RECTS];
+  int count = fd.diff(frame.data, { 0, 0, 540, 60 }, out, FRAME_DIFF_MAX_RECTS);
+  CHECK(count == FRAME_DIFF_MAX_RECTS, "over limit: %d rects", count);
+  for (auto& p : changed) {
+    CHECK(covered(out, count, p.first, p.second), "over limit: %d,%d not covered", p.first, p.second);
+  }
+  for (int i = 0; i < count; i++) {
+    CHECK(out[i].x >= 0 && out[i].y >= 0 && out[i].x + out[i].width <= 540 && out[i].y + out[i].height <= 60,
+          "over limit: rect %d,%d %dx%d outside the frame", out[i].x, out[i].y, out[i].width, out[i].height);
+  }
+
+  // With a tighter limit, spans on several rows fold into the given number of rects
+  Frame grid(540, 60);
+  FrameDiff gd;
+  gd.begin(grid.width, grid.height);
+  gd.commitAll(grid.data);
+  changed.clear();
+  for (int row = 0; row < 4; row++) {
+    for (int c = row % 2; c < 17; c += 3) changed.push_back({ c * 32 + 1, row * 16 + (row < 3 ? 5 : 11) });
+  }
+  for (auto& p : changed) grid.flip(p.first, p.second);
+
+  DiffRect small[2];
+  count = gd.diff(grid.data, { 0, 0, 540, 60 }, small, 2);
+  CHECK(count >= 1 && count <= 2, "limit 2: %d rects", count);
+  for (auto& p : changed) {
+    CHECK(covered(small, count, p.first, p.second), "limit 2: %d,%d not covered", p.first, p.second);
+  }
+}
+
+static void testClip() {
+  Frame frame(540, 60);
+  FrameDiff fd;
+  fd.begin(frame.width, frame.height);
+  fd.commitAll(frame.data);
+  DiffRect out[FRAME_DIFF_MAX_RECTS];
+
+  frame.flip(35, 20);
+
+  // Rects are cut to the (4px aligned) clip
+  int count = fd.diff(frame.data, { 36, 0, 100, 60 }, out, FRAME_DIFF_MAX_RECTS);
+  expectRects("clip left edge", out, count, { { 36, 16, 28, 16 } });
+  count = fd.diff(frame.data, { 0, 18, 48, 4 }, out, FRAME_DIFF_MAX_RECTS);
+  expectRects("clip rows", out, count, { { 32, 18, 16, 4 } });
+
+  // A change outside the clip's tile columns / rows is not reported
+  count = fd.diff(frame.data, { 0, 0, 32, 60 }, out, FRAME_DIFF_MAX_RECTS);
+  expectRects("clip columns", out, count, {});
+  count = fd.diff(frame.data, { 0, 32, 540, 28 }, out, FRAME_DIFF_MAX_RECTS);
+  expectRects("clip below", out, count, {});
+
+  // Clips reaching past the frame are cut to the frame
+  frame.flip(538, 58);
+  count = fd.diff(frame.data, { 500, 40, 100, 100 }, out, FRAME_DIFF_MAX_RECTS);
+  expectRects("clip past frame", out, count, { { 512, 48, 28, 12 } });
+  count = fd.diff(frame.data, { 600, 0, 40, 60 }, out, FRAME_DIFF_MAX_RECTS);
+  expectRects("clip outside", out, count, {});
+}
+
+static void testCommit() {
+  Frame frame(540, 60);
+  FrameDiff fd;
+  fd.begin(frame.width, frame.height);
+  fd.commitAll(frame.data);
+  DiffRect out[FRAME_DIFF_MAX_RECTS];
+
+  frame.flip(10, 10);
+  frame.flip(300, 40);
+  int count = fd.diff(frame.data, { 0, 0, 540, 60 }, out, FRAME_DIFF_MAX_RECTS);
+  expectRects("before commit", out, count, { { 0, 0, 32, 16 }, { 288, 32, 32, 16 } });
+
+  // Committing one rect leaves only the other one
+  fd.commit(frame.data, { 0, 0, 32, 16 });
+  count = fd.diff(frame.data, { 0, 0, 540, 60 }, out, FRAME_DIFF_MAX_RECTS);
+  expectRects("partial commit", out, count, { { 288, 32, 32, 16 } });
+
+  fd.commit(frame.data, out[0]);
+  count = fd.diff(frame.data, { 0, 0, 540, 60 }, out, FRAME_DIFF_MAX_RECTS);
+  expectRects("after commit", out, count, {});
+}
+
+static void testUnalignedTail() {
+  // The 540x60 header strip is 16200 bytes, not a multiple of 16: a change in the
+  // last bytes must be found from any canvas alignment without reading past the
+  // end of the frame (AddressSanitizer reports it if it does)
+  for (int misalign = 0; misalign < 16; misalign++) {
+    Frame frame(540, 60, misalign);
+    FrameDiff fd;
+    fd.begin(frame.width, frame.height);
+    fd.commitAll(frame.data);
+    DiffRect out[FRAME_DIFF_MAX_RECTS];
+
+    int count = fd.diff(frame.data, { 0, 0, 540, 60 }, out, FRAME_DIFF_MAX_RECTS);
+    CHECK(count == 0, "tail misalign %d: %d rects on an unchanged frame", misalign, count);
+
+    frame.flip(531, 59);
+    count = fd.diff(frame.data, { 0, 0, 540, 60 }, out, FRAME_DIFF_MAX_RECTS);
+    CHECK(count == 1 && sameRect(out[0], { 512, 48, 28, 12 }), "tail misalign %d: last tile not found", misalign);
+  }
+}
+
+static void testReference() {
+  // Random frames against a brute-force pixel comparison: every changed pixel in
+  // the clip is covered, nothing outside the clip is reported, every reported
+  // tile really changed, and a full-frame clip returns exactly the changed tiles
+  std::mt19937 rng(20240611);
+  const int sizes[][2] = { { 540, 60 }, { 540, 96 }, { 100, 40 }, { 36, 5 } };
+
+  for (int iteration = 0; iteration < 400; iteration++) {
+    int w = sizes[iteration % 4][0];
+    int h = sizes[iteration % 4][1];
+    Frame before(w, h, iteration % 16);
+    for (size_t i = 0; i < before.bytes(); i++) before.data[i] = (uint8_t)rng();
+    Frame after(w, h, (iteration * 7) % 16);
+    std::memcpy(after.data, before.data, before.bytes());
+    int changes = rng() % 12;
+    for (int i = 0; i < changes; i++) {
+      int x = rng() % w;
+      int y = rng() % h;
+      after.flip(x, y);
+    }
+
+    bool fullClip = iteration % 3 == 0;
+    DiffRect clip = { 0, 0, w, h };
+    if (!fullClip) {
+      clip.x = (int)(rng() % w) & ~3;
+      clip.y = rng() % h;
+      clip.width = (((int)(rng() % (w - clip.x)) + 4) & ~3);
+      clip.height = 1 + rng() % (h - clip.y);
+    }
+
+    FrameDiff fd;
+    fd.begin(w, h);
+    fd.commitAll(before.data);
+    DiffRect out[64];
+    int count = fd.diff(after.data, clip, out, 64);
+
+    int tileCols = (w + FRAME_DIFF_TILE_WIDTH - 1) / FRAME_DIFF_TILE_WIDTH;
+    int tileRows = (h + FRAME_DIFF_TILE_HEIGHT - 1) / FRAME_DIFF_TILE_HEIGHT;
+    std::vector<bool> tileChanged(tileCols * tileRows, false);
+    for (int y = 0; y < h; y++) {
+      for (int x = 0; x < w; x++) {
+        if (before.get(x, y) != after.get(x, y)) {
+          tileChanged[(y / FRAME_DIFF_TILE_HEIGHT) * tileCols + x / FRAME_DIFF_TILE_WIDTH] = true;
+        }
+      }
+    }
+
+    for (int y = 0; y < h; y++) {
+      for (int x = 0; x < w; x++) {
+        bool inClip = contains(clip, x, y);
+        bool isCovered = covered(out, count, x, y);
+        bool tile = tileChanged[(y / FRAME_DIFF_TILE_HEIGHT) * tileCols + x / FRAME_DIFF_TILE_WIDTH];
+        if (inClip && before.get(x, y) != after.get(x, y)) {
+          CHECK(isCovered, "reference %d: changed pixel %d,%d not covered", iteration, x, y);
+        }
+        if (isCovered) {
+          CHECK(inClip, "reference %d: pixel %d,%d outside the clip", iteration, x, y);
+          CHECK(tile, "reference %d: unchanged tile at %d,%d reported", iteration, x, y);
+        }
+        if (fullClip && tile) {
+          CHECK(isCovered, "reference %d: changed tile at %d,%d not reported", iteration, x, y);
+        }
+      }
+    }
+    if (failures > 20) return;
+  }
+}
+
+int main() {
+  testUnchanged();
+  testSinglePixels();
+  testRowCrossingChunk();
+  testMergeTiles();
+  testOverLimit();
+  testClip();
+  testCommit();
+  testUnalignedTail();
+  testReference();
+  CHECK(FrameDiff::selfCheck(), "FrameDiff::selfCheck() failed");
+
+  if (failures) {
+    std::fprintf(stderr, "%d check(s) failed\n", failures);
+    return 1;
+  }
+  std::printf("frame_diff_test: OK\n");
+  return 0;
+}
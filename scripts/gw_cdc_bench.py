@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+"""
+gw_cdc_bench.py
+
+Drives the KeyboardGW over its CDC control channel (USE_USB_CDC=1) from a
+Linux host: fetch telemetry, stream logs, measure channel RTT and measure
+end-to-end keystroke latency/throughput by watching the GW's HID keyboard
+through evdev. No phone and no BLE radio in the loop.
+
+Usage:
+  python3 scripts/gw_cdc_bench.py --port /dev/ttyACM0 stats
+  python3 scripts/gw_cdc_bench.py --port /dev/ttyACM0 logs
+  python3 scripts/gw_cdc_bench.py --port /dev/ttyACM0 ping --count 200
+  python3 scripts/gw_cdc_bench.py --port /dev/ttyACM0 power
+  python3 scripts/gw_cdc_bench.py --port /dev/ttyACM0 idle --seconds 60
+  python3 scripts/gw_cdc_bench.py --port /dev/ttyACM0 bench --count 500 \
+      --evdev /dev/input/by-id/usb-NW-Lab_EasyShortcutKey_GW_ESPKGW-0001-event-kbd
+
+Exit codes:
+  0: OK
+  1: Timeout / missing replies
+  2: Invalid inputs or unexpected error
+"""
+
+from __future__ import annotations
+import argparse
+import json
+import statistics
+import struct
+import sys
+import time
+from typing import List, Optional, Tuple
+
+CDC_SYNC = 0xA5
+FRAME_KEY_DOWN = 0x81
+FRAME_KEY_UP = 0x82
+FRAME_RELEASE_ALL = 0x84
+FRAME_STATS_GET = 0x90
+FRAME_STATS_RESET = 0x91
+FRAME_LOG_STREAM = 0x92
+FRAME_PING = 0x93
+FRAME_IDLE_MEASURE = 0x94
+STATS_SECTION_POWER = 0x01
+
+USAGE_A = 0x04
+EV_KEY_A = 30  # linux/input-event-codes.h KEY_A
+
+
+def frame(payload: bytes) -> bytes:
+    if not 0 < len(payload) < 256:
+        raise ValueError("payload must be 1..255 bytes")
+    return bytes([CDC_SYNC, len(payload)]) + payload
+
+
+def read_message(port, timeout: float) -> Optional[Tuple[str, bytes]]:
+    """Read one GW -> host message: returns (type, data) or None on timeout."""
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        b = port.read(1)
+        if not b or b[0] != CDC_SYNC:
+            continue
+        n = port.read(1)
+        if not n:
+            return None
+        body = port.read(n[0])
+        if len(body) != n[0]:
+            return None
+        return chr(body[0]), body[1:]
+    return None
+
+
+def wait_for(port, kind: str, timeout: float = 1.0) -> Optional[bytes]:
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        msg = read_message(port, deadline - time.monotonic())
+        if msg is None:
+            return None
+        if msg[0] == kind:
+            return msg[1]
+        if msg[0] == "L":
+            print(f"[gw] {msg[1].decode(errors='replace')}")
+    return None
+
+
+def summarize(label: str, samples_us: List[float]) -> None:
+    samples_us = sorted(samples_us)
+    p = lambda q: samples_us[min(len(samples_us) - 1, int(q * len(samples_us)))]
+    print(f"{label}: n={len(samples_us)} min={samples_us[0]:.0f}us "
+          f"median={statistics.median(samples_us):.0f}us p95={p(0.95):.0f}us "
+          f"p99={p(0.99):.0f}us max={samples_us[-1]:.0f}us")
+
+
+def cmd_stats(port, args) -> int:
+    port.write(frame(bytes([FRAME_STATS_GET])))
+    data = wait_for(port, "T")
+    if data is None:
+        print("no STATS reply", file=sys.stderr)
+        return 1
+    print(json.dumps(json.loads(data), indent=2))
+    return 0
+
+
+def cmd_power(port, args) -> int:
+    port.write(frame(bytes([FRAME_STATS_GET, STATS_SECTION_POWER])))
+    data = wait_for(port, "T")
+    if data is None:
+        print("no STATS reply", file=sys.stderr)
+        return 1
+    print(json.dumps(json.loads(data), indent=2))
+    return 0
+
+
+def cmd_idle(port, args) -> int:
+    """Quiet the GW for an external current reading."""
+    port.write(frame(bytes([FRAME_IDLE_MEASURE, args.seconds])))
+    if wait_for(port, "S") is None:
+        print("no ack", file=sys.stderr)
+        return 1
+    print(f"GW idle for {args.seconds}s - read the meter now")
+    # Any traffic (including this script) would boost the CPU; just wait
+    time.sleep(args.seconds + 0.5)
+    return cmd_power(port, args)
+
+
+def cmd_logs(port, args) -> int:
+    port.write(frame(bytes([FRAME_LOG_STREAM, 1])))
+    try:
+        while True:
+            msg = read_message(port, 1.0)
+            if msg and msg[0] == "L":
+                print(msg[1].decode(errors="replace"))
+    except KeyboardInterrupt:
+        port.write(frame(bytes([FRAME_LOG_STREAM, 0])))
+    return 0
+
+
+def cmd_ping(port, args) -> int:
+    rtts = []
+    for seq in range(args.count):
+        t0 = time.perf_counter()
+        port.write(frame(bytes([FRAME_PING]) + struct.pack("<I", seq)))
+        data = wait_for(port, "P")
+        if data is None or struct.unpack("<I", data[:4])[0] != seq:
+            print(f"ping {seq}: no reply", file=sys.stderr)
+            return 1
+        rtts.append((time.perf_counter() - t0) * 1e6)
+    summarize("cdc rtt", rtts)
+    return 0
+
+
+def cmd_bench(port, args) -> int:
+    port.write(frame(bytes([FRAME_STATS_RESET])))
+    wait_for(port, "S")
+
+    kbd = None
+    if args.evdev:
+        import evdev  # pip install evdev
+        kbd = evdev.InputDevice(args.evdev)
+        kbd.grab()  # keep the test keystrokes away from the desktop
+
+    latencies = []
+    t_start = time.perf_counter()
+    try:
+        for _ in range(args.count):
+            for opcode, value in ((FRAME_KEY_DOWN, 1), (FRAME_KEY_UP, 0)):
+                t0 = time.perf_counter()
+                port.write(frame(bytes([opcode, USAGE_A])))
+                if kbd is None:
+                    continue
+                for ev in kbd.read_loop():
+                    if ev.type == evdev.ecodes.EV_KEY and ev.code == EV_KEY_A and ev.value == value:
+                        latencies.append((time.perf_counter() - t0) * 1e6)
+                        break
+    finally:
+        port.write(frame(bytes([FRAME_RELEASE_ALL])))
+        if kbd is not None:
+            kbd.ungrab()
+    elapsed = time.perf_counter() - t_start
+
+    print(f"{args.count} keystrokes in {elapsed:.3f}s = {args.count / elapsed:.1f} keys/s")
+    if latencies:
+        summarize("end-to-end", latencies)
+    return cmd_stats(port, args)
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--port", required=True, help="CDC device, e.g. /dev/ttyACM0")
+    sub = ap.add_subparsers(dest="cmd", required=True)
+    sub.add_parser("stats")
+    sub.add_parser("logs")
+    sub.add_parser("power")
+    i = sub.add_parser("idle")
+    i.add_argument("--seconds", type=int, default=30, choices=range(1, 256), metavar="1-255")
+    p = sub.add_parser("ping")
+    p.add_argument("--count", type=int, default=100)
+    b = sub.add_parser("bench")
+    b.add_argument("--count", type=int, default=200)
+    b.add_argument("--evdev", help="GW keyboard event device for end-to-end latency")
+    args = ap.parse_args()
+
+    try:
+        import serial  # pip install pyserial
+        with serial.Serial(args.port, 115200, timeout=0.2) as port:
+            port.dtr = True
+            return {"stats": cmd_stats, "power": cmd_power, "idle": cmd_idle, "logs": cmd_logs, "ping": cmd_ping, "bench": cmd_bench}[args.cmd](port, args)
+    except Exception as e:
+        print(f"error: {e}", file=sys.stderr)
+        return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main())
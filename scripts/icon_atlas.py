@@ -0,0 +1,214 @@
+#!/usr/bin/env python3
+"""
+icon_atlas.py
+
+Packs the M5PaperS3 icons (M5PaperS3/icons/*.txt) into a 4bpp atlas that lives
+in flash, so the header/footer icons are copied into the canvas instead of being
+drawn primitive by primitive or as emoji the built-in font cannot render.
+
+Writes two headers next to the sources:
+  IconIds.h        enum IconId (ICON_<NAME> in file name order, ICON_NONE = -1)
+  IconAtlasData.h  icon table, pixels and transparency masks (IconAtlas.cpp only)
+
+Icon format: one text row per pixel row, every row the same (even) width.
+  '#' black   '+' dark gray   '-' light gray (header background)
+  '0'-'9' 'a'-'f' any gray level (0 = black, f = white)   '.' transparent
+Lines starting with ';' are comments.
+
+Usage:
+  python3 scripts/icon_atlas.py
+  python3 scripts/icon_atlas.py --check
+  python3 scripts/icon_atlas.py --icons M5PaperS3/icons --out M5PaperS3
+
+Also runs as a PlatformIO pre-build script (extra_scripts in platformio.ini).
+
+Exit codes:
+  0: OK (or --check: headers are up to date)
+  1: --check: headers are stale
+  2: Invalid icon source or unexpected error
+"""
+
+from __future__ import annotations
+import argparse
+import sys
+from pathlib import Path
+from typing import Dict, List, Optional, Tuple
+
+ALIASES = {"#": 0, "+": 4, "-": 12}
+
+REPO_ROOT = Path(__file__).resolve().parent.parent if "__file__" in globals() else Path.cwd()
+
+
+class IconError(Exception):
+    pass
+
+
+def parse_icon(path: Path) -> Tuple[List[List[int]], Optional[List[List[bool]]]]:
+    """Returns (levels, mask). mask is None when the icon has no transparent pixel."""
+    rows = []
+    for line in path.read_text(encoding="utf-8").splitlines():
+        line = line.rstrip()
+        if not line or line.startswith(";"):
+            continue
+        rows.append(line)
+    if not rows:
+        raise IconError(f"{path}: empty icon")
+    width = len(rows[0])
+    if any(len(r) != width for r in rows):
+        raise IconError(f"{path}: rows must all be {width} px wide")
+    if width % 2:
+        raise IconError(f"{path}: width {width} must be even (2 px per byte)")
+    if width > 255 or len(rows) > 255:
+        raise IconError(f"{path}: icon too large ({width}x{len(rows)})")
+
+    levels: List[List[int]] = []
+    mask: List[List[bool]] = []
+    transparent = False
+    for y, row in enumerate(rows):
+        level_row, mask_row = [], []
+        for x, c in enumerate(row):
+            if c == ".":
+                level_row.append(15)
+                mask_row.append(False)
+                transparent = True
+            elif c in ALIASES:
+                level_row.append(ALIASES[c])
+                mask_row.append(True)
+            elif c in "0123456789abcdefABCDEF":
+                level_row.append(int(c, 16))
+                mask_row.append(True)
+            else:
+                raise IconError(f"{path}:{y + 1}: unknown pixel '{c}' at column {x + 1}")
+        levels.append(level_row)
+        mask.append(mask_row)
+    return levels, (mask if transparent else None)
+
+
+def pack_levels(levels: List[List[int]]) -> bytes:
+    # Same layout as the canvas: 2 px per byte, left pixel in the high nibble, rows padded to bytes
+    out = bytearray()
+    for row in levels:
+        for x in range(0, len(row), 2):
+            out.append((row[x] << 4) | row[x + 1])
+    return bytes(out)
+
+
+def pack_mask(mask: List[List[bool]]) -> bytes:
+    # 1 bit per px, MSB = leftmost, rows padded to bytes
+    out = bytearray()
+    for row in mask:
+        for x in range(0, len(row), 8):
+            byte = 0
+            for i, opaque in enumerate(row[x:x + 8]):
+                if opaque:
+                    byte |= 0x80 >> i
+            out.append(byte)
+    return bytes(out)
+
+
+def hex_lines(data: bytes) -> List[str]:
+    if not data:
+        data = b"\x00"
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("  " + " ".join(f"0x{b:02X}," for b in data[i:i + 16]))
+    return lines
+
+
+def build(icons_dir: Path) -> Dict[str, str]:
+    sources = sorted(icons_dir.glob("*.txt"))
+    if not sources:
+        raise IconError(f"no icons in {icons_dir}")
+    if len(sources) > 127:
+        raise IconError("too many icons (IconId is int8_t)")
+
+    pixels = bytearray()
+    masks = bytearray()
+    table = []
+    for path in sources:
+        levels, mask = parse_icon(path)
+        name = path.stem
+        if not name.replace("_", "").isalnum():
+            raise IconError(f"{path}: file name must be [A-Za-z0-9_]")
+        offset = len(pixels)
+        pixels += pack_levels(levels)
+        mask_offset = -1
+        if mask is not None:
+            mask_offset = len(masks)
+            masks += pack_mask(mask)
+        table.append((name, len(levels[0]), len(levels), offset, mask_offset))
+    if len(pixels) > 0xFFFF or len(masks) > 0x7FFF:
+        raise IconError(f"atlas too large ({len(pixels)} + {len(masks)} bytes, IconInfo offsets are 16-bit)")
+
+    header = "// Generated by scripts/icon_atlas.py from M5PaperS3/icons - do not edit\n"
+
+    ids = [header.rstrip("\n"), "#ifndef ICONIDS_H", "#define ICONIDS_H", "", "#include <stdint.h>", "",
+           "enum IconId : int8_t {", "  ICON_NONE = -1,"]
+    ids += [f"  ICON_{name.upper()}," for name, *_ in table]
+    ids += ["  ICON_COUNT", "};", "", "#endif // ICONIDS_H", ""]
+
+    data = [header.rstrip("\n"),
+            f"// {len(table)} icons, {len(pixels)} bytes of pixels + {len(masks)} bytes of masks",
+            "#ifndef ICONATLASDATA_H", "#define ICONATLASDATA_H", "", '#include "IconAtlas.h"', "",
+            "static const IconInfo ICON_ATLAS[ICON_COUNT] = {"]
+    for name, width, height, offset, mask_offset in table:
+        data.append(f"  {{ {width}, {height}, {offset}, {mask_offset} }},  // {name}")
+    data += ["};", "", f"static const uint8_t ICON_ATLAS_PIXELS[{max(len(pixels), 1)}] = {{"]
+    data += hex_lines(bytes(pixels))
+    data += ["};", "", f"static const uint8_t ICON_ATLAS_MASKS[{max(len(masks), 1)}] = {{"]
+    data += hex_lines(bytes(masks))
+    data += ["};", "", "#endif // ICONATLASDATA_H", ""]
+
+    return {"IconIds.h": "\n".join(ids), "IconAtlasData.h": "\n".join(data)}
+
+
+def write_outputs(outputs: Dict[str, str], out_dir: Path, check: bool) -> List[str]:
+    """Writes only the files whose content changed (keeps the build from recompiling). Returns the stale ones."""
+    stale = []
+    for name, content in outputs.items():
+        path = out_dir / name
+        current = path.read_text(encoding="utf-8") if path.exists() else None
+        if current == content:
+            continue
+        stale.append(name)
+        if not check:
+            path.write_text(content, encoding="utf-8")
+    return stale
+
+
+def main(argv: List[str]) -> int:
+    ap = argparse.ArgumentParser(description="Pack M5PaperS3 icons into a flash atlas")
+    ap.add_argument("--icons", type=Path, default=REPO_ROOT / "M5PaperS3" / "icons", help="icon source directory")
+    ap.add_argument("--out", type=Path, default=REPO_ROOT / "M5PaperS3", help="directory for the generated headers")
+    ap.add_argument("--check", action="store_true", help="do not write; exit 1 if the headers are stale")
+    args = ap.parse_args(argv)
+
+    try:
+        outputs = build(args.icons)
+        stale = write_outputs(outputs, args.out, args.check)
+    except (IconError, OSError) as e:
+        print(f"error: {e}", file=sys.stderr)
+        return 2
+
+    if args.check:
+        for name in stale:
+            print(f"stale: {args.out / name} (run scripts/icon_atlas.py)")
+        return 1 if stale else 0
+    for name in stale:
+        print(f"wrote {args.out / name}")
+    if not stale:
+        print("icon atlas is up to date")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
+elif "Import" in globals():
+    # PlatformIO extra_scripts (pre:): regenerate before compiling when the sources changed
+    Import("env")  # noqa: F821
+    project = Path(env["PROJECT_DIR"])  # noqa: F821
+    try:
+        write_outputs(build(project / "icons"), project, check=False)
+    except (IconError, OSError) as e:
+        print(f"icon_atlas: error: {e}", file=sys.stderr)
+        env.Exit(2)  # noqa: F821
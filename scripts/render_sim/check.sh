@@ -0,0 +1,42 @@
+#!/usr/bin/env bash
+# Builds render_sim, runs the scenario and compares pushes.txt and the PGM hashes
+# with scripts/render_sim/golden/. Exits 1 on any difference.
+#
+# Usage (from anywhere in the repository):
+#   scripts/render_sim/check.sh            # compare with the reference
+#   scripts/render_sim/check.sh --update   # rewrite the reference after an intended change
+#
+# The reference is rendered without M5PaperS3/FontSubsetData.h (box glyphs), so the
+# build defines FONT_SUBSET_DISABLED even when the subset font has been generated.
+
+set -euo pipefail
+
+root="$(cd "$(dirname "$0")/../.." && pwd)"
+golden="$root/scripts/render_sim/golden"
+work="$(mktemp -d)"
+trap 'rm -rf "$work"' EXIT
+
+cd "$root"
+g++ -std=c++17 -O2 -pthread -DFONT_SUBSET_DISABLED -Iscripts/render_sim/shim -IM5PaperS3 \
+    scripts/render_sim/render_sim.cpp scripts/render_sim/shim/SimRuntime.cpp \
+    M5PaperS3/{DisplayHandler,FontRenderer,GlyphCache,SubsetFont,PageCache,FrameDiff,WidgetTree,RenderStats,IconAtlas}.cpp \
+    -o "$work/render_sim"
+"$work/render_sim" --out "$work/out" --quiet > /dev/null
+(cd "$work/out" && sha256sum -- *.pgm > "$work/pgm.sha256")
+
+if [[ "${1:-}" == "--update" ]]; then
+  mkdir -p "$golden"
+  cp "$work/out/pushes.txt" "$golden/pushes.txt"
+  cp "$work/pgm.sha256" "$golden/pgm.sha256"
+  echo "render_sim: reference updated"
+  exit 0
+fi
+
+status=0
+diff -u "$golden/pushes.txt" "$work/out/pushes.txt" || status=1
+diff -u "$golden/pgm.sha256" "$work/pgm.sha256" || status=1
+if [[ $status -ne 0 ]]; then
+  echo "render_sim: output differs from scripts/render_sim/golden/ (run with --update if intended)" >&2
+  exit 1
+fi
+echo "render_sim: OK"
@@ -0,0 +1,433 @@
+// M5PaperS3 の DisplayHandler をホストで動かし、操作ごとのパネル画像と転送の記録を書き出す
+// 使い方は scripts/README.md の render_sim を参照
+
+#include "DisplayHandler.h"
+#include "SimRuntime.h"
+#include <sys/stat.h>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+static const char* const MODE_NAMES[] = {
+  "INIT", "DU", "GC16", "GL16", "GLR16", "GLD16", "DU4", "A2", "NONE"
+};
+
+struct SampleShortcut {
+  const char* action;
+  const char* description;
+  const char* keys[3];
+};
+
+// 組み込みのサンプルデータ（ページ送りが起きる数と、半角・全角の混ざった文字列）
+static const SampleShortcut EDIT_SHORTCUTS[] = {
+  { "コピー", "選択範囲をコピー", { "ctrl", "c" } },
+  { "ペースト", "クリップボードを貼り付け", { "ctrl", "v" } },
+  { "切り取り", "選択範囲を切り取り", { "ctrl", "x" } },
+  { "元に戻す", "最後の操作を元に戻す", { "ctrl", "z" } },
+  { "やり直し", "元に戻した操作をやり直し", { "ctrl", "y" } },
+  { "全て選択", "全ての内容を選択", { "ctrl", "a" } },
+  { "保存", "ファイルを保存", { "ctrl", "s" } },
+  { "Save As", "Save to a new file", { "ctrl", "shift", "s" } },
+  { "検索", "テキスト検索", { "ctrl", "f" } },
+  { "置換", "テキスト置換", { "ctrl", "h" } },
+  { "Find Next", "", { "f3" } },
+  { "Go to Line", "行番号へ移動", { "ctrl", "g" } },
+  { "Comment", "行をコメントアウト", { "ctrl", "/" } },
+  { "Indent", "", { "tab" } },
+  { "Outdent", "", { "shift", "tab" } },
+  { "Duplicate Line", "行を複製", { "shift", "alt", "down" } },
+  { "Move Line Up", "行を上へ移動", { "alt", "up" } },
+  { "Move Line Down", "行を下へ移動", { "alt", "down" } },
+  { "Delete Line", "行を削除", { "ctrl", "shift", "k" } },
+  { "Select Word", "単語を選択", { "ctrl", "d" } },
+  { "Fold", "ブロックを折りたたむ", { "ctrl", "shift", "[" } },
+  { "Unfold", "ブロックを展開", { "ctrl", "shift", "]" } },
+  { "Format", "ドキュメントを整形", { "shift", "alt", "f" } },
+  { "Rename", "シンボルの名前を変更", { "f2" } },
+};
+
+static const SampleShortcut VIEW_SHORTCUTS[] = {
+  { "Zoom In", "拡大", { "ctrl", "=" } },
+  { "Zoom Out", "縮小", { "ctrl", "-" } },
+  { "Full Screen", "全画面表示", { "f11" } },
+  { "Sidebar", "サイドバーの表示切り替え", { "ctrl", "b" } },
+};
+
+static const SampleShortcut TAB_SHORTCUTS[] = {
+  { "New Tab", "新しいタブ", { "ctrl", "t" } },
+  { "Close Tab", "タブを閉じる", { "ctrl", "w" } },
+  { "Reopen Tab", "閉じたタブを開き直す", { "ctrl", "shift", "t" } },
+};
+
+struct SampleGroup {
+  const char* name;
+  const SampleShortcut* shortcuts;
+  int count;
+};
+
+#define SAMPLE_COUNT(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+static const SampleGroup EDITOR_GROUPS[] = {
+  { "編集", EDIT_SHORTCUTS, SAMPLE_COUNT(EDIT_SHORTCUTS) },
+  { "View", VIEW_SHORTCUTS, SAMPLE_COUNT(VIEW_SHORTCUTS) },
+};
+
+static const SampleGroup BROWSER_GROUPS[] = {
+  { "Tabs", TAB_SHORTCUTS, SAMPLE_COUNT(TAB_SHORTCUTS) },
+};
+
+struct SampleApp {
+  const char* name;
+  const SampleGroup* groups;
+  int count;
+};
+
+static const SampleApp SAMPLE_APPS[] = {
+  { "Editor", EDITOR_GROUPS, SAMPLE_COUNT(EDITOR_GROUPS) },
+  { "Browser", BROWSER_GROUPS, SAMPLE_COUNT(BROWSER_GROUPS) },
+};
+
+static std::vector<CatalogApp> buildCatalog() {
+  std::vector<CatalogApp> catalog;
+  for (int a = 0; a < SAMPLE_COUNT(SAMPLE_APPS); a++) {
+    CatalogApp app;
+    app.name = SAMPLE_APPS[a].name;
+    app.order = a;
+    app.source = a;
+    for (int g = 0; g < SAMPLE_APPS[a].count; g++) {
+      const SampleGroup& group = SAMPLE_APPS[a].groups[g];
+      app.groups.push_back({ group.name, g, g, group.count });
+    }
+    catalog.push_back(app);
+  }
+  return catalog;
+}
+
+static std::vector<Button> buildButtons(int app, int group) {
+  // DataManager::openGroup と同じく、位置は DisplayHandler が決める
+  const SampleGroup& source = SAMPLE_APPS[app].groups[group];
+  std::vector<Button> buttons;
+  for (int i = 0; i < source.count; i++) {
+    const SampleShortcut& shortcut = source.shortcuts[i];
+    Button button = {};
+    button.text = shortcut.action;
+    button.description = shortcut.description;
+    button.keyCount = 0;
+    for (const char* key : shortcut.keys) {
+      if (key) button.keys[button.keyCount++] = key;
+    }
+    button.isVisible = true;
+    button.isPressed = false;
+    button.id = i;
+    buttons.push_back(button);
+  }
+  return buttons;
+}
+
+static SystemConfig defaultConfig() {
+  SystemConfig config = {};
+  config.layoutColumns = DEFAULT_LAYOUT;
+  config.updateMode = DEFAULT_UPDATE_MODE;
+  config.autoSleepTime = AUTO_SLEEP_TIME;
+  config.touchSensitivity = TOUCH_THRESHOLD;
+  config.dataSource = "internal";
+  config.keyboardMode = MODE_USB_HID;
+  config.ghostCleanupThreshold = GHOST_CLEANUP_THRESHOLD;
+  config.ghostCleanupIdleMs = GHOST_CLEANUP_IDLE_MS;
+  config.listView = false;
+  return config;
+}
+
+static BatteryInfo battery(int percentage) {
+  BatteryInfo info = {};
+  info.percentage = percentage;
+  info.voltage = 3.3f + percentage / 100.0f;
+  info.isLowBattery = percentage <= LOW_BATTERY_THRESHOLD;
+  return info;
+}
+
+// ---- 出力 ----
+
+struct Options {
+  std::string outDir = "render_sim_out";
+  std::string compareDir;
+  int benchFlips = 0;
+  bool quiet = false;
+};
+
+static bool writePgm(const std::string& path) {
+  // 4bpp の値（0 = 黒、15 = 白）を 0〜255 に広げる
+  std::ofstream out(path, std::ios::binary);
+  if (!out) return false;
+  out << "P5\n" << DISPLAY_WIDTH << " " << DISPLAY_HEIGHT << "\n255\n";
+  for (uint8_t value : M5.EPD.panel) out.put((char)(value * 17));
+  return (bool)out;
+}
+
+class Recorder {
+private:
+  const Options& options;
+  std::ostringstream log;
+  size_t logged = 0;
+  int step = 0;
+  int misaligned = 0;
+  bool failed = false;
+  std::vector<std::string> files;
+
+public:
+  explicit Recorder(const Options& opts) : options(opts) {}
+
+  // 直前の記録以降の転送を書き出し、今のパネル画像を保存する
+  void snapshot(const char* name) {
+    sim::settle();
+    char prefix[64];
+    snprintf(prefix, sizeof(prefix), "%02d_%s", ++step, name);
+
+    std::vector<SimPush>& pushes = M5.EPD.pushes;
+    int count = pushes.size() - logged;
+    printf("%-22s %3d push%s", prefix, count, count == 1 ? " " : "es");
+    int modes[9] = {};
+    for (size_t i = logged; i < pushes.size(); i++) {
+      const SimPush& push = pushes[i];
+      log << prefix << " t=" << push.time << " " << push.x << "," << push.y << " " << push.width << "x"
+          << push.height << " " << MODE_NAMES[push.mode] << (push.aligned ? "" : " MISALIGNED") << "\n";
+      modes[push.mode]++;
+      if (!push.aligned) misaligned++;
+    }
+    logged = pushes.size();
+    for (int m = 0; m < 9; m++) {
+      if (modes[m]) printf(" %s=%d", MODE_NAMES[m], modes[m]);
+    }
+    printf("\n");
+
+    std::string file = std::string(prefix) + ".pgm";
+    files.push_back(file);
+    std::string path = options.outDir + "/" + file;
+    if (!writePgm(path)) {
+      fprintf(stderr, "render_sim: cannot write %s\n", path.c_str());
+      failed = true;
+    }
+  }
+
+  bool finish() {
+    std::string path = options.outDir + "/pushes.txt";
+    std::ofstream out(path);
+    out << log.str();
+    if (!out) {
+      fprintf(stderr, "render_sim: cannot write %s\n", path.c_str());
+      return false;
+    }
+    if (misaligned > 0) printf("warning: %d pushes not aligned to 4px\n", misaligned);
+    return !failed;
+  }
+
+  // 書き出したファイル（画像と転送記録）
+  std::vector<std::string> getFiles() const {
+    std::vector<std::string> all = files;
+    all.push_back("pushes.txt");
+    return all;
+  }
+};
+
+static bool readFile(const std::string& path, std::string& out) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) return false;
+  std::ostringstream buf;
+  buf << in.rdbuf();
+  out = buf.str();
+  return true;
+}
+
+static int comparePixels(const std::string& a, const std::string& b) {
+  // ヘッダーは同じ大きさなので、末尾の画素部分だけ数える
+  size_t pixels = (size_t)DISPLAY_WIDTH * DISPLAY_HEIGHT;
+  if (a.size() < pixels || b.size() < pixels || a.size() != b.size()) return -1;
+  int diff = 0;
+  for (size_t i = a.size() - pixels; i < a.size(); i++) diff += (a[i] != b[i]);
+  return diff;
+}
+
+static bool compareOutputs(const Options& options, const std::vector<std::string>& names) {
+  // 出力ディレクトリの画像と転送記録を、基準のディレクトリと突き合わせる
+  int differences = 0;
+  for (const std::string& name : names) {
+    std::string actual, expected;
+    if (!readFile(options.outDir + "/" + name, actual)) continue;
+    if (!readFile(options.compareDir + "/" + name, expected)) {
+      printf("compare: %s missing in %s\n", name.c_str(), options.compareDir.c_str());
+      differences++;
+      continue;
+    }
+    if (actual == expected) continue;
+    differences++;
+    if (name == "pushes.txt") {
+      printf("compare: pushes.txt differs (diff %s/pushes.txt %s/pushes.txt)\n",
+             options.compareDir.c_str(), options.outDir.c_str());
+    } else {
+      printf("compare: %s differs in %d pixels\n", name.c_str(), comparePixels(actual, expected));
+    }
+  }
+  printf("compare: %d of %d files differ\n", differences, (int)names.size());
+  return differences == 0;
+}
+
+// ---- シナリオ ----
+
+static void openGroup(DisplayHandler& display, int app, int group) {
+  // M5PaperS3.ino の loadShortcutGroup と同じ順で渡す
+  std::vector<Button> buttons = buildButtons(app, group);
+  display.setLocation(app, group);
+  display.setGroups({ { SAMPLE_APPS[app].groups[group].name, 0, (int)buttons.size() } });
+  display.setButtons(buttons);
+  sim::settle();
+}
+
+static void runScenario(DisplayHandler& display, Recorder& recorder) {
+  SystemConfig config = defaultConfig();
+
+  // 起動（M5PaperS3.ino の setup と同じ順）
+  // 呼び出しごとに描画タスクを待たせ、実機では間合いで変わる全画面更新の回数を毎回同じにする
+  display.begin();
+  sim::settle();
+  display.setConfig(config);
+  sim::settle();
+  display.setCatalog(buildCatalog());
+  sim::settle();
+  openGroup(display, 0, 0);
+  display.setStatus(STATUS_READY);
+  display.setBatteryInfo(battery(80));
+  display.forceUpdate();
+  recorder.snapshot("boot");
+
+  display.setStatus(STATUS_SENDING_KEYS);
+  recorder.snapshot("status");
+
+  display.setBatteryInfo(battery(57));
+  recorder.snapshot("battery");
+
+  display.nextPage();
+  recorder.snapshot("next_page");
+
+  // ページ左上のボタンをタップしたときと同じ反転表示
+  display.flashButton(display.getTouchedButton(BUTTON_MARGIN + 20, BUTTON_AREA_Y + BUTTON_MARGIN + 20));
+  recorder.snapshot("press");
+
+  sim::advance(PRESS_FEEDBACK_MS);
+  recorder.snapshot("press_restored");
+
+  // 同じボタンを続けて押して部分更新を溜め、操作が止まってから GC16 で掃除される
+  for (int i = 0; i < GHOST_CLEANUP_THRESHOLD; i++) {
+    display.flashButton(display.getTouchedButton(BUTTON_MARGIN + 20, BUTTON_AREA_Y + BUTTON_MARGIN + 20));
+    sim::advance(PRESS_FEEDBACK_MS);
+  }
+  display.setStatus(STATUS_READY);
+  sim::advance(GHOST_CLEANUP_IDLE_MS + RENDER_IDLE_POLL_MS);
+  recorder.snapshot("ghost_cleanup");
+
+  openGroup(display, 0, 1);
+  recorder.snapshot("group_tab");
+
+  config.listView = true;
+  display.setConfig(config);
+  recorder.snapshot("list_view");
+
+  openGroup(display, 0, 0);
+  recorder.snapshot("list_group");
+
+  display.nextPage();
+  recorder.snapshot("list_scroll");
+
+  display.showSettings();
+  recorder.snapshot("settings");
+
+  // アプリ選択へ戻る（M5PaperS3.ino の closeShortcutGroup と同じ）
+  display.showApps();
+  display.setLocation(-1, -1);
+  display.setGroups(std::vector<ShortcutGroup>());
+  display.setButtons(std::vector<Button>());
+  recorder.snapshot("apps");
+
+  config.listView = false;
+  config.layoutColumns = LAYOUT_3_COLUMN;
+  display.setConfig(config);
+  openGroup(display, 0, 0);
+  display.showShortcuts();
+  recorder.snapshot("three_columns");
+
+  // 高速モード: ステータスは DU で送り、操作が止まったら GC16 で掃除される
+  config.updateMode = UPDATE_MODE_FAST;
+  display.setConfig(config);
+  sim::settle();
+  display.setStatus(STATUS_SENDING_KEYS);
+  recorder.snapshot("fast_status");
+
+  display.setStatus(STATUS_READY);
+  sim::advance(GHOST_CLEANUP_IDLE_MS + RENDER_IDLE_POLL_MS);
+  recorder.snapshot("fast_cleanup");
+}
+
+static void runBench(DisplayHandler& display, int flips) {
+  // ページ送りを繰り返して描画の段階ごとの時間を測る（パネル転送は一瞬で終わる扱い）
+  // シナリオの最後は3列で1ページに収まるので、既定の設定に戻してから始める
+  display.setConfig(defaultConfig());
+  openGroup(display, 0, 0);
+  display.printRenderStats(true);
+  for (int i = 0; i < flips; i++) {
+    if (display.getCurrentPage() + 1 < display.getTotalPages()) {
+      display.nextPage();
+    } else {
+      display.setPage(0);
+    }
+    sim::settle();
+  }
+  Serial.quiet = false;
+  display.printRenderStats(false);
+}
+
+static void usage() {
+  fprintf(stderr,
+          "usage: render_sim [--out DIR] [--compare DIR] [--bench N] [--quiet]\n"
+          "  --out DIR      write NN_<step>.pgm and pushes.txt to DIR (default render_sim_out)\n"
+          "  --compare DIR  compare the outputs with a reference directory (exit 1 on difference)\n"
+          "  --bench N      flip pages N times after the scenario and print render stats\n"
+          "  --quiet        hide the device's serial log\n");
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--out" && i + 1 < argc) {
+      options.outDir = argv[++i];
+    } else if (arg == "--compare" && i + 1 < argc) {
+      options.compareDir = argv[++i];
+    } else if (arg == "--bench" && i + 1 < argc) {
+      options.benchFlips = atoi(argv[++i]);
+    } else if (arg == "--quiet") {
+      options.quiet = true;
+    } else {
+      usage();
+      return 2;
+    }
+  }
+  Serial.quiet = options.quiet;
+
+  mkdir(options.outDir.c_str(), 0755);
+  struct stat info;
+  if (stat(options.outDir.c_str(), &info) != 0 || !S_ISDIR(info.st_mode)) {
+    fprintf(stderr, "render_sim: cannot create %s\n", options.outDir.c_str());
+    return 2;
+  }
+
+  static DisplayHandler display;
+  Recorder recorder(options);
+  runScenario(display, recorder);
+  bool ok = recorder.finish();
+  if (ok && !options.compareDir.empty()) ok = compareOutputs(options, recorder.getFiles());
+  if (options.benchFlips > 0) runBench(display, options.benchFlips);
+
+  // 描画タスクは終わらないので、後始末を待たずに抜ける
+  fflush(stdout);
+  fflush(stderr);
+  _exit(ok ? 0 : 1);
+}
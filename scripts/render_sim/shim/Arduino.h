@@ -0,0 +1,168 @@
+#ifndef RENDER_SIM_ARDUINO_H
+#define RENDER_SIM_ARDUINO_H
+
+// render_sim 用の Arduino / FreeRTOS の代用品（DisplayHandler が使う分だけ）
+// millis() と FreeRTOS の待ち時間はシミュレータの仮想時計で進み、micros() だけは実時間（描画時間の計測用）
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using std::abs;
+using std::max;
+using std::min;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define IRAM_ATTR
+
+unsigned long millis();
+unsigned long micros();
+
+size_t strlcpy(char* dst, const char* src, size_t size);
+
+inline bool psramFound() { return true; }
+inline void* ps_malloc(size_t size) { return malloc(size); }
+
+// ---- String ----
+
+class String {
+private:
+  std::string s;
+
+public:
+  String() {}
+  String(const char* text) : s(text ? text : "") {}
+  String(const std::string& text) : s(text) {}
+  explicit String(char c) : s(1, c) {}
+  String(int value) : s(std::to_string(value)) {}
+  String(unsigned int value) : s(std::to_string(value)) {}
+  String(long value) : s(std::to_string(value)) {}
+  String(unsigned long value) : s(std::to_string(value)) {}
+  String(long long value) : s(std::to_string(value)) {}
+  String(unsigned long long value) : s(std::to_string(value)) {}
+  String(float value, unsigned int decimals = 2) { setFloat(value, decimals); }
+  String(double value, unsigned int decimals = 2) { setFloat(value, decimals); }
+
+  unsigned int length() const { return s.size(); }
+  const char* c_str() const { return s.c_str(); }
+  char operator[](unsigned int index) const { return index < s.size() ? s[index] : 0; }
+  char charAt(unsigned int index) const { return (*this)[index]; }
+
+  String& operator+=(const String& rhs) { s += rhs.s; return *this; }
+  String& operator+=(const char* rhs) { s += rhs; return *this; }
+  String& operator+=(char c) { s += c; return *this; }
+
+  bool operator==(const String& rhs) const { return s == rhs.s; }
+  bool operator==(const char* rhs) const { return s == rhs; }
+  bool operator!=(const String& rhs) const { return s != rhs.s; }
+  bool operator!=(const char* rhs) const { return s != rhs; }
+  bool operator<(const String& rhs) const { return s < rhs.s; }
+
+  String substring(unsigned int from, unsigned int to = UINT_MAX) const {
+    if (from >= s.size() || to <= from) return String();
+    return String(s.substr(from, to - from));
+  }
+  int indexOf(const char* text) const {
+    size_t p = s.find(text);
+    return p == std::string::npos ? -1 : (int)p;
+  }
+  void trim() {
+    size_t a = s.find_first_not_of(" \t\r\n");
+    size_t b = s.find_last_not_of(" \t\r\n");
+    s = (a == std::string::npos) ? "" : s.substr(a, b - a + 1);
+  }
+  long toInt() const { return atol(s.c_str()); }
+
+private:
+  void setFloat(double value, unsigned int decimals) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+    s = buf;
+  }
+};
+
+inline String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, const char* b) { String r(a); r += b; return r; }
+inline String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, char b) { String r(a); r += b; return r; }
+
+// ---- Serial（標準エラーへ。--quiet なら捨てる）----
+
+class SimSerial {
+public:
+  bool quiet = false;
+
+  void begin(unsigned long) {}
+  void print(const String& text) { write(text.c_str()); }
+  void print(const char* text) { write(text); }
+  void println(const String& text) { write(text.c_str()); write("\n"); }
+  void println(const char* text) { write(text); write("\n"); }
+  void println() { write("\n"); }
+  int printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    char buf[512];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    write(buf);
+    return n;
+  }
+  int available() { return 0; }
+  int read() { return -1; }
+
+private:
+  void write(const char* text) {
+    if (!quiet) fputs(text, stderr);
+  }
+};
+
+extern SimSerial Serial;
+
+// ---- FreeRTOS ----
+// タスクは std::thread で動かすが、待ちはすべてシミュレータの仮想時計で数える
+// （シミュレータは操作ごとに描画タスクが待ちに入るまで進めるので、結果は毎回同じになる）
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+struct SimTask;
+struct SimQueue;
+struct SimMutex;
+typedef SimTask* TaskHandle_t;
+typedef SimQueue* QueueHandle_t;
+typedef SimMutex* SemaphoreHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFF)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portYIELD_FROM_ISR()
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t wait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t wait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t wait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex);
+#define xSemaphoreTakeRecursive xSemaphoreTake
+#define xSemaphoreGiveRecursive xSemaphoreGive
+
+#endif // RENDER_SIM_ARDUINO_H
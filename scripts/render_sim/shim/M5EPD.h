@@ -0,0 +1,98 @@
+#ifndef RENDER_SIM_M5EPD_H
+#define RENDER_SIM_M5EPD_H
+
+#include <Arduino.h>
+#include <SD.h>
+#include <vector>
+
+// render_sim 用の M5EPD の代用品
+// キャンバスは実機と同じ 4bpp（1バイトに2px、左の画素が上位4bit）で、
+// パネルは GRAM に書かれた画像を UpdateArea / UpdateFull の範囲だけ表示側へ写す
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+typedef enum {
+  UPDATE_MODE_INIT = 0,
+  UPDATE_MODE_DU = 1,
+  UPDATE_MODE_GC16 = 2,
+  UPDATE_MODE_GL16 = 3,
+  UPDATE_MODE_GLR16 = 4,
+  UPDATE_MODE_GLD16 = 5,
+  UPDATE_MODE_DU4 = 6,
+  UPDATE_MODE_A2 = 7,
+  UPDATE_MODE_NONE = 8
+} m5epd_update_mode_t;
+
+// 文字は字形を持たず、送り幅の箱で描く（レイアウトと中央揃えの確認用）
+// 半角は size / 2、それ以外は size の幅
+class M5EPD_Canvas {
+private:
+  std::vector<uint8_t> pixels;
+  int w = 0;
+  int h = 0;
+  int textSize = 16;
+  int textColor = 0;
+  int cursorX = 0;
+  int cursorY = 0;
+
+  static uint32_t nextCodepoint(const char*& p);
+  static int advanceOf(uint32_t codepoint, int size);
+
+public:
+  void* createCanvas(int width, int height);
+  void* frameBuffer() { return pixels.data(); }
+  int width() const { return w; }
+  int height() const { return h; }
+
+  void fillCanvas(int color);
+  void drawPixel(int x, int y, int color);
+  int readPixel(int x, int y) const;
+  void fillRect(int x, int y, int width, int height, int color);
+  void drawRect(int x, int y, int width, int height, int color);
+
+  void setTextSize(int size) { textSize = size; }
+  void setTextColor(int color) { textColor = color; }
+  void setTextColor(int color, int) { textColor = color; }
+  void setCursor(int x, int y) { cursorX = x; cursorY = y; }
+  void print(const String& text);
+  void drawString(const String& text, int x, int y);
+  int textWidth(const String& text) const;
+
+  esp_err_t loadFont(const char*, SimSD&) { return ESP_FAIL; }
+  esp_err_t createRender(int, int) { return ESP_OK; }
+};
+
+// パネルへの転送1回分
+struct SimPush {
+  unsigned long time;
+  int x, y, width, height;
+  m5epd_update_mode_t mode;
+  bool aligned;             // IT8951 の部分転送は x と幅が4px単位
+};
+
+class M5EPD_Driver {
+public:
+  std::vector<uint8_t> gram;     // 1px = 1バイト（0〜15）
+  std::vector<uint8_t> panel;    // 表示されている画像
+  std::vector<SimPush> pushes;
+  uint32_t gramWrites = 0;
+
+  M5EPD_Driver();
+  void SetRotation(int) {}
+  void Clear(bool init = false);
+  void WritePartGram4bpp(int x, int y, int w, int h, const uint8_t* data);
+  void UpdateArea(int x, int y, int w, int h, m5epd_update_mode_t mode);
+  void UpdateFull(m5epd_update_mode_t mode);
+};
+
+class M5EPD {
+public:
+  M5EPD_Driver EPD;
+  void begin(bool = true, bool = true, bool = true, bool = true, bool = true) {}
+};
+
+extern M5EPD M5;
+
+#endif // RENDER_SIM_M5EPD_H
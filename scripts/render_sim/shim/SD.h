@@ -0,0 +1,14 @@
+#ifndef RENDER_SIM_SD_H
+#define RENDER_SIM_SD_H
+
+#include <Arduino.h>
+
+// TFカードは無い扱い（FontRenderer は TTF を探さずサブセットフォントかキャンバスの文字で描く）
+class SimSD {
+public:
+  bool exists(const char*) { return false; }
+};
+
+extern SimSD SD;
+
+#endif // RENDER_SIM_SD_H
@@ -0,0 +1,396 @@
+#include "SimRuntime.h"
+#include <Arduino.h>
+#include <M5EPD.h>
+#include "Config.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+SimSerial Serial;
+SimSD SD;
+M5EPD M5;
+
+// ---- 時計 ----
+
+static std::atomic<unsigned long> simNow(0);
+
+unsigned long millis() {
+  return simNow.load();
+}
+
+unsigned long micros() {
+  // 描画時間の計測（RenderStats）は実時間で測る
+  static const auto start = std::chrono::steady_clock::now();
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
+size_t strlcpy(char* dst, const char* src, size_t size) {
+  size_t length = strlen(src);
+  if (size > 0) {
+    size_t n = min(length, size - 1);
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+  }
+  return length;
+}
+
+// ---- タスクと待ち ----
+// 共有状態はすべて1つのロックで守り、状態が変わるたびに全員を起こして条件を見直させる
+
+struct SimTask {
+  bool blocked = false;
+  bool timed = false;
+  unsigned long deadline = 0;
+  std::function<bool()> ready;
+  uint32_t notifications = 0;
+  bool isMain = false;
+};
+
+struct SimQueue {
+  size_t itemSize;
+  size_t length;
+  std::deque<std::vector<uint8_t>> items;
+};
+
+struct SimMutex {
+  bool recursive;
+  SimTask* owner = nullptr;
+  int depth = 0;
+};
+
+static std::mutex lock;
+static std::condition_variable changed;
+static std::vector<SimTask*> tasks;
+static thread_local SimTask* currentTask = nullptr;
+
+// 実時間でこれだけ何も進まなければ止まったとみなす（描画タスクが同期コマンドに応えないなど）
+static const auto STALL_LIMIT = std::chrono::seconds(10);
+
+static SimTask* current() {
+  if (!currentTask) {
+    currentTask = new SimTask();
+    currentTask->isMain = true;
+  }
+  return currentTask;
+}
+
+static bool expired(const SimTask* task) {
+  return task->timed && simNow.load() >= task->deadline;
+}
+
+static bool waitFor(std::unique_lock<std::mutex>& held, TickType_t wait, std::function<bool()> ready) {
+  if (ready()) return true;
+  if (wait == 0) return false;
+
+  SimTask* self = current();
+  self->blocked = true;
+  self->timed = (wait != portMAX_DELAY);
+  self->deadline = simNow.load() + wait;
+  self->ready = ready;
+  changed.notify_all();
+
+  while (!ready() && !expired(self)) {
+    if (self->isMain) {
+      if (changed.wait_for(held, STALL_LIMIT) == std::cv_status::timeout && !ready()) {
+        fprintf(stderr, "[Sim] Main thread stalled waiting on the render task\n");
+        abort();
+      }
+    } else {
+      changed.wait(held);
+    }
+  }
+  self->blocked = false;
+  self->ready = nullptr;
+  return ready();
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char*, uint32_t, void* arg,
+                                   UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+  SimTask* task = new SimTask();
+  {
+    std::lock_guard<std::mutex> held(lock);
+    tasks.push_back(task);
+  }
+  if (handle) *handle = task;
+  std::thread([task, fn, arg]() {
+    currentTask = task;
+    fn(arg);
+  }).detach();
+  return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  std::lock_guard<std::mutex> held(lock);
+  return current();
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait) {
+  std::unique_lock<std::mutex> held(lock);
+  SimTask* self = current();
+  if (!waitFor(held, wait, [self]() { return self->notifications > 0; })) return 0;
+  uint32_t value = self->notifications;
+  self->notifications = clear ? 0 : value - 1;
+  return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  std::lock_guard<std::mutex> held(lock);
+  task->notifications++;
+  changed.notify_all();
+  return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks) {
+  std::unique_lock<std::mutex> held(lock);
+  waitFor(held, ticks, []() { return false; });
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+  SimQueue* queue = new SimQueue();
+  queue->itemSize = itemSize;
+  queue->length = length;
+  return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t wait) {
+  std::unique_lock<std::mutex> held(lock);
+  if (!waitFor(held, wait, [queue]() { return queue->items.size() < queue->length; })) return pdFALSE;
+  const uint8_t* bytes = (const uint8_t*)item;
+  queue->items.emplace_back(bytes, bytes + queue->itemSize);
+  changed.notify_all();
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t wait) {
+  std::unique_lock<std::mutex> held(lock);
+  if (!waitFor(held, wait, [queue]() { return !queue->items.empty(); })) return pdFALSE;
+  memcpy(item, queue->items.front().data(), queue->itemSize);
+  queue->items.pop_front();
+  changed.notify_all();
+  return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+  std::lock_guard<std::mutex> held(lock);
+  return queue->items.size();
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+  SimMutex* mutex = new SimMutex();
+  mutex->recursive = false;
+  return mutex;
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+  SimMutex* mutex = new SimMutex();
+  mutex->recursive = true;
+  return mutex;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t wait) {
+  std::unique_lock<std::mutex> held(lock);
+  SimTask* self = current();
+  if (mutex->recursive && mutex->owner == self) {
+    mutex->depth++;
+    return pdTRUE;
+  }
+  if (!waitFor(held, wait, [mutex]() { return mutex->owner == nullptr; })) return pdFALSE;
+  mutex->owner = self;
+  mutex->depth = 1;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex) {
+  std::lock_guard<std::mutex> held(lock);
+  if (mutex->owner != current()) return pdFALSE;
+  if (--mutex->depth == 0) {
+    mutex->owner = nullptr;
+    changed.notify_all();
+  }
+  return pdTRUE;
+}
+
+namespace sim {
+
+static bool idle() {
+  for (SimTask* task : tasks) {
+    if (!task->blocked || task->ready() || expired(task)) return false;
+  }
+  return true;
+}
+
+void settle() {
+  std::unique_lock<std::mutex> held(lock);
+  while (!idle()) {
+    if (changed.wait_for(held, STALL_LIMIT) == std::cv_status::timeout && !idle()) {
+      fprintf(stderr, "[Sim] Tasks did not settle\n");
+      abort();
+    }
+  }
+}
+
+void advance(unsigned long ms) {
+  unsigned long target = simNow.load() + ms;
+  settle();
+  while (true) {
+    {
+      std::lock_guard<std::mutex> held(lock);
+      // 次に期限の来る待ちまで進める（一気に target まで進めると途中の処理を飛ばしてしまう）
+      unsigned long next = target;
+      for (SimTask* task : tasks) {
+        if (task->blocked && task->timed && task->deadline < next) next = task->deadline;
+      }
+      simNow.store(max(next, simNow.load()));
+      changed.notify_all();
+    }
+    settle();
+    if (simNow.load() >= target) break;
+  }
+}
+
+}  // namespace sim
+
+// ---- キャンバス ----
+
+void* M5EPD_Canvas::createCanvas(int width, int height) {
+  w = width;
+  h = height;
+  pixels.assign((size_t)(w / 2) * h, 0xFF);
+  return pixels.data();
+}
+
+void M5EPD_Canvas::fillCanvas(int color) {
+  uint8_t c = color & 0x0F;
+  std::fill(pixels.begin(), pixels.end(), (uint8_t)((c << 4) | c));
+}
+
+void M5EPD_Canvas::drawPixel(int x, int y, int color) {
+  if (x < 0 || y < 0 || x >= w || y >= h) return;
+  uint8_t& byte = pixels[(size_t)y * (w / 2) + x / 2];
+  uint8_t c = color & 0x0F;
+  byte = (x & 1) ? ((byte & 0xF0) | c) : ((byte & 0x0F) | (c << 4));
+}
+
+int M5EPD_Canvas::readPixel(int x, int y) const {
+  if (x < 0 || y < 0 || x >= w || y >= h) return 0;
+  uint8_t byte = pixels[(size_t)y * (w / 2) + x / 2];
+  return (x & 1) ? (byte & 0x0F) : (byte >> 4);
+}
+
+void M5EPD_Canvas::fillRect(int x, int y, int width, int height, int color) {
+  int x0 = max(x, 0), y0 = max(y, 0);
+  int x1 = min(x + width, w), y1 = min(y + height, h);
+  for (int py = y0; py < y1; py++) {
+    for (int px = x0; px < x1; px++) drawPixel(px, py, color);
+  }
+}
+
+void M5EPD_Canvas::drawRect(int x, int y, int width, int height, int color) {
+  if (width <= 0 || height <= 0) return;
+  fillRect(x, y, width, 1, color);
+  fillRect(x, y + height - 1, width, 1, color);
+  fillRect(x, y, 1, height, color);
+  fillRect(x + width - 1, y, 1, height, color);
+}
+
+uint32_t M5EPD_Canvas::nextCodepoint(const char*& p) {
+  uint8_t c = (uint8_t)*p++;
+  int extra = (c >= 0xF0) ? 3 : (c >= 0xE0) ? 2 : (c >= 0xC0) ? 1 : 0;
+  uint32_t codepoint = extra ? (c & (0x3F >> extra)) : c;
+  for (int i = 0; i < extra && (*p & 0xC0) == 0x80; i++) {
+    codepoint = (codepoint << 6) | (*p++ & 0x3F);
+  }
+  return codepoint;
+}
+
+int M5EPD_Canvas::advanceOf(uint32_t codepoint, int size) {
+  return codepoint < 0x80 ? size / 2 : size;
+}
+
+int M5EPD_Canvas::textWidth(const String& text) const {
+  int width = 0;
+  const char* p = text.c_str();
+  while (*p) width += advanceOf(nextCodepoint(p), textSize);
+  return width;
+}
+
+void M5EPD_Canvas::print(const String& text) {
+  const char* p = text.c_str();
+  while (*p) {
+    uint32_t codepoint = nextCodepoint(p);
+    int advance = advanceOf(codepoint, textSize);
+    if (codepoint > 0x20) {
+      // 半角は x-height 程度、全角は文字枠いっぱいの箱
+      if (codepoint < 0x80) {
+        fillRect(cursorX + 1, cursorY + textSize / 4, advance - 2, textSize / 2, textColor);
+      } else {
+        fillRect(cursorX + 1, cursorY + textSize / 8, advance - 2, textSize * 3 / 4, textColor);
+      }
+    }
+    cursorX += advance;
+  }
+}
+
+void M5EPD_Canvas::drawString(const String& text, int x, int y) {
+  setCursor(x, y);
+  print(text);
+}
+
+// ---- パネル ----
+
+M5EPD_Driver::M5EPD_Driver() {
+  gram.assign(DISPLAY_WIDTH * DISPLAY_HEIGHT, 15);
+  panel.assign(DISPLAY_WIDTH * DISPLAY_HEIGHT, 15);
+}
+
+void M5EPD_Driver::Clear(bool) {
+  std::fill(gram.begin(), gram.end(), 15);
+  std::fill(panel.begin(), panel.end(), 15);
+  pushes.push_back({ millis(), 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, UPDATE_MODE_INIT, true });
+}
+
+void M5EPD_Driver::WritePartGram4bpp(int x, int y, int w, int h, const uint8_t* data) {
+  gramWrites++;
+  size_t rowBytes = w / 2;
+  for (int row = 0; row < h; row++) {
+    for (int col = 0; col < w; col++) {
+      int px = x + col, py = y + row;
+      if (px < 0 || py < 0 || px >= DISPLAY_WIDTH || py >= DISPLAY_HEIGHT) continue;
+      uint8_t byte = data[row * rowBytes + col / 2];
+      gram[py * DISPLAY_WIDTH + px] = (col & 1) ? (byte & 0x0F) : (byte >> 4);
+    }
+  }
+}
+
+static uint8_t waveformLevel(uint8_t value, m5epd_update_mode_t mode) {
+  // DU / A2 は白黒の2値、DU4 は4階調しか出ない（中間調の画素はそのどれかに寄る）
+  switch (mode) {
+    case UPDATE_MODE_DU:
+    case UPDATE_MODE_A2:
+      return value >= 8 ? 15 : 0;
+    case UPDATE_MODE_DU4:
+      return (value + 2) / 5 * 5;
+    default:
+      return value;
+  }
+}
+
+void M5EPD_Driver::UpdateArea(int x, int y, int w, int h, m5epd_update_mode_t mode) {
+  bool aligned = (x % 4 == 0) && (w % 4 == 0);
+  pushes.push_back({ millis(), x, y, w, h, mode, aligned });
+  for (int py = max(y, 0); py < min(y + h, DISPLAY_HEIGHT); py++) {
+    for (int px = max(x, 0); px < min(x + w, DISPLAY_WIDTH); px++) {
+      int i = py * DISPLAY_WIDTH + px;
+      panel[i] = waveformLevel(gram[i], mode);
+    }
+  }
+}
+
+void M5EPD_Driver::UpdateFull(m5epd_update_mode_t mode) {
+  UpdateArea(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, mode);
+}
@@ -0,0 +1,15 @@
+#ifndef RENDER_SIM_RUNTIME_H
+#define RENDER_SIM_RUNTIME_H
+
+// シミュレータ側から仮想時計とタスクを進める
+namespace sim {
+
+// 作ったタスクがすべて待ちに入り、どれも起きる条件を満たしていない状態まで進める
+void settle();
+
+// 仮想時計を進める（途中で期限の来る待ちは期限の順に起こし、そのたびに settle する）
+void advance(unsigned long ms);
+
+}  // namespace sim
+
+#endif // RENDER_SIM_RUNTIME_H